@@ -19,6 +19,7 @@
 /* Includes ------------------------------------------------------------------- */
 #include "LPC17xx.h"
 #include "lpc_system_init.h"
+#include "lpc_crc32.h"
 
 
 #ifdef __cplusplus
@@ -38,6 +39,9 @@ extern "C"
 #define 	DP83848C_SEL       0	         // Specify the type of interface
 #define 	KSZ8031_SEL        1
 
+#define     EMAC_TRACE_SEL     ENABLE        // Interrupt event ring, EMAC_TraceGet()
+#define     EMAC_TRACE_SIZE    32            // Events kept until drained
+
 /******************************************************************************/
 /*                       UART Mode validation                                 */
 /******************************************************************************/
@@ -45,6 +49,10 @@ extern "C"
 	#error PHY is not correctly selected
 #endif
 
+#if EMAC_TRACE_SEL
+	#define EMAC_TRACE_MODE
+#endif
+
 #if DP83848C_SEL
 	#define DP83848C_MODE
 #elif KSZ8031_SEL
@@ -73,8 +81,6 @@ extern "C"
 
 /* Global Tx Buffer data */
 uint8_t __attribute__ ((aligned (4))) gTxBuf[TX_PACKET_SIZE + 0x10];
-/* Global Rx Buffer data */
-uint8_t __attribute__ ((aligned (4))) gRxBuf[TX_PACKET_SIZE + 0x10];
 
 
 /* EMAC PHY status type definitions */
@@ -99,11 +105,50 @@ uint8_t __attribute__ ((aligned (4))) gRxBuf[TX_PACKET_SIZE + 0x10];
 
 
 /* EMAC Memory Buffer configuration for 16K Ethernet RAM */
-#define EMAC_NUM_RX_FRAG         4           /**< Num.of RX Fragments 4*1536= 6.0kB */
-#define EMAC_NUM_TX_FRAG         3           /**< Num.of TX Fragments 3*1536= 4.6kB */
 #define EMAC_ETH_MAX_FLEN        1536        /**< Max. Ethernet Frame Size          */
 #define EMAC_TX_FRAME_TOUT       0x00100000  /**< Frame Transmit timeout count      */
 
+/* Rx buffers of EMAC_ETH_MAX_FLEN take one frame each. Smaller buffers are
+ * chained by the EMAC, a frame then spans as many descriptors as it needs,
+ * so short frames do not hold a full size buffer each */
+#define EMAC_RX_BUF_SIZE         256         /**< Rx buffer size, multiple of 4     */
+#define EMAC_NUM_RX_FRAG         16          /**< Num.of RX Fragments 16*256= 4.0kB */
+#define EMAC_NUM_RX_LOAN         12          /**< Rx buffers held by the application
+                                                  or spare 12*256= 3.0kB            */
+#define EMAC_TX_BUF_SIZE         EMAC_ETH_MAX_FLEN /**< Tx copy buffer size        */
+#define EMAC_NUM_TX_FRAG         3           /**< Num.of TX Fragments 3*1536= 4.6kB */
+
+#define EMAC_NUM_RX_BUF          (EMAC_NUM_RX_FRAG + EMAC_NUM_RX_LOAN) /**< Rx buffer pool */
+/** Rx buffers taken by the longest frame */
+#define EMAC_RX_FRAG_MAX         ((EMAC_ETH_MAX_FLEN + EMAC_RX_BUF_SIZE - 1) / EMAC_RX_BUF_SIZE)
+
+/* Descriptors, status words and buffers live in AHB SRAM bank 1, the EMAC
+ * DMA does not compete there with the CPU for the main SRAM. The top of the
+ * bank holds the SD cache lines, bank 0 the GLCD framebuffer */
+#define EMAC_RAM_BASE            LPC_AHBRAM1_BASE
+#define EMAC_RAM_SIZE            0x3000      /**< Bank 1 below the SD cache         */
+
+#define EMAC_RX_STAT_BASE        EMAC_RAM_BASE   /**< 8-byte aligned               */
+#define EMAC_RX_DESC_BASE        (EMAC_RX_STAT_BASE + EMAC_NUM_RX_FRAG * 8)
+#define EMAC_TX_DESC_BASE        (EMAC_RX_DESC_BASE + EMAC_NUM_RX_FRAG * 8)
+#define EMAC_TX_STAT_BASE        (EMAC_TX_DESC_BASE + EMAC_NUM_TX_FRAG * 8)
+#define EMAC_RX_BUF_BASE         (EMAC_TX_STAT_BASE + EMAC_NUM_TX_FRAG * 4)
+#define EMAC_TX_BUF_BASE         (EMAC_RX_BUF_BASE + EMAC_NUM_RX_BUF * EMAC_RX_BUF_SIZE)
+#define EMAC_RAM_END             (EMAC_TX_BUF_BASE + EMAC_NUM_TX_FRAG * EMAC_TX_BUF_SIZE)
+
+#if ((EMAC_RX_BUF_SIZE % 4) || (EMAC_RX_BUF_SIZE > 2048) || (EMAC_TX_BUF_SIZE % 4))
+	#error "EMAC buffer sizes must be multiples of 4, Rx at most 2048"
+#endif
+#if (EMAC_NUM_RX_FRAG < EMAC_RX_FRAG_MAX)
+	#error "EMAC_NUM_RX_FRAG must hold the longest frame"
+#endif
+#if (EMAC_NUM_RX_LOAN < EMAC_RX_FRAG_MAX)
+	#error "EMAC_NUM_RX_LOAN must leave spare Rx buffers for the longest frame"
+#endif
+#if (EMAC_RAM_END > EMAC_RAM_BASE + EMAC_RAM_SIZE)
+	#error "EMAC rings and buffers do not fit EMAC_RAM_SIZE"
+#endif
+
 /* --------------------- BIT DEFINITIONS -------------------------------------- */
 /*********************************************************************//**
  * Macro defines for MAC Configuration Register 1
@@ -573,6 +618,75 @@ typedef struct {
 	uint32_t *pbDataBuf;		/**< A word-align data pointer to data buffer */
 } EMAC_PACKETBUF_Type;
 
+/**
+ * @brief Received frame loaned to the application by EMAC_RxGet(), the
+ * data stays in the DMA buffer until EMAC_RxRelease()
+ */
+typedef struct {
+	uint8_t *pbData;			/**< Frame start, destination address first */
+	uint32_t ulDataLen;			/**< Frame length without the 4-byte FCS */
+	uint32_t ulInfo;			/**< Receive Information Status of the frame */
+	uint32_t ulFrags;			/**< Buffers holding the frame */
+	uint8_t *pbFrag[EMAC_RX_FRAG_MAX];	/**< Buffers in order, all but the last
+									 full EMAC_RX_BUF_SIZE; pbFrag[0] is pbData */
+} EMAC_RXFRAME_Type;
+
+/**
+ * @brief Transmit fragment for EMAC_TxSendV(), sent in place from RAM
+ */
+typedef struct {
+	void *pbData;				/**< Fragment start */
+	uint32_t ulDataLen;			/**< Fragment length, 1 to 2048 bytes */
+} EMAC_IOVEC_Type;
+
+/**
+ * @brief Transmit completion, called from EMAC_TxReclaim() with the pArg
+ * given to EMAC_TxSendV() and the Transmit Information Status of the
+ * last fragment
+ */
+typedef void (*EMAC_TXDONE_CB_Type)(void *pArg, uint32_t ulInfo);
+
+/**
+ * @brief EMAC statistics. The interrupt is the only writer of the Rx and
+ * interrupt counters, the Tx path of the tx_ ones, EMAC_GetStats() takes a
+ * consistent copy
+ */
+typedef struct {
+	uint32_t rx_overrun;		/**< Receive overrun interrupts */
+	uint32_t rx_error;			/**< Receive errors, range errors excluded */
+	uint32_t rx_finished;		/**< All Rx descriptors used */
+	uint32_t rx_done;			/**< Receive Done interrupts */
+	uint32_t tx_underrun;		/**< Transmit underrun interrupts */
+	uint32_t tx_error;			/**< Transmit errors */
+	uint32_t tx_finished;		/**< All Tx descriptors sent */
+	uint32_t tx_done;			/**< Transmit Done interrupts */
+	uint32_t wakeup;			/**< Wakeup events */
+	uint32_t rx_frames;			/**< Frames queued for EMAC_RxGet() */
+	uint32_t rx_bytes;			/**< Their bytes, FCS excluded */
+	uint32_t rx_drop_error;		/**< Frames dropped for an error status */
+	uint32_t rx_drop_nodescr;	/**< Frames cut short, no free descriptor */
+	uint32_t rx_drop_length;	/**< Runts and frames over EMAC_RX_FRAG_MAX buffers */
+	uint32_t rx_stall;			/**< Times a frame waited for free buffers */
+	uint32_t rx_ring_peak;		/**< Most Rx descriptors found filled */
+	uint32_t rx_ready_peak;		/**< Most frames queued for EMAC_RxGet() */
+	uint32_t tx_frames;			/**< Frames queued for transmit */
+	uint32_t tx_bytes;			/**< Their bytes, FCS excluded */
+	uint32_t tx_ring_peak;		/**< Most Tx descriptors in use */
+	uint32_t trace_lost;		/**< Events not traced, ring full */
+} EMAC_STATS_Type;
+
+#ifdef EMAC_TRACE_MODE
+/**
+ * @brief Interrupt event, cycles from the DWT cycle counter
+ */
+typedef struct {
+	uint32_t cycles;			/**< Time of the event */
+	uint16_t event;				/**< One EMAC_INT_ bit */
+	uint16_t arg;				/**< RX_DONE: frames queued, RX_OVERRUN:
+									 RxProduceIndex, TX_DONE: TxConsumeIndex */
+} EMAC_TRACE_Type;
+#endif
+
 /**
  * @brief EMAC configuration structure definition
  */
@@ -618,20 +732,35 @@ void EMAC_SetFilterMode(uint32_t ulFilterMode, FunctionalState NewState);
 
 /* EMAC Packet Buffer functions */
 void EMAC_WritePacketBuffer(EMAC_PACKETBUF_Type *pDataStruct);
-void EMAC_ReadPacketBuffer(EMAC_PACKETBUF_Type *pDataStruct);
+
+/* EMAC zero-copy receive functions */
+Status EMAC_RxGet(EMAC_RXFRAME_Type *pFrame);
+void EMAC_RxRelease(EMAC_RXFRAME_Type *pFrame);
+uint32_t EMAC_RxPending(void);
+Status EMAC_RxCheckFCS(EMAC_RXFRAME_Type *pFrame);
+
+/* EMAC scatter-gather transmit functions */
+Status EMAC_TxSendV(const EMAC_IOVEC_Type *pIov, uint32_t ulCount,
+		EMAC_TXDONE_CB_Type done, void *pArg);
+uint32_t EMAC_TxReclaim(void);
+
+/* EMAC statistics functions -------*/
+void EMAC_GetStats(EMAC_STATS_Type *pStats);
+void EMAC_ResetStats(void);
+#ifdef EMAC_TRACE_MODE
+Status EMAC_TraceGet(EMAC_TRACE_Type *pEvent);
+void EMAC_TraceDump(LPC_UART_TypeDef *UARTx);
+#endif
 
 /* EMAC Interrupt functions -------*/
 void EMAC_IntCmd(uint32_t ulIntType, FunctionalState NewState);
 IntStatus EMAC_IntGetStatus(uint32_t ulIntType);
 
 /* EMAC Index functions -----------*/
-Bool EMAC_CheckReceiveIndex(void);
 Bool EMAC_CheckTransmitIndex(void);
-void EMAC_UpdateRxConsumeIndex(void);
 void EMAC_UpdateTxProduceIndex(void);
 
 FlagStatus EMAC_CheckReceiveDataStatus(uint32_t ulRxStatType);
-uint32_t EMAC_GetReceiveDataSize(void);
 FlagStatus EMAC_GetWoLStatus(uint32_t ulWoLMode);
 
 /* EMAC webserver functions ----------*/
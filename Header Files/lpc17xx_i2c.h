@@ -37,6 +37,9 @@ extern "C"
 /** Max buffer length */
 #define BUFFER_SIZE			  64
 
+/** Command/register bytes carried inside each queued transaction */
+#define I2C_XFER_CMD_SIZE	  4
+
 #if (I2C_DATABIT_SIZE == 8)
 uint8_t I2C_Tx_Buf[BUFFER_SIZE];
 uint8_t I2C_Rx_Buf[BUFFER_SIZE];
@@ -332,6 +335,30 @@ typedef enum {
 } I2C_TRANSFER_OPT_Type;
 
 
+/**
+ * @brief Queued master transaction, see I2C_MasterSubmit()
+ */
+typedef struct I2C_XFER_Tag I2C_XFER_Type;
+
+/**
+ * @brief Completion callback of a queued transaction, called from the
+ * I2C interrupt with SUCCESS or ERROR (retransmissions exhausted)
+ */
+typedef void (*I2C_XFER_CB_Type)(I2C_XFER_Type *xfer, Status result);
+
+struct I2C_XFER_Tag
+{
+  I2C_M_SETUP_Type  setup;						/**< Transfer setup, as for I2C_MasterTransferData() */
+  uint8_t           cmd[I2C_XFER_CMD_SIZE];		/**< Command bytes owned by the transaction,
+													  setup.tx_data may point here */
+  uint8_t           chain;						/**< TRUE: next transaction follows with a
+													  repeated START instead of STOP/START */
+  I2C_XFER_CB_Type  complete;					/**< Completion callback - NULL if not used */
+  void              *arg;						/**< User argument for the callback */
+  I2C_XFER_Type     *next;						/**< Queue link, managed by the driver */
+};
+
+
 /**
  * @}
  */
@@ -357,6 +384,13 @@ Status I2C_SlaveTransferData(LPC_I2C_TypeDef *I2Cx, \
 		I2C_S_SETUP_Type *TransferCfg, I2C_TRANSFER_OPT_Type Opt);
 uint32_t I2C_MasterTransferComplete(LPC_I2C_TypeDef *I2Cx);
 uint32_t I2C_SlaveTransferComplete(LPC_I2C_TypeDef *I2Cx);
+Status I2C_MasterWriteGather(LPC_I2C_TypeDef *I2Cx, uint32_t sl_addr7bit, \
+		uint8_t *head, uint32_t head_len, uint8_t *data, uint32_t data_len);
+Status I2C_MasterAckPoll(LPC_I2C_TypeDef *I2Cx, uint32_t sl_addr7bit, uint32_t max_tries);
+
+/* I2C transaction queue functions ---- */
+Status I2C_MasterSubmit(LPC_I2C_TypeDef *I2Cx, I2C_XFER_Type *xfer, uint32_t num);
+FlagStatus I2C_MasterQueueBusy(LPC_I2C_TypeDef *I2Cx);
 
 
 void I2C_SetOwnSlaveAddr(LPC_I2C_TypeDef *I2Cx, I2C_OWNSLAVEADDR_CFG_Type *OwnSlaveAddrConfigStruct);
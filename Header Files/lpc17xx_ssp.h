@@ -163,6 +163,11 @@ uint16_t Rx_Buf1[BUFFER_SIZE1];
 #define SSP_STAT_DONE		(1UL<<8)		/**< Done */
 #define SSP_STAT_ERROR		(1UL<<9)		/**< Error */
 
+/** Linked list items per direction used by one SSP DMA segment, a segment
+ * moves up to (SSP_DMA_LLI_NUM+1)*GPDMA_MAX_TRANSFER frames, longer
+ * transfers are re-armed segment by segment from the DMA interrupt */
+#define SSP_DMA_LLI_NUM		4
+
 /**
  * @}
  */
@@ -390,7 +395,8 @@ typedef struct {
  */
 typedef enum {
 	SSP_TRANSFER_POLLING = 0,	/**< Polling transfer */
-	SSP_TRANSFER_INTERRUPT		/**< Interrupt transfer */
+	SSP_TRANSFER_INTERRUPT,		/**< Interrupt transfer */
+	SSP_TRANSFER_DMA			/**< GPDMA transfer */
 } SSP_TRANSFER_Type;
 
 /**
@@ -425,12 +431,14 @@ void SSP_DeInit(LPC_SSP_TypeDef* SSPx);
 
 /* SSP configure functions ----------------------------------------------------*/
 void SSP_ConfigStructInit(SSP_CFG_Type *SSP_InitStruct);
+void SSP_SetClock (LPC_SSP_TypeDef *SSPx, uint32_t target_clock);
 
 /* SSP enable/disable functions -----------------------------------------------*/
 void SSP_Cmd(LPC_SSP_TypeDef* SSPx, FunctionalState NewState);
 void SSP_LoopBackCmd(LPC_SSP_TypeDef* SSPx, FunctionalState NewState);
 void SSP_SlaveOutputCmd(LPC_SSP_TypeDef* SSPx, FunctionalState NewState);
 void SSP_DMACmd(LPC_SSP_TypeDef *SSPx, uint32_t DMAMode, FunctionalState NewState);
+FlagStatus SSP_DMABusy(LPC_SSP_TypeDef *SSPx);
 
 /* SSP get information functions ----------------------------------------------*/
 FlagStatus SSP_GetStatus(LPC_SSP_TypeDef* SSPx, uint32_t FlagType);
@@ -65,6 +65,7 @@ extern "C"
 #define 	INTERRUPT_SEL     ENABLE
 #define     AB_SEL            DISABLE
 #define     RTC_SUPPORT       DISABLE
+#define     UART_STATS_SEL    DISABLE      // ISR cycle counts, UART_GetStats()
 
 /******************************************************************************/
 /*                       UART Mode validation                                 */
@@ -85,6 +86,10 @@ extern "C"
     #define AB_MODE
 #endif
 
+#if UART_STATS_SEL
+    #define UART_STATS_MODE
+#endif
+
 #if RTC_SUPPORT
 	#define RTC_MODE
 	#include "lpc17xx_rtc.h"
@@ -94,33 +99,46 @@ extern "C"
 /******************************************************************************/
 /*                       UART Buffer Definition                               */
 /******************************************************************************/
-/* buffer size definition */
-#define UART_RING_BUFSIZE 256
-
-/* Buf mask */
-#define __BUF_MASK (UART_RING_BUFSIZE-1)
-/* Check buf is full or not */
-#define __BUF_IS_FULL(head, tail) ((tail&__BUF_MASK)==((head+1)&__BUF_MASK))
-/* Check buf will be full in next receiving or not */
-#define __BUF_WILL_FULL(head, tail) ((tail&__BUF_MASK)==((head+2)&__BUF_MASK))
-/* Check buf is empty */
-#define __BUF_IS_EMPTY(head, tail) ((head&__BUF_MASK)==(tail&__BUF_MASK))
-/* Reset buf */
-#define __BUF_RESET(bufidx)	(bufidx=0)
-#define __BUF_INCR(bufidx)	(bufidx=(bufidx+1)&__BUF_MASK)
+/* Ring buffer size per port (bytes, power of 2), used for both directions */
+#define UART0_RING_BUFSIZE 256
+#define UART1_RING_BUFSIZE 64
+#define UART2_RING_BUFSIZE 256
+#define UART3_RING_BUFSIZE 64
+
+/* printf() renders into a stack buffer of this size and queues it with one
+ * UART_Send() per buffer (longer output is flushed as the buffer fills) */
+#define UART_PRINTF_BUFSIZE 64
 
 /************************** BUFFER TYPES *************************/
 
-/** @brief UART Ring buffer structure */
+/** @brief Single producer / single consumer byte ring. head is written only
+ * by the producer and tail only by the consumer, both count freely and are
+ * masked on access, so neither side has to mask interrupts */
+typedef struct
+{
+    __IO uint32_t head;                   /*!< Bytes written since reset */
+    __IO uint32_t tail;                   /*!< Bytes read since reset */
+    uint32_t      mask;                   /*!< Ring size - 1 */
+    __IO uint8_t  *buf;                   /*!< Ring storage */
+} UART_RING_Type;
+
+/** @brief UART port ring buffers */
 typedef struct
 {
-    __IO uint32_t tx_head;                /*!< UART Tx ring buffer head index */
-    __IO uint32_t tx_tail;                /*!< UART Tx ring buffer tail index */
-    __IO uint32_t rx_head;                /*!< UART Rx ring buffer head index */
-    __IO uint32_t rx_tail;                /*!< UART Rx ring buffer tail index */
-    __IO uint8_t  tx[UART_RING_BUFSIZE];  /*!< UART Tx data ring buffer */
-    __IO uint8_t  rx[UART_RING_BUFSIZE];  /*!< UART Rx data ring buffer */
-} UART_RING_BUFFER_T;
+    UART_RING_Type tx;                    /*!< UART_Send -> THRE interrupt */
+    UART_RING_Type rx;                    /*!< RX interrupt -> UART_Receive */
+    __IO FlagStatus TxIntStat;            /*!< Current Tx Interrupt enable state */
+} UART_PORT_Type;
+
+/** @brief UART interrupt statistics, cycles from the DWT cycle counter */
+typedef struct
+{
+    uint32_t count;                       /*!< Interrupts serviced */
+    uint32_t cycles;                      /*!< Cycles spent in the last one */
+    uint32_t max;                         /*!< Longest interrupt in cycles */
+    uint64_t total;                       /*!< Cycles spent in all of them */
+    uint32_t tx_bytes;                    /*!< Bytes loaded into the TX FIFO */
+} UART_STATS_Type;
 
 
 /*
@@ -128,15 +146,6 @@ typedef struct
  */
 
 extern uint16 EscFlag;
-Bool UART0_RxReady,UART2_RxReady;
-extern uchar TTrgLvlU0,TrgLvlU2;
-// UART Ring buffer
-
-UART_RING_BUFFER_T rb0;
-UART_RING_BUFFER_T rb2;
-
-// Current Tx Interrupt enable state
-__IO FlagStatus TxIntStat;
 
 #ifdef AB_MODE
 /* Synchronous Flag */
@@ -735,6 +744,14 @@ void UART_IrDAPulseDivConfig(LPC_UART_TypeDef *UARTx, UART_IrDA_PULSE_Type Pulse
 uint32_t UART_Send(LPC_UART_TypeDef *UARTx, uint8_t *txbuf,
 		uint32_t buflen, TRANSFER_BLOCK_Type flag);
 uint32_t UART_Receive(LPC_UART_TypeDef *UARTx, uint8_t *rxbuf,uint32_t buflen, TRANSFER_BLOCK_Type flag);
+uint32_t UART_TxPeek(LPC_UART_TypeDef *UARTx, uint8_t **buf);
+void UART_TxCommit(LPC_UART_TypeDef *UARTx, uint32_t len);
+uint32_t UART_RxPeek(LPC_UART_TypeDef *UARTx, uint8_t **buf);
+void UART_RxCommit(LPC_UART_TypeDef *UARTx, uint32_t len);
+#ifdef UART_STATS_MODE
+void UART_GetStats(LPC_UART_TypeDef *UARTx, UART_STATS_Type *stats);
+void UART_ResetStats(LPC_UART_TypeDef *UARTx);
+#endif
 #endif
 
 /* UART VT100 Terminal functions--------------------------------------------------------*/
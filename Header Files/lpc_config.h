@@ -0,0 +1,113 @@
+/******************************************************************//**
+* @file		lpc_config.h
+* @brief	Contains the persisted system configuration declarations
+* @version	1.0
+* @date		19. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup CONFIG
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC_CONFIG_H_
+#define LPC_CONFIG_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_system_init.h"
+#include "lpc17xx_rtc.h"
+#include "lpc_nvm.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup CONFIG_Public_Macros
+ * @{
+ */
+
+/* The record is kept in two EEPROM slots written alternately, so a power
+ * cut during CFG_Save() leaves the previous one intact, and mirrored in
+ * the RTC general purpose registers, which survive a reset: a warm boot
+ * loads it from there without touching the I2C bus. */
+#define CFG_DEV             (&NVM_M24256)   /* Device holding the slots     */
+#define CFG_BUS_INIT()      I2C_Config(LPC_I2C0)
+#define CFG_BASE            0x6F80          /* Two pages below the key/value
+                                               log                          */
+#define CFG_SLOT_SIZE       64              /* One write page per slot      */
+
+#define CFG_VERSION         1               /* Bump when CFG_DATA_Type changes */
+
+/* Defaults when no valid record exists */
+#define CFG_DEF_UART0_BAUD  9600
+#define CFG_DEF_UART2_BAUD  115200
+#define CFG_DEF_LED_DELAY   1000
+
+/**
+ * @brief Configuration settings, three words to fit the RTC registers
+ */
+typedef struct
+{
+	uint32_t uart0_baud;
+	uint32_t uart2_baud;
+	uint32_t led_delay;			/* Heart beat toggle in ms */
+}CFG_DATA_Type;
+
+/**
+ * @brief Where CFG_Load() found the configuration
+ */
+typedef enum
+{
+	CFG_SRC_DEFAULT,			/* No valid record, defaults in use */
+	CFG_SRC_GPREG,				/* RTC mirror, warm boot */
+	CFG_SRC_EEPROM				/* EEPROM slot, cold boot */
+}CFG_SOURCE_Type;
+
+/**
+ * @brief Last load, cycles from the DWT cycle counter
+ */
+typedef struct
+{
+	CFG_SOURCE_Type source;
+	uint16_t generation;		/* Of the record in use */
+	uint32_t cycles;			/* Spent in CFG_Load() */
+}CFG_INFO_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup CONFIG_Public_Functions CONFIG Public Functions
+ * @{
+ */
+
+CFG_SOURCE_Type CFG_Load (void);
+const CFG_DATA_Type *CFG_Get (void);
+Status CFG_Save (CFG_DATA_Type *data);
+void CFG_GetInfo (CFG_INFO_Type *info);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC_CONFIG_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -0,0 +1,78 @@
+/******************************************************************//**
+* @file		lpc_crc16.h
+* @brief	Contains the CRC-16 (CCITT) declarations
+* @version	1.0
+* @date		21. Jan. 2014
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup CRC16
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC_CRC16_H_
+#define LPC_CRC16_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_types.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup CRC16_Public_Macros
+ * @{
+ */
+
+/* One byte through the register, for loops that interleave the CRC with
+ * moving the data (SD block streaming) */
+#define CRC16_BYTE(crc, data)   ((uint16_t)(((crc) << 8) ^ \
+                                 CRC16_Table[(((crc) >> 8) ^ (data)) & 0xFF]))
+
+/**
+ * @}
+ */
+
+
+/* Public Variables ----------------------------------------------------------- */
+/** @defgroup CRC16_Public_Variables CRC16 Public Variables
+ * @{
+ */
+
+extern const uint16_t CRC16_Table[256];
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup CRC16_Public_Functions CRC16 Public Functions
+ * @{
+ */
+
+uint16_t CRC16_Update (uint16_t crc, const uint8_t *buf, uint32_t len);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC_CRC16_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -0,0 +1,73 @@
+/******************************************************************//**
+* @file		lpc_crc32.h
+* @brief	Contains the CRC-32 (IEEE 802.3) declarations
+* @version	1.0
+* @date		21. Jan. 2014
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup CRC32
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC_CRC32_H_
+#define LPC_CRC32_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_types.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup CRC32_Public_Macros
+ * @{
+ */
+
+/* Slicing-by-4 takes a word per step from 4 KB of tables, otherwise a byte
+ * per step from the 1 KB table */
+#define CRC32_SLICE4_SEL    ENABLE
+
+#if CRC32_SLICE4_SEL
+#define CRC32_SLICE4_MODE
+#endif
+
+#define CRC32_INIT          0xFFFFFFFF      /* Register before the first byte */
+#define CRC32_RESIDUE       0xDEBB20E3      /* Register after data and its FCS */
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup CRC32_Public_Functions CRC32 Public Functions
+ * @{
+ */
+
+uint32_t CRC32_Update (uint32_t crc, const uint8_t *buf, uint32_t len);
+uint32_t CRC32_Calc (const uint8_t *buf, uint32_t len);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC_CRC32_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -32,6 +32,23 @@ extern "C"
  */
 #define  E2P24C16_ID    (0xA0>>1)
 
+/** Capacity in bytes, 16 Kbit */
+#define  E2P24C16_SIZE    0x800
+
+/** Write page size in bytes, a write must not cross a page boundary */
+#define  E2P24C16_PAGE    16
+
+/** Address probes while waiting for an internal write cycle (5ms max) */
+#define  E2P24C16_ACKPOLL 500
+
+/** Read-compare each page before writing and skip unchanged pages:
+ *  saves the write cycle and wear when re-provisioning the same image */
+#define E2P24C16_SKIP_SEL    ENABLE
+
+#if E2P24C16_SKIP_SEL
+#define E2P24C16_SKIP_MODE
+#endif
+
 
 /**
  * @}
@@ -47,6 +64,8 @@ char I2C_Eeprom_Write_Byte (uint16 eep_address, uint8_t byte_data);
 uint8_t I2C_Eeprom_Read_Byte (uint16_t eep_address);
 char I2C_Eeprom_Write (uint16_t eep_address, uint8_t* byte_data, uint16_t length);
 char I2C_Eeprom_Read (uint16_t eep_address, uint8_t* buf_data, uint16_t length);
+Status I2C_Eeprom_Read_Async (I2C_XFER_Type *xfer, uint16_t eep_address, uint8_t* buf_data,
+		uint16_t length, I2C_XFER_CB_Type cb, void *arg);
 void Display_Eeprom_Array (uint8_t *string, uint16_t length);
 void Display_Eeprom_Loc (uint16 mem_start_address, uint16 mem_end_address);
 
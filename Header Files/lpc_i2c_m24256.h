@@ -32,6 +32,26 @@ extern "C"
  */
 #define  E2PM24256_ID    (0xAE>>1)
 
+/** Capacity in bytes, 256 Kbit */
+#define  E2PM24256_SIZE    0x8000
+
+/** Word address bits, 15 for 32 KByte */
+#define  E2PM24256_ADDR_MASK   (E2PM24256_SIZE - 1)
+
+/** Write page size in bytes, a write must not cross a page boundary */
+#define  E2PM24256_PAGE    64
+
+/** Address probes while waiting for an internal write cycle (5ms max) */
+#define  E2PM24256_ACKPOLL 500
+
+/** Read-compare each page before writing and skip unchanged pages:
+ *  saves the write cycle and wear when re-provisioning the same image */
+#define E2PM24256_SKIP_SEL    ENABLE
+
+#if E2PM24256_SKIP_SEL
+#define E2PM24256_SKIP_MODE
+#endif
+
 
 /**
  * @}
@@ -47,6 +67,8 @@ char I2C_IEeprom_Write_Byte (uint16_t eep_address, uint8_t byte_data);
 uint8_t I2C_IEeprom_Read_Byte (uint16_t eep_address);
 char I2C_IEeprom_Write (uint16_t eep_address, uint8_t* byte_data, uint16_t length);
 char I2C_IEeprom_Read (uint16_t eep_address, uint8_t* buf_data, uint16_t length);
+Status I2C_IEeprom_Read_Async (I2C_XFER_Type *xfer, uint16_t eep_address, uint8_t* buf_data,
+		uint16_t length, I2C_XFER_CB_Type cb, void *arg);
 void Display_IEeprom_Array (uint8_t *string, uint16_t length);
 void Display_IEeprom_Loc (uint16_t mem_start_address, uint16_t mem_end_address);
 
@@ -100,6 +100,8 @@ uchar TMP102_Set_Config(uint16_t val);
 uchar TMP102_Set_Threshold_Value(THRES_Type limit, int16_t deg, BIT_Type res);
 uchar TMP102_Read_Threshold_Value(THRES_Type limit, BIT_Type res);
 uchar TMP102_Read_Temp(BIT_Type res);
+Status TMP102_Read_Temp_Async(I2C_XFER_Type *xfer, uint8_t *buf, I2C_XFER_CB_Type cb, void *arg);
+int16_t TMP102_Temp_Count(uint8_t *buf, BIT_Type res);
 
 /**
  * @}
@@ -145,6 +145,19 @@ typedef struct
 }ts_event;
 
 
+/**
+ * @brief Queued X,Y,Z1,Z2 read context, see TSC2004_Read_Values_Async()
+ */
+typedef struct
+{
+	I2C_XFER_Type xfer[4];                      /* X, Y, Z1, Z2 register reads */
+	uint8_t       data[4][2];                   /* Raw values, MSB first */
+	ts_event      *tc;                          /* Destination of the values */
+	Status        result;                       /* ERROR if any read failed */
+	void          (*done)(ts_event *tc, Status result);  /* Called from the I2C interrupt */
+}TSC2004_ASYNC_Type;
+
+
 /**
  * @}
  */
@@ -162,6 +175,8 @@ uint16_t I2C_TSC2004_Read_Word (uint8_t Command);
 
 uint16_t TSC2004_Read_Reg (register_address reg);
 void TSC2004_Read_Values (ts_event *tc);
+Status TSC2004_Read_Values_Async (TSC2004_ASYNC_Type *ctx, ts_event *tc,
+		void (*done)(ts_event *tc, Status result));
 
 void TSC2004_Read_Value_Test (void);
 void TSC2004_Draw_Test (void);
@@ -0,0 +1,142 @@
+/******************************************************************//**
+* @file		lpc_nvm.h
+* @brief	Contains the common nonvolatile memory interface over the
+*           I2C and SPI/SSP EEPROM drivers
+* @version	1.0
+* @date		18. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup NVM
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC_NVM_H_
+#define LPC_NVM_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_system_init.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup NVM_Public_Macros
+ * @{
+ */
+
+/* Device backends built in, each one exports its NVM_DEV_Type below.
+ * The SPI block and SSP0 share the P0.15-P0.18 pins, enable one of the
+ * two 25AA160A backends */
+#define NVM_M24256_SEL      ENABLE
+#define NVM_AT24C16_SEL     ENABLE
+#define NVM_25AA160A_SSP_SEL ENABLE
+#define NVM_25AA160A_SPI_SEL DISABLE
+
+#define NVM_25AA160A_PORT   LPC_SSP0    /* SSP port the 25AA160A is wired to */
+
+#define NVM_PAGE_MAX        64          /* Largest write page of a backend,
+                                           sizes the copy/compare buffer    */
+
+/* NVM_Bench() times the backends with the DWT cycle counter */
+#define NVM_BENCH_SEL       DISABLE
+
+#if NVM_BENCH_SEL
+#define NVM_BENCH_MODE
+#endif
+
+/**
+ * @brief Nonvolatile memory device, the backend operations and geometry
+ */
+typedef struct
+{
+	const char *name;
+	uint32_t size;			/* Capacity in bytes */
+	uint16_t page;			/* Write page, a write never crosses one */
+	uint16_t write_ms;		/* Worst case write cycle of one page */
+	Status (*read) (uint32_t addr, uint8_t *buf, uint32_t len);
+	Status (*write) (uint32_t addr, uint8_t *buf, uint32_t len);
+}NVM_DEV_Type;
+
+#ifdef NVM_BENCH_MODE
+/**
+ * @brief Throughput of one device, cycles from the DWT cycle counter
+ */
+typedef struct
+{
+	uint32_t read_cycles;		/* Reading the whole range at once */
+	uint32_t write_cycles;		/* Writing a new pattern over it */
+	uint32_t update_cycles;		/* NVM_Update() with unchanged data */
+	uint32_t read_bps;			/* Bytes per second */
+	uint32_t write_bps;
+	uint32_t update_bps;
+}NVM_BENCH_Type;
+#endif
+
+/**
+ * @}
+ */
+
+
+/* Public Variables ----------------------------------------------------------- */
+/** @defgroup NVM_Public_Variables
+ * @{
+ */
+
+#if NVM_M24256_SEL
+extern const NVM_DEV_Type NVM_M24256;
+#endif
+#if NVM_AT24C16_SEL
+extern const NVM_DEV_Type NVM_AT24C16;
+#endif
+#if NVM_25AA160A_SSP_SEL
+extern const NVM_DEV_Type NVM_25AA160A_Ssp;
+#endif
+#if NVM_25AA160A_SPI_SEL
+extern const NVM_DEV_Type NVM_25AA160A_Spi;
+#endif
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup NVM_Public_Functions NVM Public Functions
+ * @{
+ */
+
+Status NVM_Read (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len);
+Status NVM_Write (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len);
+Status NVM_Update (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len);
+Status NVM_Verify (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len);
+Status NVM_Copy (const NVM_DEV_Type *dst, uint32_t dst_addr,
+		const NVM_DEV_Type *src, uint32_t src_addr, uint32_t len);
+#ifdef NVM_BENCH_MODE
+Status NVM_Bench (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len,
+		NVM_BENCH_Type *res);
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC_NVM_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -0,0 +1,118 @@
+/******************************************************************//**
+* @file		lpc_nvm_kv.h
+* @brief	Contains the log-structured key/value store declarations
+* @version	1.0
+* @date		18. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup NVM_KV
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC_NVM_KV_H_
+#define LPC_NVM_KV_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_system_init.h"
+#include "lpc_nvm.h"
+#include "lpc_i2c_m24256.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup NVM_KV_Public_Macros
+ * @{
+ */
+
+/* Values are never rewritten in place: every update is a new record
+ * appended round-robin over the log area, so the write cycles spread over
+ * all of its pages. The newest valid record of a key wins at boot. */
+#define KV_DEV              (&NVM_M24256)   /* Device holding the log       */
+#define KV_SIZE             0x1000          /* Log area in bytes            */
+#define KV_BASE             (E2PM24256_SIZE - KV_SIZE)  /* Top of the part  */
+
+#define KV_REC_SIZE         32              /* Record slot, a divisor of the
+                                               device page keeps it in one
+                                               write cycle                  */
+#define KV_VALUE_MAX        (KV_REC_SIZE - 13)
+#define KV_KEYS_MAX         32              /* Keys in the RAM index        */
+#define KV_SLOTS            (KV_SIZE / KV_REC_SIZE)
+#define KV_FREE_MIN         (KV_SLOTS / 4)  /* KV_Compact() works until this
+                                               many slots are free          */
+#define KV_SCAN_CHUNK       256             /* Bytes per read of the boot scan */
+
+#if (KV_SLOTS < KV_KEYS_MAX + 2)
+	#error "KV_SIZE must hold every key plus two free slots"
+#endif
+#if (KV_SCAN_CHUNK % KV_REC_SIZE)
+	#error "KV_SCAN_CHUNK must be a multiple of KV_REC_SIZE"
+#endif
+
+/* Record and cycle counters, cycles from the DWT cycle counter */
+#define KV_STATS_SEL        DISABLE
+
+#if KV_STATS_SEL
+#define KV_STATS_MODE
+#endif
+
+#ifdef KV_STATS_MODE
+/**
+ * @brief Key/value store counters
+ */
+typedef struct
+{
+	uint32_t appends;			/* Records written, moves included */
+	uint32_t unchanged;			/* KV_Set() calls skipped, same value */
+	uint32_t moved;				/* Live records copied forward by compaction */
+	uint32_t dropped;			/* Tombstones released by compaction */
+	uint32_t forced;			/* Compaction steps run inside KV_Set() */
+	uint32_t scan_cycles;		/* Boot scan in KV_Init() */
+	uint32_t set_cycles;		/* Last KV_Set() */
+	uint32_t set_max;			/* Slowest KV_Set() */
+}KV_STATS_Type;
+#endif
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup NVM_KV_Public_Functions NVM_KV Public Functions
+ * @{
+ */
+
+Status KV_Init (void);
+Status KV_Get (uint16_t key, uint8_t *buf, uint8_t *len);
+Status KV_Set (uint16_t key, uint8_t *val, uint8_t len);
+Status KV_Delete (uint16_t key);
+Status KV_Compact (void);
+#ifdef KV_STATS_MODE
+void KV_GetStats (KV_STATS_Type *stats);
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC_NVM_KV_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
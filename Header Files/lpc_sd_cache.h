@@ -0,0 +1,94 @@
+/******************************************************************//**
+* @file		lpc_sd_cache.h
+* @brief	Contains all SD sector cache declarations
+* @version	1.0
+* @date		10. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup SD_CACHE
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC_SD_CACHE_H_
+#define LPC_SD_CACHE_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_system_init.h"
+#include "lpc_spi_sd.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup SD_CACHE_Public_Macros
+ * @{
+ */
+
+#define SD_CACHE_SECTORS    8                   /* Cache lines of one sector  */
+#define SD_CACHE_READAHEAD  4                   /* Sectors read by CMD18 on a
+                                                   sequential miss            */
+#define SD_CACHE_BYPASS     SD_CACHE_SECTORS    /* Transfers this long go to
+                                                   the card directly          */
+#define SD_CACHE_SIZE       (SD_CACHE_SECTORS * SD_BLOCK_SIZE)
+
+/* AHB SRAM bank 0 is the GLCD framebuffer and the bottom of bank 1 the EMAC
+ * rings (EMAC_RAM_SIZE), the cache lines sit at the top of bank 1 */
+#define SD_CACHE_BASE       (LPC_AHBRAM1_BASE + 0x4000 - SD_CACHE_SIZE)
+
+#if (SD_CACHE_READAHEAD >= SD_CACHE_SECTORS)
+	#error "SD_CACHE_READAHEAD must leave room for other cache lines"
+#endif
+
+/**
+ * @brief SD cache counters
+ */
+typedef struct
+{
+	uint32_t hits;				/* Sectors served from a cache line */
+	uint32_t misses;			/* Sectors that needed a new line */
+	uint32_t evictions;			/* Valid lines reused for another sector */
+	uint32_t writebacks;		/* Dirty sectors written to the card */
+	uint32_t prefetched;		/* Sectors read ahead of the request */
+	uint32_t bypassed;			/* Sectors moved without the cache */
+}SD_CACHE_STATS_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup SD_CACHE_Public_Functions SD_CACHE Public Functions
+ * @{
+ */
+
+void SD_CacheInit (void);
+sd_error SD_CacheRead (uint32_t sector, uint8_t *buf, uint32_t count);
+sd_error SD_CacheWrite (uint32_t sector, uint8_t *buf, uint32_t count);
+sd_error SD_CacheSync (void);
+void SD_CacheGetStats (SD_CACHE_STATS_Type *stats);
+void SD_CacheResetStats (void);
+
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC_SD_CACHE_H_ */
+
+/**
+ * @}
+ */
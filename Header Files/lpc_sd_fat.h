@@ -0,0 +1,113 @@
+/******************************************************************//**
+* @file		lpc_sd_fat.h
+* @brief	Contains all FAT16/FAT32 file system declarations for the
+*           SD card
+* @version	1.0
+* @date		10. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup FAT
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC_SD_FAT_H_
+#define LPC_SD_FAT_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_system_init.h"
+#include "lpc_spi_sd.h"
+#include "lpc_sd_cache.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup FAT_Public_Macros
+ * @{
+ */
+
+/* Files are read sequentially or appended to, names are 8.3 (long names are
+ * skipped) and paths are '/' separated from the root directory */
+#define FAT_MODE_READ       0x01        /* Read from the start, FAT_Seek()    */
+#define FAT_MODE_APPEND     0x02        /* Write at the end, create if needed */
+
+#define FAT_PREALLOC        16          /* Contiguous clusters reserved when an
+                                           appended file needs a new cluster  */
+#define FAT_RUN_MAX         64          /* Clusters checked ahead for a
+                                           contiguous read run                */
+#define FAT_BMP_CHUNK       256         /* Pixels per FAT_Bitmap() read       */
+
+typedef enum _fat_error
+{
+	FAT_OK,
+	FAT_ERR_DISK,			/* SD card read or write failed */
+	FAT_ERR_NO_FS,			/* No FAT16/FAT32 volume with 512 byte sectors */
+	FAT_ERR_NOT_MOUNTED,
+	FAT_ERR_NAME,			/* Path component is not a valid 8.3 name */
+	FAT_ERR_NOT_FOUND,
+	FAT_ERR_NOT_FILE,		/* Path names a directory */
+	FAT_ERR_DIR_FULL,		/* No free entry in the directory */
+	FAT_ERR_FULL,			/* No free cluster, or file at 4GB */
+	FAT_ERR_MODE,			/* Operation not allowed in the open mode */
+	FAT_ERR_CHAIN,			/* Cluster chain shorter than the file */
+	FAT_ERR_FORMAT			/* File too short for the requested bitmap */
+}fat_error;
+
+/**
+ * @brief Open file, the position and chain state of one stream
+ */
+typedef struct
+{
+	uint32_t first;			/* First cluster, 0 for an empty file */
+	uint32_t size;			/* File size in bytes */
+	uint32_t pos;			/* Stream position */
+	uint32_t cluster;		/* Cluster holding byte pos-1 */
+	uint32_t run_end;		/* Clusters cluster..run_end-1 are contiguous */
+	uint32_t dir_sector;	/* Sector of the directory entry */
+	uint16_t dir_offset;	/* Offset of the directory entry in it */
+	uint8_t mode;			/* FAT_MODE_READ or FAT_MODE_APPEND, 0 if closed */
+	uint8_t dirty;			/* Directory entry needs an update */
+}FAT_FILE_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup FAT_Public_Functions FAT Public Functions
+ * @{
+ */
+
+fat_error FAT_Mount (void);
+fat_error FAT_Open (FAT_FILE_Type *file, const char *path, uint8_t mode);
+fat_error FAT_Read (FAT_FILE_Type *file, void *buf, uint32_t len, uint32_t *done);
+fat_error FAT_Seek (FAT_FILE_Type *file, uint32_t offset);
+fat_error FAT_Append (FAT_FILE_Type *file, const void *buf, uint32_t len);
+fat_error FAT_Sync (FAT_FILE_Type *file);
+fat_error FAT_Close (FAT_FILE_Type *file);
+fat_error FAT_Bitmap (uint16_t x, uint16_t y, uint16_t w, uint16_t h, const char *path);
+
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC_SD_FAT_H_ */
+
+/**
+ * @}
+ */
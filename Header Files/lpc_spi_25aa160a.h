@@ -18,6 +18,7 @@
 /* Includes ------------------------------------------------------------------- */
 #include "LPC17xx.h"
 #include "lpc_system_init.h"
+#include "lpc17xx_spi.h"
 
 
 #ifdef __cplusplus
@@ -31,12 +32,19 @@ extern "C"
  * @{
  */
 
-#define EEP_WRITE  0x02;  /* Write bit of IR     */
-#define EEP_READ   0x03;  /* Read bit of IR      */
-#define EEP_WREN   0x06;  /* Write Enable Latch  */
-#define EEP_WRDI   0x04;  /* Write Disable Latch */
-#define EEP_RDSR   0x05;  /* Read Status Reg     */
-#define EEP_WRSR   0x01;  /* Write Status Reg    */
+#define EEP_WRITE  0x02   /* Write bit of IR     */
+#define EEP_READ   0x03   /* Read bit of IR      */
+#define EEP_WREN   0x06   /* Write Enable Latch  */
+#define EEP_WRDI   0x04   /* Write Disable Latch */
+#define EEP_RDSR   0x05   /* Read Status Reg     */
+#define EEP_WRSR   0x01   /* Write Status Reg    */
+
+#define EEP_SR_WIP     0x01    /* Write In Progress bit of status reg   */
+
+#define EEP_SIZE       0x800   /* 25AA160A capacity, 2 KB               */
+#define EEP_PAGE_SIZE  16      /* Write page, a write wraps inside it   */
+#define EEP_WIP_POLL   10000   /* Status reads before a write cycle is
+                                  given up (tWC is 5 ms max)            */
 
 /**
  * @}
@@ -48,16 +56,16 @@ extern "C"
  * @{
  */
 
-void print_status_reg(void);
-void Read_Eeprom_Status (void);
+void Spi_Print_Status_Reg(void);
+void Spi_Read_Eeprom_Status (void);
 uint8_t Spi_Eeprom_Read_Status_Reg (void);
 uchar Spi_Eeprom_Write_Status_Reg (uint8_t status_reg);
 uchar Spi_Eeprom_Write_Byte (uint16 eep_address, uint8_t byte_data);
-uchar Spi_Eeprom_Write (uint16_t eep_address, uint8_t *data_start, uint8_t length);
+uchar Spi_Eeprom_Write (uint16_t eep_address, uint8_t *data_start, uint16_t length);
 uint8_t Spi_Eeprom_Read_Byte (uint16 eep_address);
-uchar Spi_Eeprom_Read (uint16_t eep_address, uint8_t *dest_addr, uint8_t length);
-void Display_Eeprom_Array (uint8_t *string, uint8_t length);
-void Display_Eeprom_Loc (uint16 mem_start_address, uint16 mem_end_address);
+uchar Spi_Eeprom_Read (uint16_t eep_address, uint8_t *dest_addr, uint16_t length);
+void Spi_Display_Eeprom_Array (uint8_t *string, uint8_t length);
+void Spi_Display_Eeprom_Loc (uint16 mem_start_address, uint16 mem_end_address);
 
 /**
  * @}
@@ -18,6 +18,9 @@
 /* Includes ------------------------------------------------------------------- */
 #include "LPC17xx.h"
 #include "lpc_system_init.h"
+#include "lpc17xx_spi.h"
+#include "lpc17xx_ssp.h"
+#include "lpc17xx_gpdma.h"
 
 
 #ifdef __cplusplus
@@ -48,16 +51,45 @@ typedef enum _sd_error
 	SD_ERROR_CMD0,
 	SD_ERROR_CMD55,
 	SD_ERROR_ACMD41,
-	SD_ERROR_CMD59
+	SD_ERROR_CMD59,
+	SD_ERROR_CMD8,
+	SD_ERROR_CMD16,
+	SD_ERROR_CMD58,
+	SD_ERROR_CRC,
+	SD_ERROR_WRITE
 }sd_error;
 
+/**
+ * @brief SD session statistics, latencies from the DWT cycle counter
+ */
+typedef struct
+{
+	uint32_t spi_clock;			/* Achieved SPI clock in Hz */
+	uint32_t card_clock;		/* Clock allowed by the card's CSD in Hz */
+	uint32_t blocks_read;
+	uint32_t blocks_written;
+	uint32_t read_cycles;		/* Per-block latency of the last read */
+	uint32_t read_max;			/* Worst per-block read latency */
+	uint32_t write_cycles;		/* Per-block latency of the last write */
+	uint32_t write_max;			/* Worst per-block write latency */
+}SD_STATS_Type;
+
+typedef enum _sd_card_type
+{
+	SD_CARD_UNKNOWN,
+	SD_CARD_V1,			/* SD v1.x, byte addressing */
+	SD_CARD_V2,			/* SD v2.0 standard capacity, byte addressing */
+	SD_CARD_HC			/* SDHC/SDXC, block addressing */
+}sd_card_type;
+
 //SD command code
 #define 	CMD0_GO_IDLE_STATE            0x00
 #define		CMD1_SEND_OPCOND              0x01
+#define 	CMD8_SEND_IF_COND             0x08
 #define 	CMD9_SEND_CSD                 0x09
 #define 	CMD10_SEND_CID                0x0a
-#define  	CMD12_STOP_TRANSMISSION       0x0b
-#define 	CMD13_SEND_STATUS             0x0c
+#define  	CMD12_STOP_TRANSMISSION       0x0c
+#define 	CMD13_SEND_STATUS             0x0d
 #define 	CMD16_SET_BLOCKLEN            0x10
 #define 	CMD17_READ_SINGLE_BLOCK       0x11
 #define 	CMD18_READ_MULTIPLE_BLOCK     0x12
@@ -105,6 +137,33 @@ typedef enum _sd_error
 #define SD_DATA_BLOCK_LENGTH	515
 #define SD_WAIT_R1_TIMEOUT		100000
 
+/* Data block handling */
+#define SD_BLOCK_SIZE			512
+#define SD_TOKEN_START_BLOCK	0xFE	/* CMD17/18/24 data token */
+#define SD_TOKEN_START_MULTI	0xFC	/* CMD25 data token */
+#define SD_TOKEN_STOP_TRAN		0xFD	/* CMD25 stop token */
+#define SD_DATA_RESP_MASK		0x1F
+#define SD_DATA_RESP_ACCEPTED	0x05
+#define SD_WAIT_TOKEN_TIMEOUT	100000	/* bytes, > 100ms read access time */
+#define SD_WAIT_BUSY_TIMEOUT	500000	/* bytes, > 250ms write busy time */
+
+/* SPI clock: identification clock, then the CSD TRAN_SPEED up to this cap */
+#define SD_INIT_CLOCK			400000
+#define SD_MAX_CLOCK			25000000
+
+/* Bus selection: SPI by default, SSP0 (P0.15-P0.18, CS on P0.16) otherwise.
+ * On SSP0 the command/response framing runs through the 8 frame FIFO and
+ * data phases of SD_DMA_MIN bytes or more through GPDMA. The application
+ * configures the bus (SPI_Config(LPC_SPI) or SSP_Config(LPC_SSP0)) */
+#define SD_SSP_SEL				DISABLE
+
+#if SD_SSP_SEL
+	#define SD_SSP_MODE
+#endif
+
+#define SD_SSP					LPC_SSP0
+#define SD_DMA_MIN				64
+
 
 uint8_t sd_cmd_buf[SD_CMD_BLOCK_LENGTH];
 uint8_t sd_data_buf[SD_DATA_BLOCK_LENGTH];
@@ -128,6 +187,14 @@ sd_error SD_WaitR1 (uint8_t *buffer, uint32_t length, uint32_t timeout);
 sd_error SD_WaitDeviceIdle (uint32_t num_char);
 sd_error SD_Init (uint8_t retries);
 sd_error SD_GetCID (void);
+sd_error SD_GetCSD (uint8_t *csd);
+sd_card_type SD_GetCardType (void);
+sd_error SD_ReadBlocks (uint32_t sector, uint8_t *buf, uint32_t count);
+sd_error SD_WriteBlocks (uint32_t sector, uint8_t *buf, uint32_t count);
+sd_error SD_ReadBlocksV (uint32_t sector, uint8_t * const *bufs, uint32_t count);
+sd_error SD_WriteBlocksV (uint32_t sector, uint8_t * const *bufs, uint32_t count);
+void SD_GetStats (SD_STATS_Type *stats);
+void SD_ResetStats (void);
 void SD_ErrorMsg (sd_error sd_status);
 
 
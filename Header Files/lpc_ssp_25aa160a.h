@@ -31,12 +31,21 @@ extern "C"
  * @{
  */
 
-#define EEP_WRITE  0x02;  /* Write bit of IR     */
-#define EEP_READ   0x03;  /* Read bit of IR      */
-#define EEP_WREN   0x06;  /* Write Enable Latch  */
-#define EEP_WRDI   0x04;  /* Write Disable Latch */
-#define EEP_RDSR   0x05;  /* Read Status Reg     */
-#define EEP_WRSR   0x01;  /* Write Status Reg    */
+#define EEP_WRITE  0x02   /* Write bit of IR     */
+#define EEP_READ   0x03   /* Read bit of IR      */
+#define EEP_WREN   0x06   /* Write Enable Latch  */
+#define EEP_WRDI   0x04   /* Write Disable Latch */
+#define EEP_RDSR   0x05   /* Read Status Reg     */
+#define EEP_WRSR   0x01   /* Write Status Reg    */
+
+#define EEP_SR_WIP     0x01    /* Write In Progress bit of status reg   */
+
+#define EEP_SIZE       0x800   /* 25AA160A capacity, 2 KB               */
+#define EEP_PAGE_SIZE  16      /* Write page, a write wraps inside it   */
+#define EEP_WIP_POLL   10000   /* Status reads before a write cycle is
+                                  given up (tWC is 5 ms max)            */
+#define EEP_SSP_BURST  8       /* Read frames per SSP_ReadWrite, the
+                                  FIFO depth so RX never overruns       */
 
 /**
  * @}
@@ -48,16 +57,16 @@ extern "C"
  * @{
  */
 
-void print_status_reg(void);
-void Read_Eeprom_Status (LPC_SSP_TypeDef *SSPx);
+void Ssp_Print_Status_Reg(void);
+void Ssp_Read_Eeprom_Status (LPC_SSP_TypeDef *SSPx);
 uint8_t Ssp_Eeprom_Read_Status_Reg (LPC_SSP_TypeDef *SSPx);
 uchar Ssp_Eeprom_Write_Status_Reg (LPC_SSP_TypeDef *SSPx, uint8_t status_reg);
 uchar Ssp_Eeprom_Write_Byte (LPC_SSP_TypeDef *SSPx, uint16 eep_address, uint8_t byte_data);
-uchar Ssp_Eeprom_Write (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *data_start, uint8_t length);
+uchar Ssp_Eeprom_Write (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *data_start, uint16_t length);
 uint8_t Ssp_Eeprom_Read_Byte (LPC_SSP_TypeDef *SSPx, uint16 eep_address);
-uchar Ssp_Eeprom_Read (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *dest_addr, uint8_t length);
-void Display_Eeprom_Array (uint8_t *string, uint8_t length);
-void Display_Eeprom_Loc (LPC_SSP_TypeDef *SSPx, uint16 mem_start_address, uint16 mem_end_address);
+uchar Ssp_Eeprom_Read (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *dest_addr, uint16_t length);
+void Ssp_Display_Eeprom_Array (uint8_t *string, uint8_t length);
+void Ssp_Display_Eeprom_Loc (LPC_SSP_TypeDef *SSPx, uint16 mem_start_address, uint16 mem_end_address);
 
 /**
  * @}
@@ -71,6 +71,58 @@ extern "C"
 #define BPP         16                  /* Bits per pixel                     */
 #define BYPP        ((BPP+7)/8)         /* Bytes per pixel                    */
 
+/*---------------------- Pixel stream definitions ----------------------------*/
+
+#define GLCD_DMA_SEL    DISABLE         /* Stream pixel runs through GPDMA    */
+
+#if GLCD_DMA_SEL
+	#define GLCD_DMA_MODE
+#endif
+
+#define GLCD_FILL_BUF   WIDTH           /* Pixels per DMA fill burst          */
+
+/*---------------------- Framebuffer definitions -----------------------------*/
+
+#define GLCD_FB_SEL     DISABLE         /* Buffer drawing in RAM, GLCD_Flush() */
+
+#if GLCD_FB_SEL
+	#define GLCD_FB_MODE
+#endif
+
+/* A full 320x240x16bpp frame does not fit the LPC1768 SRAM, the buffer holds
+ * a viewport chosen with GLCD_FB_Enable() and lives in a free AHB SRAM bank */
+#define GLCD_FB_BASE        LPC_AHBRAM0_BASE    /* Framebuffer address    */
+#define GLCD_FB_SIZE        0x4000              /* Framebuffer bytes      */
+#define GLCD_FB_PIXELS      (GLCD_FB_SIZE/BYPP) /* Max viewport pixels    */
+#define GLCD_FB_DIRTY_MAX   8                   /* Tracked dirty regions  */
+#define GLCD_FB_MERGE_SLACK 64                  /* Clean pixels accepted to
+                                                   merge two dirty regions */
+
+/*---------------------- Rasterizer definitions ------------------------------*/
+
+/* A pixel costs 3 commands, a window fill 7 commands plus the burst, so runs
+ * shorter than this are cheaper as single pixels */
+#define GLCD_SPAN_MIN   3               /* Shortest span drawn as a window    */
+
+#define GLCD_COST_SEL   DISABLE         /* Count SSP traffic, GLCD_Cost_Get() */
+
+#if GLCD_COST_SEL
+	#define GLCD_COST_MODE
+#endif
+
+/*---------------------- Text rendering definitions --------------------------*/
+
+#define GLCD_TEXT_OPAQUE_SEL  DISABLE   /* GLCD_Text/gprintf cells on BackColor */
+
+#if GLCD_TEXT_OPAQUE_SEL
+	#define GLCD_TEXT_OPAQUE
+#endif
+
+/* Opaque cells are expanded to pixels once and sent as one window burst, the
+ * last few are kept in an LRU cache. Larger cells are expanded row by row */
+#define GLCD_GLYPH_CACHE_NUM     4              /* Cached glyph cells     */
+#define GLCD_GLYPH_CACHE_PIXELS  ((5*2+1)*7*2)  /* Cell of 5x7 at size 2  */
+
 /**
  * @brief GLCD Driver Output Type definitions
  */
@@ -108,6 +160,14 @@ typedef struct
 	uint16_t fill_color;
 }COLORCFG_Type;
 
+/* SSP traffic counters */
+typedef struct
+{
+	uint32_t commands;      /* Command writes (RS low)        */
+	uint32_t bytes;         /* Bytes clocked out on SSP1      */
+	uint32_t windows;       /* GRAM windows set               */
+}GLCD_COST_Type;
+
 /**
  * @}
  */
@@ -153,6 +213,16 @@ void GLCD_LBar(int16_t index, uint8_t width, int16_t y, int16_t per, Bool dec,ui
 void Show_BarGraph(void);
 void Show_BarGraph_VI(void);
 
+void GLCD_Stream_Start (void);
+void GLCD_Stream_Pixels (const uint16_t *pixels, uint32_t count);
+void GLCD_Stream_Fill (uint16_t color, uint32_t count);
+void GLCD_Stream_Stop (void);
+Status GLCD_FB_Enable (uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+void GLCD_FB_Disable (void);
+void GLCD_Flush (void);
+void GLCD_Cost_Reset (void);
+void GLCD_Cost_Get (GLCD_COST_Type *cost);
+
 uchar Write_Command_Glcd (uint8_t Command);
 uchar Write_Data_Glcd (uint16_t data);
 
@@ -27,12 +27,28 @@
 #include "lpc17xx_gpio.h"
 #include "lpc17xx_wdt.h"
 #include "lpc17xx_uart.h"
+#include "lpc17xx_gpdma.h"
 #include "lpc17xx_ssp.h"
 #include "lpc17xx_i2c.h"
 #include "lpc_i2c_tsc2004.h"
 #include "lpc_ssp_glcd.h"
 
 
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup SYSTEM_INIT_Public_Macros SYSTEM_INIT Public Macros
+ * @{
+ */
+
+/* DWT cycle counter (not described by this CMSIS core header), shared by
+ * the timing and statistics code of the drivers, see DWT_CycleInit() */
+#define DWT_CTRL               (*(__IO uint32_t *)0xE0001000UL)
+#define DWT_CYCCNT             (*(__IO uint32_t *)0xE0001004UL)
+#define DWT_CTRL_CYCCNTENA     ((uint32_t)(1<<0))
+
+/**
+ * @}
+ */
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -70,6 +86,7 @@ extern uchar status;
 
 void System_Init(void);
 void Port_Init(void);
+void DWT_CycleInit(void);
 
 /**
  * @}
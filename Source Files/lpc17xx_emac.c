@@ -13,6 +13,7 @@
 
 /* Includes ------------------------------------------------------------------- */
 #include "lpc17xx_emac.h"
+#include "string.h"
 
 /* If this source file built with example, the LPC17xx FW library configuration
  * file in each example directory ("lpc17xx_libcfg.h") must be included,
@@ -50,41 +51,62 @@
 static unsigned short *rptr;
 static unsigned short *tptr;
 
-/*
- * NXP: Here AHBRAM1 section still not be used, so a mount of this section
- * will be used to store buffer data get from receive packet buffer of EMAC
- */
-static unsigned short *pgBuf = (unsigned short *)LPC_AHBRAM1_BASE;
-
+/** Frame being read through the webserver functions */
+static EMAC_RXFRAME_Type rx_frame;
+static unsigned short *rend;		// End of the fragment rptr is in
+static uint32_t rx_frag;			// Fragment rptr is in
 
 /* MII Mgmt Configuration register - Clock divider setting */
 const uint8_t EMAC_clkdiv[] = { 4, 6, 8, 10, 14, 20, 28 };
 
-/* EMAC local DMA Descriptors */
+/* EMAC local DMA Descriptors, in AHB SRAM at EMAC_RAM_BASE */
 
 /** Rx Descriptor data array */
-static RX_Desc Rx_Desc[EMAC_NUM_RX_FRAG];
-
+static RX_Desc * const Rx_Desc = (RX_Desc *)EMAC_RX_DESC_BASE;
 /** Rx Status data array - Must be 8-Byte aligned */
-#if defined ( __CC_ARM   )
-static __align(8) RX_Stat Rx_Stat[EMAC_NUM_RX_FRAG];
-#elif defined ( __ICCARM__ )
-#pragma data_alignment=8
-static RX_Stat Rx_Stat[EMAC_NUM_RX_FRAG];
-#elif defined   (  __GNUC__  )
-static __attribute__ ((aligned (8))) RX_Stat Rx_Stat[EMAC_NUM_RX_FRAG];
-#endif
-
+static RX_Stat * const Rx_Stat = (RX_Stat *)EMAC_RX_STAT_BASE;
 /** Tx Descriptor data array */
-static TX_Desc Tx_Desc[EMAC_NUM_TX_FRAG];
+static TX_Desc * const Tx_Desc = (TX_Desc *)EMAC_TX_DESC_BASE;
 /** Tx Status data array */
-static TX_Stat Tx_Stat[EMAC_NUM_TX_FRAG];
+static TX_Stat * const Tx_Stat = (TX_Stat *)EMAC_TX_STAT_BASE;
 
 /* EMAC local DMA buffers */
-/** Rx buffer data */
-static uint32_t rx_buf[EMAC_NUM_RX_FRAG][EMAC_ETH_MAX_FLEN>>2];
+/** Rx buffer pool: EMAC_NUM_RX_FRAG sit on the descriptors, the others are
+ * free or loaned to the application with a received frame */
+static uint32_t (* const rx_buf)[EMAC_RX_BUF_SIZE>>2] =
+		(uint32_t (*)[EMAC_RX_BUF_SIZE>>2])EMAC_RX_BUF_BASE;
 /** Tx buffer data */
-static uint32_t tx_buf[EMAC_NUM_TX_FRAG][EMAC_ETH_MAX_FLEN>>2];
+static uint32_t (* const tx_buf)[EMAC_TX_BUF_SIZE>>2] =
+		(uint32_t (*)[EMAC_TX_BUF_SIZE>>2])EMAC_TX_BUF_BASE;
+
+/* Both queues have a single producer and a single consumer, the interrupt
+ * on one side and the application on the other, so the free running
+ * counters need no locking. Off the ring there are always EMAC_NUM_RX_LOAN
+ * buffers, free, queued or loaned, and a frame holds one at least */
+/** Free Rx buffers: pushed by EMAC_RxRelease(), popped by the interrupt */
+static uint32_t *rx_free[EMAC_NUM_RX_LOAN];
+static volatile uint32_t rx_free_in, rx_free_out;
+/** Received frames: pushed by the interrupt, popped by EMAC_RxGet() */
+static EMAC_RXFRAME_Type rx_ready[EMAC_NUM_RX_LOAN];
+static volatile uint32_t rx_ready_in, rx_ready_out;
+/** A frame waits on the ring for a free buffer */
+static volatile uint8_t rx_stall;
+
+/** Next Tx descriptor to hand back, trails TxConsumeIndex */
+static uint32_t tx_reclaim;
+/** Completion of the frame ending on each Tx descriptor */
+static EMAC_TXDONE_CB_Type tx_done[EMAC_NUM_TX_FRAG];
+static void *tx_arg[EMAC_NUM_TX_FRAG];
+
+/** Statistics, bumped once per interrupt run for EMAC_GetStats() */
+static volatile EMAC_STATS_Type emac_stats;
+static volatile uint32_t emac_stats_seq;
+
+#ifdef EMAC_TRACE_MODE
+/** Interrupt events: pushed by the interrupt, popped by EMAC_TraceGet() */
+static EMAC_TRACE_Type emac_trace[EMAC_TRACE_SIZE];
+static volatile uint32_t emac_trace_in, emac_trace_out;
+#endif
 
 /**
  * @}
@@ -92,12 +114,15 @@ static uint32_t tx_buf[EMAC_NUM_TX_FRAG][EMAC_ETH_MAX_FLEN>>2];
 
 /* Private Functions ---------------------------------------------------------- */
 static void rx_descr_init (void);
+static uint32_t rx_harvest (void);
+#ifdef EMAC_TRACE_MODE
+static void emac_trace_put (uint32_t event, uint32_t arg);
+#endif
 static void tx_descr_init (void);
 static int32_t write_PHY (uint32_t PhyReg, uint16_t Value);
 static int32_t  read_PHY (uint32_t PhyReg);
 
 static void setEmacAddr(uint8_t abStationAddr[]);
-static int32_t emac_CRCCalc(uint8_t frame_no_fcs[], int32_t frame_len);
 
 
 /*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
@@ -108,11 +133,8 @@ static int32_t emac_CRCCalc(uint8_t frame_no_fcs[], int32_t frame_len);
  **********************************************************************/
 void ENET_IRQHandler (void)
 {
-	EMAC_PACKETBUF_Type RxDatbuf;
-	uint32_t RxLen;
-
 	/* EMAC Ethernet Controller Interrupt function. */
-	uint32_t int_stat;
+	uint32_t int_stat, frames;
 	// Get EMAC interrupt status
 	while ((int_stat = (LPC_EMAC->IntStatus & LPC_EMAC->IntEnable)) != 0) {
 		// Clear interrupt status
@@ -122,8 +144,10 @@ void ENET_IRQHandler (void)
 		/* ---------- receive overrun ------------*/
 		if((int_stat & EMAC_INT_RX_OVERRUN))
 		{
-			RXOverrunCount++;
-			printf(LPC_UART0,"Rx overrun\n\r");
+			emac_stats.rx_overrun++;
+#ifdef EMAC_TRACE_MODE
+			emac_trace_put(EMAC_INT_RX_OVERRUN, LPC_EMAC->RxProduceIndex);
+#endif
 		}
 
 		/*-----------  receive error -------------*/
@@ -138,77 +162,71 @@ void ENET_IRQHandler (void)
 		if ((int_stat & EMAC_INT_RX_ERR))
 		{
 			if (EMAC_CheckReceiveDataStatus(EMAC_RINFO_RANGE_ERR) == RESET){
-				RXErrorCount++;
-				printf(LPC_UART0,"Rx error: \n\r");
+				emac_stats.rx_error++;
+#ifdef EMAC_TRACE_MODE
+				emac_trace_put(EMAC_INT_RX_ERR, 0);
+#endif
 			}
 		}
 
 		/* ---------- RX Finished Process Descriptors ----------*/
 		if ((int_stat & EMAC_INT_RX_FIN))
 		{
-			RxFinishedCount++;
-			printf(LPC_UART0,"Rx finish\n\r");
+			emac_stats.rx_finished++;
+#ifdef EMAC_TRACE_MODE
+			emac_trace_put(EMAC_INT_RX_FIN, 0);
+#endif
 		}
 
 		/* ---------- Receive Done -----------------------------*/
-		/* Note: All packets are greater than (TX_PACKET_SIZE + 4)
-		 * will be ignore!
+		/* Also raised by EMAC_RxRelease() through IntSet once a buffer
+		 * is back for a frame left waiting on the ring
 		 */
 		if ((int_stat & EMAC_INT_RX_DONE))
 		{
-			/* Packet received, check if packet is valid. */
-			if (EMAC_CheckReceiveIndex()){
-				if (!EMAC_CheckReceiveDataStatus(EMAC_RINFO_LAST_FLAG)){
-					goto rel;
-				}
-				// Get data size, trip out 4-bytes CRC field, note that length in (-1) style format
-				RxLen = EMAC_GetReceiveDataSize() - 3;
-				// Note that packet added 4-bytes CRC created by yourself
-				if ((RxLen > (TX_PACKET_SIZE + 4)) || (EMAC_CheckReceiveDataStatus(EMAC_RINFO_ERR_MASK))) {
-					/* Invalid frame, ignore it and free buffer */
-					goto rel;
-				}
-				ReceiveLength = RxLen;
-				// Valid Frame, just copy it
-				RxDatbuf.pbDataBuf = (uint32_t *)gRxBuf;
-				RxDatbuf.ulDataLen = RxLen;
-				EMAC_ReadPacketBuffer(&RxDatbuf);
-				PacketReceived = TRUE;
-
-		rel:
-				/* Release frame from EMAC buffer */
-				EMAC_UpdateRxConsumeIndex();
-			}
-			printf(LPC_UART0,"Rx done\n\r");
-			RxDoneCount++;
+			frames = rx_harvest();
+			emac_stats.rx_done++;
+#ifdef EMAC_TRACE_MODE
+			emac_trace_put(EMAC_INT_RX_DONE, frames);
+#else
+			(void)frames;
+#endif
 		}
 
 		/*------------------- Transmit Underrun -----------------------*/
 		if ((int_stat & EMAC_INT_TX_UNDERRUN))
 		{
-			TXUnderrunCount++;
-			printf(LPC_UART0,"Tx under-run\n\r");
+			emac_stats.tx_underrun++;
+#ifdef EMAC_TRACE_MODE
+			emac_trace_put(EMAC_INT_TX_UNDERRUN, 0);
+#endif
 		}
 
 		/*------------------- Transmit Error --------------------------*/
 		if ((int_stat & EMAC_INT_TX_ERR))
 		{
-			TXErrorCount++;
-			printf(LPC_UART0,"Tx error\n\r");
+			emac_stats.tx_error++;
+#ifdef EMAC_TRACE_MODE
+			emac_trace_put(EMAC_INT_TX_ERR, 0);
+#endif
 		}
 
 		/* ----------------- TX Finished Process Descriptors ----------*/
 		if ((int_stat & EMAC_INT_TX_FIN))
 		{
-			TxFinishedCount++;
-			printf(LPC_UART0,"Tx finish\n\r");
+			emac_stats.tx_finished++;
+#ifdef EMAC_TRACE_MODE
+			emac_trace_put(EMAC_INT_TX_FIN, 0);
+#endif
 		}
 
 		/* ----------------- Transmit Done ----------------------------*/
 		if ((int_stat & EMAC_INT_TX_DONE))
 		{
-			TxDoneCount++;
-			printf(LPC_UART0,"Tx done\n\r");
+			emac_stats.tx_done++;
+#ifdef EMAC_TRACE_MODE
+			emac_trace_put(EMAC_INT_TX_DONE, LPC_EMAC->TxConsumeIndex);
+#endif
 		}
 #if ENABLE_WOL
 		/* ------------------ Wakeup Event Interrupt ------------------*/
@@ -217,10 +235,12 @@ void ENET_IRQHandler (void)
 		 */
 		if ((int_stat & EMAC_INT_WAKEUP))
 		{
-			WOLCount++;
+			emac_stats.wakeup++;
 		}
 #endif
 	}
+	// Counters settled, a copy in progress in EMAC_GetStats() is retried
+	emac_stats_seq++;
 }
 
 
@@ -262,7 +282,7 @@ void PacketGen(uint8_t *txptr)
 	}
 
 	// Calculate CRC
-	crcValue = crc32_bfr( txptr, TX_PACKET_SIZE );
+	crcValue = CRC32_Calc( txptr, TX_PACKET_SIZE );
 
 	// Add 4-byte CRC
 	*(txptr+TX_PACKET_SIZE) = (0xff & crcValue);
@@ -286,11 +306,23 @@ static void rx_descr_init (void)
 	for (i = 0; i < EMAC_NUM_RX_FRAG; i++)
 	{
 		Rx_Desc[i].Packet  = (uint32_t)&rx_buf[i];
-		Rx_Desc[i].Ctrl    = EMAC_RCTRL_INT | (EMAC_ETH_MAX_FLEN - 1);
+		Rx_Desc[i].Ctrl    = EMAC_RCTRL_INT | (EMAC_RX_BUF_SIZE - 1);
 		Rx_Stat[i].Info    = 0;
 		Rx_Stat[i].HashCRC = 0;
 	}
 
+	/* The remaining buffers start free, nothing is loaned */
+	for (i = 0; i < EMAC_NUM_RX_LOAN; i++)
+	{
+		rx_free[i] = rx_buf[EMAC_NUM_RX_FRAG + i];
+	}
+	rx_free_in   = EMAC_NUM_RX_LOAN;
+	rx_free_out  = 0;
+	rx_ready_in  = 0;
+	rx_ready_out = 0;
+	rx_stall     = 0;
+	rx_frame.pbData = NULL;
+
 	/* Set EMAC Receive Descriptor Registers. */
 	LPC_EMAC->RxDescriptor       = (uint32_t)&Rx_Desc[0];
 	LPC_EMAC->RxStatus           = (uint32_t)&Rx_Stat[0];
@@ -301,6 +333,124 @@ static void rx_descr_init (void)
 }
 
 
+/*--------------------------- rx_harvest -----------------------------------*/
+/*********************************************************************//**
+ * @brief 		Move every received frame from the ring to the ready queue.
+ * 				Its descriptors get free buffers in exchange, so the frame
+ * 				is never copied. Invalid frames keep their buffers and are
+ * 				dropped, a valid frame finding too few free buffers stays
+ * 				on the ring until EMAC_RxRelease()
+ * @param[in] 	None
+ * @return 		Number of frames queued
+ ***********************************************************************/
+static uint32_t rx_harvest (void)
+{
+	uint32_t idx, info, len, n, i;
+	uint32_t frames = 0;
+	EMAC_RXFRAME_Type *pFrame;
+
+	n = (LPC_EMAC->RxProduceIndex + EMAC_NUM_RX_FRAG - LPC_EMAC->RxConsumeIndex) % EMAC_NUM_RX_FRAG;
+	if (n > emac_stats.rx_ring_peak) {
+		emac_stats.rx_ring_peak = n;
+	}
+
+	while (LPC_EMAC->RxConsumeIndex != LPC_EMAC->RxProduceIndex)
+	{
+		/* Find the last fragment of the frame, sizes in (-1) style format */
+		idx = LPC_EMAC->RxConsumeIndex;
+		len = 0;
+		n = 0;
+		do {
+			info = Rx_Stat[idx].Info;
+			len += (info & EMAC_RINFO_SIZE) + 1;
+			n++;
+			if (++idx == EMAC_NUM_RX_FRAG) idx = 0;
+			if ((idx == LPC_EMAC->RxProduceIndex) && !(info & EMAC_RINFO_LAST_FLAG)) {
+				// Rest of the frame still being received
+				return frames;
+			}
+		} while (!(info & EMAC_RINFO_LAST_FLAG));
+
+		// The 4-byte FCS is counted in the last fragments
+		if (info & EMAC_RINFO_ERR_MASK)
+		{
+			emac_stats.rx_drop_error++;
+		}
+		else if (info & EMAC_RINFO_NO_DESCR)
+		{
+			emac_stats.rx_drop_nodescr++;
+		}
+		else if ((len <= 4) || (n > EMAC_RX_FRAG_MAX))
+		{
+			emac_stats.rx_drop_length++;
+		}
+		else
+		{
+			if ((rx_free_in - rx_free_out) < n)
+			{
+				emac_stats.rx_stall++;
+				rx_stall = 1;
+				return frames;
+			}
+			pFrame = &rx_ready[rx_ready_in % EMAC_NUM_RX_LOAN];
+			pFrame->ulDataLen = len - 4;
+			pFrame->ulInfo    = info;
+			pFrame->ulFrags   = n;
+			idx = LPC_EMAC->RxConsumeIndex;
+			for (i = 0; i < n; i++)
+			{
+				pFrame->pbFrag[i] = (uint8_t *)Rx_Desc[idx].Packet;
+				Rx_Desc[idx].Packet = (uint32_t)rx_free[rx_free_out % EMAC_NUM_RX_LOAN];
+				rx_free_out++;
+				if (++idx == EMAC_NUM_RX_FRAG) idx = 0;
+			}
+			pFrame->pbData = pFrame->pbFrag[0];
+			__DMB();
+			rx_ready_in++;
+
+			frames++;
+			emac_stats.rx_frames++;
+			emac_stats.rx_bytes += len - 4;
+			if ((rx_ready_in - rx_ready_out) > emac_stats.rx_ready_peak) {
+				emac_stats.rx_ready_peak = rx_ready_in - rx_ready_out;
+			}
+		}
+
+		/* Give the descriptors back to the EMAC */
+		LPC_EMAC->RxConsumeIndex = idx;
+	}
+	return frames;
+}
+
+
+#ifdef EMAC_TRACE_MODE
+/*--------------------------- emac_trace_put -------------------------------*/
+/*********************************************************************//**
+ * @brief 		Record an interrupt event, counted as lost when the ring
+ * 				is full
+ * @param[in] 	event: EMAC_INT_ bit
+ * @param[in] 	arg: event detail
+ * @return 		None
+ ***********************************************************************/
+static void emac_trace_put (uint32_t event, uint32_t arg)
+{
+	EMAC_TRACE_Type *pEvent;
+
+	if ((emac_trace_in - emac_trace_out) >= EMAC_TRACE_SIZE)
+	{
+		emac_stats.trace_lost++;
+		return;
+	}
+	pEvent = &emac_trace[emac_trace_in % EMAC_TRACE_SIZE];
+	pEvent->cycles = DWT_CYCCNT;
+	pEvent->event  = event;
+	pEvent->arg    = arg;
+	__DMB();
+	emac_trace_in++;
+}
+#endif
+
+
 /*--------------------------- tx_descr_init ---- ----------------------------*/
 /*********************************************************************//**
  * @brief 		Initializes TX Descriptor
@@ -316,7 +466,9 @@ static void tx_descr_init (void) {
 		Tx_Desc[i].Packet = (uint32_t)&tx_buf[i];
 		Tx_Desc[i].Ctrl   = 0;
 		Tx_Stat[i].Info   = 0;
+		tx_done[i]        = NULL;
 	}
+	tx_reclaim = 0;
 
 	/* Set EMAC Transmit Descriptor Registers. */
 	LPC_EMAC->TxDescriptor       = (uint32_t)&Tx_Desc[0];
@@ -398,49 +550,6 @@ static void setEmacAddr(uint8_t abStationAddr[])
 }
 
 
-/*********************************************************************//**
- * @brief		Calculates CRC code for number of bytes in the frame
- * @param[in]	frame_no_fcs	Pointer to the first byte of the frame
- * @param[in]	frame_len		length of the frame without the FCS
- * @return		the CRC as a 32 bit integer
- **********************************************************************/
-static int32_t emac_CRCCalc(uint8_t frame_no_fcs[], int32_t frame_len)
-{
-	int i; 		// iterator
-	int j; 		// another iterator
-	char byte; 	// current byte
-	int crc; 	// CRC result
-	int q0, q1, q2, q3; // temporary variables
-	crc = 0xFFFFFFFF;
-	for (i = 0; i < frame_len; i++) {
-		byte = *frame_no_fcs++;
-		for (j = 0; j < 2; j++) {
-			if (((crc >> 28) ^ (byte >> 3)) & 0x00000001) {
-				q3 = 0x04C11DB7;
-			} else {
-				q3 = 0x00000000;
-			}
-			if (((crc >> 29) ^ (byte >> 2)) & 0x00000001) {
-				q2 = 0x09823B6E;
-			} else {
-				q2 = 0x00000000;
-			}
-			if (((crc >> 30) ^ (byte >> 1)) & 0x00000001) {
-				q1 = 0x130476DC;
-			} else {
-				q1 = 0x00000000;
-			}
-			if (((crc >> 31) ^ (byte >> 0)) & 0x00000001) {
-				q0 = 0x2608EDB8;
-			} else {
-				q0 = 0x00000000;
-			}
-			crc = (crc << 4) ^ q3 ^ q2 ^ q1 ^ q0;
-			byte >>= 4;
-		}
-	}
-	return crc;
-}
 /* End of Private Functions --------------------------------------------------- */
 
 
@@ -632,6 +741,12 @@ Status EMAC_Init(EMAC_CFG_Type *EMAC_ConfigStruct)
 	rx_descr_init ();
 	tx_descr_init ();
 
+#ifdef EMAC_TRACE_MODE
+	// Start the DWT cycle counter used to time the events
+	DWT_CycleInit();
+	emac_trace_out = emac_trace_in;
+#endif
+
 	// Set Receive Filter register: enable broadcast and multicast
 	LPC_EMAC->RxFilterCtrl = EMAC_RFC_MCAST_EN | EMAC_RFC_BCAST_EN | EMAC_RFC_PERFECT_EN;
 
@@ -925,10 +1040,11 @@ void EMAC_SetHashFilter(uint8_t dstMAC_addr[], FunctionalState NewState)
 {
 	uint32_t *pReg;
 	uint32_t tmp;
-	int32_t crc;
+	uint32_t crc;
 
-	// Calculate the CRC from the destination MAC address
-	crc = emac_CRCCalc(dstMAC_addr, 6);
+	// Calculate the CRC from the destination MAC address, the hash takes
+	// its bits in transmit order, the reverse of the reflected register
+	crc = __RBIT(CRC32_Update(CRC32_INIT, dstMAC_addr, 6));
 	// Extract the value from CRC to get index value for hash filter table
 	crc = (crc >> 23) & 0x3F;
 
@@ -1021,39 +1137,271 @@ void EMAC_WritePacketBuffer(EMAC_PACKETBUF_Type *pDataStruct)
 	uint32_t idx,len;
 	uint32_t *sp,*dp;
 
+	// Report earlier EMAC_TxSendV() frames before a descriptor is reused
+	EMAC_TxReclaim();
+
 	idx = LPC_EMAC->TxProduceIndex;
 	sp  = (uint32_t *)pDataStruct->pbDataBuf;
-	dp  = (uint32_t *)Tx_Desc[idx].Packet;
+	dp  = tx_buf[idx];
+	// The descriptor may still point at a fragment of EMAC_TxSendV()
+	Tx_Desc[idx].Packet = (uint32_t)dp;
+	tx_done[idx] = NULL;
 	/* Copy frame data to EMAC packet buffers. */
 	for (len = (pDataStruct->ulDataLen + 3) >> 2; len; len--) {
 		*dp++ = *sp++;
 	}
 	Tx_Desc[idx].Ctrl = (pDataStruct->ulDataLen - 1) | (EMAC_TCTRL_INT | EMAC_TCTRL_LAST);
+
+	emac_stats.tx_frames++;
+	emac_stats.tx_bytes += pDataStruct->ulDataLen;
 }
 
 /*********************************************************************//**
- * @brief		Read data from Rx packet data buffer at current index due
- * 				to RxConsumeIndex
- * @param[in]	pDataStruct		Pointer to a EMAC_PACKETBUF_Type structure
- * 							data that contain specified information about
- * 							Packet data buffer.
+ * @brief		Take the oldest received frame without copying it. The data
+ * 				stays valid until the frame is given to EMAC_RxRelease();
+ * 				frames may be released in any order
+ * @param[out]	pFrame	Pointer to a EMAC_RXFRAME_Type structure filled
+ * 						with the frame
+ * @return		SUCCESS, ERROR if no frame has been received
+ **********************************************************************/
+Status EMAC_RxGet(EMAC_RXFRAME_Type *pFrame)
+{
+	if (rx_ready_out == rx_ready_in) {
+		return ERROR;
+	}
+	*pFrame = rx_ready[rx_ready_out % EMAC_NUM_RX_LOAN];
+	rx_ready_out++;
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Give the buffers of a frame from EMAC_RxGet() back to the
+ * 				pool. A frame left waiting on the ring for a buffer is
+ * 				taken at once by raising the Receive Done interrupt
+ * @param[in]	pFrame	Pointer to the frame, cleared so that a second
+ * 						release does nothing
  * @return		None
  **********************************************************************/
-void EMAC_ReadPacketBuffer(EMAC_PACKETBUF_Type *pDataStruct)
+void EMAC_RxRelease(EMAC_RXFRAME_Type *pFrame)
 {
-	uint32_t idx, len;
-	uint32_t *dp, *sp;
+	uint32_t i;
 
-	idx = LPC_EMAC->RxConsumeIndex;
-	dp = (uint32_t *)pDataStruct->pbDataBuf;
-	sp = (uint32_t *)Rx_Desc[idx].Packet;
+	if (pFrame->pbData == NULL) {
+		return;
+	}
+	for (i = 0; i < pFrame->ulFrags; i++) {
+		rx_free[(rx_free_in + i) % EMAC_NUM_RX_LOAN] = (uint32_t *)pFrame->pbFrag[i];
+	}
+	pFrame->pbData = NULL;
+	__DMB();
+	rx_free_in += pFrame->ulFrags;
+
+	if (rx_stall) {
+		rx_stall = 0;
+		LPC_EMAC->IntSet = EMAC_INT_RX_DONE;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Check the FCS of a frame from EMAC_RxGet() in software. The
+ * 				EMAC checks it already, this is for frames passed with
+ * 				EMAC_CR_PASS_RUNT_FRM or kept for later forwarding
+ * @param[in]	pFrame	Pointer to the frame, its FCS follows the data
+ * @return		SUCCESS if the FCS matches, otherwise ERROR
+ **********************************************************************/
+Status EMAC_RxCheckFCS(EMAC_RXFRAME_Type *pFrame)
+{
+	uint32_t crc = CRC32_INIT;
+	uint32_t left = pFrame->ulDataLen + 4;
+	uint32_t i, n;
+
+	for (i = 0; (i < pFrame->ulFrags) && left; i++) {
+		n = MIN(left, EMAC_RX_BUF_SIZE);
+		crc = CRC32_Update(crc, pFrame->pbFrag[i], n);
+		left -= n;
+	}
+	return ((crc == CRC32_RESIDUE) ? SUCCESS : ERROR);
+}
 
-	if (pDataStruct->pbDataBuf != NULL) {
-		for (len = (pDataStruct->ulDataLen + 3) >> 2; len; len--) {
-			*dp++ = *sp++;
+/*********************************************************************//**
+ * @brief		Number of received frames waiting for EMAC_RxGet()
+ * @param[in]	None
+ * @return		Frame count
+ **********************************************************************/
+uint32_t EMAC_RxPending(void)
+{
+	return (rx_ready_in - rx_ready_out);
+}
+
+/*********************************************************************//**
+ * @brief		Queue one frame made of several fragments without copying
+ * 				them: each fragment takes the next Tx descriptor, only the
+ * 				last one is marked EMAC_TCTRL_LAST, and TxProduceIndex moves
+ * 				once the whole frame is in place
+ * @param[in]	pIov	Fragments in frame order, destination address first.
+ * 						They must be in RAM and left untouched until the
+ * 						frame completes
+ * @param[in]	ulCount	Number of fragments, at most EMAC_NUM_TX_FRAG - 1
+ * @param[in]	done	Called by EMAC_TxReclaim() once the frame is sent,
+ * 						may be NULL
+ * @param[in]	pArg	Passed to done
+ * @return		SUCCESS, ERROR if a length is invalid or the ring lacks
+ * 				free descriptors (nothing is queued then)
+ *
+ * Note: Not for use from interrupt, it runs EMAC_TxReclaim() first.
+ **********************************************************************/
+Status EMAC_TxSendV(const EMAC_IOVEC_Type *pIov, uint32_t ulCount,
+		EMAC_TXDONE_CB_Type done, void *pArg)
+{
+	uint32_t idx, i, room, total = 0;
+
+	EMAC_TxReclaim();
+
+	idx  = LPC_EMAC->TxProduceIndex;
+	room = (tx_reclaim + EMAC_NUM_TX_FRAG - idx - 1) % EMAC_NUM_TX_FRAG;
+	if ((ulCount == 0) || (ulCount > room)) {
+		return ERROR;
+	}
+	for (i = 0; i < ulCount; i++) {
+		if ((pIov[i].ulDataLen == 0) || (pIov[i].ulDataLen > (EMAC_TCTRL_SIZE + 1))) {
+			return ERROR;
+		}
+		total += pIov[i].ulDataLen;
+	}
+	if (total > EMAC_ETH_MAX_FLEN) {
+		return ERROR;
+	}
+
+	for (i = 0; i < ulCount; i++) {
+		Tx_Desc[idx].Packet = (uint32_t)pIov[i].pbData;
+		if (i == (ulCount - 1)) {
+			Tx_Desc[idx].Ctrl = (pIov[i].ulDataLen - 1) | (EMAC_TCTRL_INT | EMAC_TCTRL_LAST);
+			tx_done[idx] = done;
+			tx_arg[idx]  = pArg;
+		} else {
+			Tx_Desc[idx].Ctrl = (pIov[i].ulDataLen - 1);
+			tx_done[idx] = NULL;
+		}
+		if (++idx == EMAC_NUM_TX_FRAG) idx = 0;
+	}
+
+	/* Start frame transmission */
+	__DMB();
+	LPC_EMAC->TxProduceIndex = idx;
+
+	emac_stats.tx_frames++;
+	emac_stats.tx_bytes += total;
+	room = (idx + EMAC_NUM_TX_FRAG - tx_reclaim) % EMAC_NUM_TX_FRAG;
+	if (room > emac_stats.tx_ring_peak) {
+		emac_stats.tx_ring_peak = room;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Hand back the Tx descriptors the EMAC has finished with, up
+ * 				to TxConsumeIndex, and call the completion of every frame
+ * 				ending on them
+ * @param[in]	None
+ * @return		Number of frames completed
+ *
+ * Note: Not for use from interrupt, completions run in the caller.
+ **********************************************************************/
+uint32_t EMAC_TxReclaim(void)
+{
+	uint32_t idx = tx_reclaim;
+	uint32_t consume = LPC_EMAC->TxConsumeIndex;
+	uint32_t frames = 0;
+	EMAC_TXDONE_CB_Type cb;
+
+	while (idx != consume) {
+		if (Tx_Desc[idx].Ctrl & EMAC_TCTRL_LAST) {
+			frames++;
+		}
+		cb = tx_done[idx];
+		if (cb != NULL) {
+			tx_done[idx] = NULL;
+			cb(tx_arg[idx], Tx_Stat[idx].Info);
+		}
+		if (++idx == EMAC_NUM_TX_FRAG) idx = 0;
+	}
+	tx_reclaim = idx;
+	return frames;
+}
+
+/*********************************************************************//**
+ * @brief		Take a consistent copy of the statistics without masking the
+ * 				interrupt: the copy is redone if the interrupt ran meanwhile
+ * @param[out]	pStats	Filled with the counters
+ * @return		None
+ **********************************************************************/
+void EMAC_GetStats(EMAC_STATS_Type *pStats)
+{
+	uint32_t seq;
+
+	do {
+		seq = emac_stats_seq;
+		*pStats = emac_stats;
+	} while (seq != emac_stats_seq);
+}
+
+/*********************************************************************//**
+ * @brief		Clear the statistics, peaks included
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+void EMAC_ResetStats(void)
+{
+	NVIC_DisableIRQ(ENET_IRQn);
+	memset((void *)&emac_stats, 0, sizeof(emac_stats));
+	NVIC_EnableIRQ(ENET_IRQn);
+}
+
+#ifdef EMAC_TRACE_MODE
+/*********************************************************************//**
+ * @brief		Take the oldest traced interrupt event
+ * @param[out]	pEvent	Filled with the event
+ * @return		SUCCESS, ERROR if the trace is empty
+ **********************************************************************/
+Status EMAC_TraceGet(EMAC_TRACE_Type *pEvent)
+{
+	if (emac_trace_out == emac_trace_in) {
+		return ERROR;
+	}
+	*pEvent = emac_trace[emac_trace_out % EMAC_TRACE_SIZE];
+	emac_trace_out++;
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Drain the trace to a UART, one line per event. For the main
+ * 				loop, never the interrupt
+ * @param[in]	UARTx	UART peripheral to print on
+ * @return		None
+ **********************************************************************/
+void EMAC_TraceDump(LPC_UART_TypeDef *UARTx)
+{
+	EMAC_TRACE_Type evt;
+	const char *name;
+
+	while (EMAC_TraceGet(&evt) == SUCCESS)
+	{
+		switch (evt.event)
+		{
+		case EMAC_INT_RX_OVERRUN:	name = "Rx overrun";	break;
+		case EMAC_INT_RX_ERR:		name = "Rx error";		break;
+		case EMAC_INT_RX_FIN:		name = "Rx finish";		break;
+		case EMAC_INT_RX_DONE:		name = "Rx done";		break;
+		case EMAC_INT_TX_UNDERRUN:	name = "Tx under-run";	break;
+		case EMAC_INT_TX_ERR:		name = "Tx error";		break;
+		case EMAC_INT_TX_FIN:		name = "Tx finish";		break;
+		case EMAC_INT_TX_DONE:		name = "Tx done";		break;
+		default:					name = "?";				break;
 		}
+		printf(UARTx, "%10lu %s %lu\n\r", evt.cycles, name, (uint32_t)evt.arg);
 	}
 }
+#endif
 
 /*********************************************************************//**
  * @brief 		Enable/Disable interrupt for each type in EMAC
@@ -1110,26 +1458,6 @@ IntStatus EMAC_IntGetStatus(uint32_t ulIntType)
 }
 
 
-/*********************************************************************//**
- * @brief		Check whether if the current RxConsumeIndex is not equal to the
- * 				current RxProduceIndex.
- * @param[in]	None
- * @return		TRUE if they're not equal, otherwise return FALSE
- *
- * Note: In case the RxConsumeIndex is not equal to the RxProduceIndex,
- * it means there're available data has been received. They should be read
- * out and released the Receive Data Buffer by updating the RxConsumeIndex value.
- **********************************************************************/
-Bool EMAC_CheckReceiveIndex(void)
-{
-	if (LPC_EMAC->RxConsumeIndex != LPC_EMAC->RxProduceIndex) {
-		return TRUE;
-	} else {
-		return FALSE;
-	}
-}
-
-
 /*********************************************************************//**
  * @brief		Check whether if the current TxProduceIndex is not equal to the
  * 				current RxProduceIndex - 1.
@@ -1178,36 +1506,6 @@ FlagStatus EMAC_CheckReceiveDataStatus(uint32_t ulRxStatType)
 }
 
 
-/*********************************************************************//**
- * @brief		Get size of current Received data in received buffer (due to
- * 				RxConsumeIndex)
- * @param[in]	None
- * @return		Size of received data
- **********************************************************************/
-uint32_t EMAC_GetReceiveDataSize(void)
-{
-	uint32_t idx;
-	idx =LPC_EMAC->RxConsumeIndex;
-	return ((Rx_Stat[idx].Info) & EMAC_RINFO_SIZE);
-}
-
-/*********************************************************************//**
- * @brief		Increase the RxConsumeIndex (after reading the Receive buffer
- * 				to release the Receive buffer) and wrap-around the index if
- * 				it reaches the maximum Receive Number
- * @param[in]	None
- * @return		None
- **********************************************************************/
-void EMAC_UpdateRxConsumeIndex(void)
-{
-	// Get current Rx consume index
-	uint32_t idx = LPC_EMAC->RxConsumeIndex;
-
-	/* Release frame from EMAC buffer */
-	if (++idx == EMAC_NUM_RX_FRAG) idx = 0;
-	LPC_EMAC->RxConsumeIndex = idx;
-}
-
 /*********************************************************************//**
  * @brief		Increase the TxProduceIndex (after writting to the Transmit buffer
  * 				to enable the Transmit buffer) and wrap-around the index if
@@ -1233,6 +1531,12 @@ void EMAC_UpdateTxProduceIndex(void)
 
 unsigned short ReadFrame_EMAC(void)
 {
+  // Step to the next buffer of a chained frame, a word never straddles two
+  if ((rptr == rend) && (rx_frag + 1 < rx_frame.ulFrags)) {
+    rx_frag++;
+    rptr = (unsigned short *)rx_frame.pbFrag[rx_frag];
+    rend = rptr + (EMAC_RX_BUF_SIZE >> 1);
+  }
   return (*rptr++);
 }
 
@@ -1242,10 +1546,8 @@ unsigned short ReadFrame_EMAC(void)
 
 unsigned short ReadFrameBE_EMAC(void)
 {
-  unsigned short ReturnValue;
-
-  ReturnValue = SwapBytes (*rptr++);
-  return (ReturnValue);
+  // Same fragment stepping as ReadFrame_EMAC()
+  return (SwapBytes (ReadFrame_EMAC()));
 }
 
 
@@ -1280,33 +1582,29 @@ void DummyReadFrame_EMAC(unsigned short Size)    // discards an EVEN number of b
   }
 }
 
-// Reads the length of the received ethernet frame and checks if the
-// destination address is a broadcast message or not
-// returns the frame length
+// Takes the next received frame and returns its length, the frame is
+// read in place from its DMA buffer
 unsigned short StartReadFrame(void) {
-	unsigned short RxLen;
-	EMAC_PACKETBUF_Type RxPack;
-
-	RxLen = EMAC_GetReceiveDataSize() - 3;
-	// Copy packet to data buffer
-	RxPack.pbDataBuf = (uint32_t *)pgBuf;
-	RxPack.ulDataLen = RxLen;
-	EMAC_ReadPacketBuffer(&RxPack);
-	// Point to the data buffer
-	rptr = (unsigned short *)pgBuf;
-	return(RxLen);
+	// A frame not ended with EndReadFrame() goes back to the pool
+	EMAC_RxRelease(&rx_frame);
+	if (EMAC_RxGet(&rx_frame) == ERROR){
+		return (0);
+	}
+	// Point to the frame data
+	rptr = (unsigned short *)rx_frame.pbData;
+	rend = rptr + (EMAC_RX_BUF_SIZE >> 1);
+	rx_frag = 0;
+	return(rx_frame.ulDataLen);
 }
 
 // Release the buffer after reading all the content inside
 void EndReadFrame(void) {
-	// just call EMAC_UpdateConsumeIndex() in EMAC driver
-	EMAC_UpdateRxConsumeIndex();
+	EMAC_RxRelease(&rx_frame);
 }
 
 // Check whether if there is a receive packet coming
 unsigned int CheckFrameReceived(void) {             // Packet received ?
-	// Just call EMAC_CheckReceiveIndex() in EMAC driver
-	if (EMAC_CheckReceiveIndex() == TRUE){
+	if (EMAC_RxPending()){
 		return (1);
 	} else {
 		return (0);
@@ -0,0 +1,653 @@
+/******************************************************************//**
+* @file		lpc17xx_gpdma.c
+* @brief	Contains all functions support for GPDMA firmware library on LPC17xx
+* @version	1.0
+* @date		17. Oct. 2026
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup GPDMA
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc_system_init.h"
+#include "lpc17xx_gpdma.h"
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+
+/* Private Variables ---------------------------------------------------------- */
+/** @defgroup GPDMA_Private_Variables GPDMA Private Variables
+ * @{
+ */
+
+/**
+ * @brief Lookup Table of Connection Type matched with
+ * Peripheral Data (FIFO) register base address
+ */
+static volatile const void *GPDMA_LUTPerAddr[] = {
+		(&LPC_SSP0->DR),				// SSP0 Tx
+		(&LPC_SSP0->DR),				// SSP0 Rx
+		(&LPC_SSP1->DR),				// SSP1 Tx
+		(&LPC_SSP1->DR),				// SSP1 Rx
+		(&LPC_ADC->ADGDR),				// ADC
+		(&LPC_I2S->I2STXFIFO), 			// I2S Tx
+		(&LPC_I2S->I2SRXFIFO), 			// I2S Rx
+		(&LPC_DAC->DACR),				// DAC
+		(&LPC_UART0->/*RBTHDLR.*/THR),	// UART0 Tx
+		(&LPC_UART0->/*RBTHDLR.*/RBR),	// UART0 Rx
+		(&LPC_UART1->/*RBTHDLR.*/THR),	// UART1 Tx
+		(&LPC_UART1->/*RBTHDLR.*/RBR),	// UART1 Rx
+		(&LPC_UART2->/*RBTHDLR.*/THR),	// UART2 Tx
+		(&LPC_UART2->/*RBTHDLR.*/RBR),	// UART2 Rx
+		(&LPC_UART3->/*RBTHDLR.*/THR),	// UART3 Tx
+		(&LPC_UART3->/*RBTHDLR.*/RBR),	// UART3 Rx
+		(&LPC_TIM0->MR0),				// MAT0.0
+		(&LPC_TIM0->MR1),				// MAT0.1
+		(&LPC_TIM1->MR0),				// MAT1.0
+		(&LPC_TIM1->MR1),				// MAT1.1
+		(&LPC_TIM2->MR0),				// MAT2.0
+		(&LPC_TIM2->MR1),				// MAT2.1
+		(&LPC_TIM3->MR0),				// MAT3.0
+		(&LPC_TIM3->MR1)				// MAT3.1
+};
+
+/**
+ * @brief Lookup Table of GPDMA Channel Number matched with
+ * GPDMA channel pointer
+ */
+static LPC_GPDMACH_TypeDef * const pGPDMACh[GPDMA_NUM_CHANNELS] = {
+		LPC_GPDMACH0,	// GPDMA Channel 0
+		LPC_GPDMACH1,	// GPDMA Channel 1
+		LPC_GPDMACH2,	// GPDMA Channel 2
+		LPC_GPDMACH3,	// GPDMA Channel 3
+		LPC_GPDMACH4,	// GPDMA Channel 4
+		LPC_GPDMACH5,	// GPDMA Channel 5
+		LPC_GPDMACH6,	// GPDMA Channel 6
+		LPC_GPDMACH7	// GPDMA Channel 7
+};
+
+/**
+ * @brief Optimized Peripheral Source and Destination burst size
+ */
+static const uint8_t GPDMA_LUTPerBurst[] = {
+		GPDMA_BSIZE_4,		// SSP0 Tx
+		GPDMA_BSIZE_4,		// SSP0 Rx
+		GPDMA_BSIZE_4,		// SSP1 Tx
+		GPDMA_BSIZE_4,		// SSP1 Rx
+		GPDMA_BSIZE_1,		// ADC
+		GPDMA_BSIZE_32, 	// I2S channel 0
+		GPDMA_BSIZE_32, 	// I2S channel 1
+		GPDMA_BSIZE_1,		// DAC
+		GPDMA_BSIZE_1,		// UART0 Tx
+		GPDMA_BSIZE_1,		// UART0 Rx
+		GPDMA_BSIZE_1,		// UART1 Tx
+		GPDMA_BSIZE_1,		// UART1 Rx
+		GPDMA_BSIZE_1,		// UART2 Tx
+		GPDMA_BSIZE_1,		// UART2 Rx
+		GPDMA_BSIZE_1,		// UART3 Tx
+		GPDMA_BSIZE_1,		// UART3 Rx
+		GPDMA_BSIZE_1,		// MAT0.0
+		GPDMA_BSIZE_1,		// MAT0.1
+		GPDMA_BSIZE_1,		// MAT1.0
+		GPDMA_BSIZE_1,		// MAT1.1
+		GPDMA_BSIZE_1,		// MAT2.0
+		GPDMA_BSIZE_1,		// MAT2.1
+		GPDMA_BSIZE_1,		// MAT3.0
+		GPDMA_BSIZE_1		// MAT3.1
+};
+
+/**
+ * @brief Optimized Peripheral Source and Destination transfer width
+ */
+static const uint8_t GPDMA_LUTPerWid[] = {
+		GPDMA_WIDTH_BYTE,		// SSP0 Tx
+		GPDMA_WIDTH_BYTE,		// SSP0 Rx
+		GPDMA_WIDTH_BYTE,		// SSP1 Tx
+		GPDMA_WIDTH_BYTE,		// SSP1 Rx
+		GPDMA_WIDTH_WORD,		// ADC
+		GPDMA_WIDTH_WORD, 		// I2S channel 0
+		GPDMA_WIDTH_WORD, 		// I2S channel 1
+		GPDMA_WIDTH_BYTE,		// DAC
+		GPDMA_WIDTH_BYTE,		// UART0 Tx
+		GPDMA_WIDTH_BYTE,		// UART0 Rx
+		GPDMA_WIDTH_BYTE,		// UART1 Tx
+		GPDMA_WIDTH_BYTE,		// UART1 Rx
+		GPDMA_WIDTH_BYTE,		// UART2 Tx
+		GPDMA_WIDTH_BYTE,		// UART2 Rx
+		GPDMA_WIDTH_BYTE,		// UART3 Tx
+		GPDMA_WIDTH_BYTE,		// UART3 Rx
+		GPDMA_WIDTH_WORD,		// MAT0.0
+		GPDMA_WIDTH_WORD,		// MAT0.1
+		GPDMA_WIDTH_WORD,		// MAT1.0
+		GPDMA_WIDTH_WORD,		// MAT1.1
+		GPDMA_WIDTH_WORD,		// MAT2.0
+		GPDMA_WIDTH_WORD,		// MAT2.1
+		GPDMA_WIDTH_WORD,		// MAT3.0
+		GPDMA_WIDTH_WORD		// MAT3.1
+};
+
+/** Bit mask of channels handed out by GPDMA_AllocChannel() */
+static volatile uint32_t GPDMA_ChannelUsed = 0;
+
+/** Completion callbacks, one per channel */
+static GPDMA_CALLBACK_Type GPDMA_Callback[GPDMA_NUM_CHANNELS];
+
+/**
+ * @}
+ */
+
+/* Private Functions ---------------------------------------------------------- */
+/** @defgroup GPDMA_Private_Functions GPDMA Private Functions
+ * @{
+ */
+
+static uint32_t gpdma_control (GPDMA_Channel_CFG_Type *GPDMAChannelConfig, FunctionalState TCInt);
+
+
+/*********************************************************************//**
+ * @brief		Build the channel control word for one descriptor
+ * @param[in]	GPDMAChannelConfig	Pointer to a GPDMA_Channel_CFG_Type
+ * 									structure, TransferSize, TransferType
+ * 									and address hold flags are used
+ * @param[in]	TCInt	ENABLE to raise the terminal count interrupt when
+ * 						this descriptor completes
+ * @return		DMACCxControl value
+ **********************************************************************/
+static uint32_t gpdma_control (GPDMA_Channel_CFG_Type *GPDMAChannelConfig, FunctionalState TCInt)
+{
+	uint32_t ctrl, width, bsize;
+
+	switch (GPDMAChannelConfig->TransferType)
+	{
+	// Memory to peripheral
+	case GPDMA_TRANSFERTYPE_M2P:
+		width = MAX(GPDMA_LUTPerWid[GPDMAChannelConfig->DstConn], GPDMAChannelConfig->TransferWidth);
+		bsize = GPDMA_LUTPerBurst[GPDMAChannelConfig->DstConn];
+		ctrl = GPDMA_DMACCxControl_SBSize(bsize) | GPDMA_DMACCxControl_DBSize(bsize);
+		if (GPDMAChannelConfig->SrcFixed == FALSE)
+		{
+			ctrl |= GPDMA_DMACCxControl_SI;
+		}
+		break;
+
+	// Peripheral to memory
+	case GPDMA_TRANSFERTYPE_P2M:
+		width = MAX(GPDMA_LUTPerWid[GPDMAChannelConfig->SrcConn], GPDMAChannelConfig->TransferWidth);
+		bsize = GPDMA_LUTPerBurst[GPDMAChannelConfig->SrcConn];
+		ctrl = GPDMA_DMACCxControl_SBSize(bsize) | GPDMA_DMACCxControl_DBSize(bsize);
+		if (GPDMAChannelConfig->DstFixed == FALSE)
+		{
+			ctrl |= GPDMA_DMACCxControl_DI;
+		}
+		break;
+
+	// Peripheral to peripheral
+	case GPDMA_TRANSFERTYPE_P2P:
+		width = GPDMA_LUTPerWid[GPDMAChannelConfig->SrcConn];
+		ctrl = GPDMA_DMACCxControl_SBSize(GPDMA_LUTPerBurst[GPDMAChannelConfig->SrcConn]) \
+				| GPDMA_DMACCxControl_DBSize(GPDMA_LUTPerBurst[GPDMAChannelConfig->DstConn]);
+		break;
+
+	// Memory to memory
+	case GPDMA_TRANSFERTYPE_M2M:
+	default:
+		width = GPDMAChannelConfig->TransferWidth;
+		ctrl = GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_32) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_32);
+		if (GPDMAChannelConfig->SrcFixed == FALSE)
+		{
+			ctrl |= GPDMA_DMACCxControl_SI;
+		}
+		if (GPDMAChannelConfig->DstFixed == FALSE)
+		{
+			ctrl |= GPDMA_DMACCxControl_DI;
+		}
+		break;
+	}
+
+	ctrl |= GPDMA_DMACCxControl_TransferSize(GPDMAChannelConfig->TransferSize) \
+			| GPDMA_DMACCxControl_SWidth(width) \
+			| GPDMA_DMACCxControl_DWidth(width);
+
+	if (TCInt == ENABLE)
+	{
+		ctrl |= GPDMA_DMACCxControl_I;
+	}
+
+	return ctrl;
+}
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup GPDMA_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief	GPDMA interrupt handler sub-routine, dispatches terminal
+ * 			count and error events to the registered channel callbacks
+ * @param	None
+ * @return	None
+ **********************************************************************/
+void DMA_IRQHandler(void)
+{
+	uint32_t tc, err, ch;
+
+	tc = LPC_GPDMA->DMACIntTCStat & GPDMA_DMACIntTCStat_BITMASK;
+	err = LPC_GPDMA->DMACIntErrStat & GPDMA_DMACIntErrStat_BITMASK;
+
+	// Clear before dispatch so a callback may restart its channel
+	LPC_GPDMA->DMACIntTCClear = tc;
+	LPC_GPDMA->DMACIntErrClr = err;
+
+	for (ch = 0; ch < GPDMA_NUM_CHANNELS; ch++)
+	{
+		if (((tc | err) & GPDMA_DMACIntStat_Ch(ch)) && (GPDMA_Callback[ch] != NULL))
+		{
+			GPDMA_Callback[ch](ch, (err & GPDMA_DMACIntErrStat_Ch(ch)) ? GPDMA_STAT_ERROR : GPDMA_STAT_DONE);
+		}
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief		Initialize GPDMA controller
+ * @param		None
+ * @return		None
+ **********************************************************************/
+void GPDMA_Init(void)
+{
+	/* Enable GPDMA clock */
+	CLKPWR_ConfigPPWR (CLKPWR_PCONP_PCGPDMA, ENABLE);
+
+	// Reset all channel configuration register
+	LPC_GPDMACH0->DMACCConfig = 0;
+	LPC_GPDMACH1->DMACCConfig = 0;
+	LPC_GPDMACH2->DMACCConfig = 0;
+	LPC_GPDMACH3->DMACCConfig = 0;
+	LPC_GPDMACH4->DMACCConfig = 0;
+	LPC_GPDMACH5->DMACCConfig = 0;
+	LPC_GPDMACH6->DMACCConfig = 0;
+	LPC_GPDMACH7->DMACCConfig = 0;
+
+	/* Clear all DMA interrupt and error flag */
+	LPC_GPDMA->DMACIntTCClear = 0xFF;
+	LPC_GPDMA->DMACIntErrClr = 0xFF;
+
+	/* Enable DMA controller, little endian AHB master */
+	LPC_GPDMA->DMACConfig = GPDMA_DMACConfig_E;
+	while (!(LPC_GPDMA->DMACConfig & GPDMA_DMACConfig_E));
+
+	GPDMA_ChannelUsed = 0;
+
+	NVIC_SetPriority(DMA_IRQn, ((0x01<<3)|0x01));
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+
+
+/*****************************************************************************//**
+* @brief		Fills each GPDMA_Channel_CFG_Type member with its default value:
+* 				- TransferWidth = GPDMA_WIDTH_BYTE
+* 				- TransferType = GPDMA_TRANSFERTYPE_M2M
+* 				- SrcFixed = DstFixed = FALSE
+* 				- every address, size and connection = 0
+* @param[in]	GPDMAChannelConfig Pointer to a GPDMA_Channel_CFG_Type structure
+*                    which will be initialized.
+* @return		None
+*******************************************************************************/
+void GPDMA_ConfigStructInit(GPDMA_Channel_CFG_Type *GPDMAChannelConfig)
+{
+	GPDMAChannelConfig->ChannelNum = 0;
+	GPDMAChannelConfig->TransferSize = 0;
+	GPDMAChannelConfig->TransferWidth = GPDMA_WIDTH_BYTE;
+	GPDMAChannelConfig->SrcMemAddr = 0;
+	GPDMAChannelConfig->DstMemAddr = 0;
+	GPDMAChannelConfig->TransferType = GPDMA_TRANSFERTYPE_M2M;
+	GPDMAChannelConfig->SrcConn = 0;
+	GPDMAChannelConfig->DstConn = 0;
+	GPDMAChannelConfig->SrcFixed = FALSE;
+	GPDMAChannelConfig->DstFixed = FALSE;
+	GPDMAChannelConfig->DMALLI = 0;
+}
+
+
+/********************************************************************//**
+ * @brief 		Setup GPDMA channel peripheral according to the specified
+ *              parameters in the GPDMAChannelConfig. The channel is left
+ *              disabled, start it with GPDMA_ChannelCmd().
+ * @param[in]	GPDMAChannelConfig Pointer to a GPDMA_Channel_CFG_Type
+ * 									structure that contains the configuration
+ * 									information for the specified GPDMA channel
+ * @return		ERROR if selected channel is enabled before
+ * 				or SUCCESS if channel is configured successfully
+ * Note:		The terminal count interrupt is raised only at the end of the
+ * 				whole chain, i.e. by the head descriptor when DMALLI is 0,
+ * 				otherwise by the last LLI built with GPDMA_LLI_Init().
+ *********************************************************************/
+Status GPDMA_Setup(GPDMA_Channel_CFG_Type *GPDMAChannelConfig)
+{
+	LPC_GPDMACH_TypeDef *pDMAch;
+	uint32_t tmp1, tmp2;
+
+	CHECK_PARAM(PARAM_GPDMA_CHANNEL(GPDMAChannelConfig->ChannelNum));
+	CHECK_PARAM(PARAM_GPDMA_TRANSFERTYPE(GPDMAChannelConfig->TransferType));
+
+	if (LPC_GPDMA->DMACEnbldChns & (GPDMA_DMACEnbldChns_Ch(GPDMAChannelConfig->ChannelNum)))
+	{
+		// This channel is enabled, return ERROR, need to release this channel first
+		return ERROR;
+	}
+
+	// Get Channel pointer
+	pDMAch = pGPDMACh[GPDMAChannelConfig->ChannelNum];
+
+	// Reset the Interrupt status
+	LPC_GPDMA->DMACIntTCClear = GPDMA_DMACIntTCClear_Ch(GPDMAChannelConfig->ChannelNum);
+	LPC_GPDMA->DMACIntErrClr = GPDMA_DMACIntErrClr_Ch(GPDMAChannelConfig->ChannelNum);
+
+	// Clear DMA configure
+	pDMAch->DMACCControl = 0x00;
+	pDMAch->DMACCConfig = 0x00;
+
+	/* Assign Linker List Item value */
+	pDMAch->DMACCLLI = GPDMAChannelConfig->DMALLI & GPDMA_DMACCxLLI_BITMASK;
+
+	/* Set value to Channel Control Registers */
+	switch (GPDMAChannelConfig->TransferType)
+	{
+	// Memory to memory
+	case GPDMA_TRANSFERTYPE_M2M:
+		pDMAch->DMACCSrcAddr = GPDMAChannelConfig->SrcMemAddr;
+		pDMAch->DMACCDestAddr = GPDMAChannelConfig->DstMemAddr;
+		break;
+
+	// Memory to peripheral
+	case GPDMA_TRANSFERTYPE_M2P:
+		pDMAch->DMACCSrcAddr = GPDMAChannelConfig->SrcMemAddr;
+		pDMAch->DMACCDestAddr = (uint32_t) GPDMA_LUTPerAddr[GPDMAChannelConfig->DstConn];
+		break;
+
+	// Peripheral to memory
+	case GPDMA_TRANSFERTYPE_P2M:
+		pDMAch->DMACCSrcAddr = (uint32_t) GPDMA_LUTPerAddr[GPDMAChannelConfig->SrcConn];
+		pDMAch->DMACCDestAddr = GPDMAChannelConfig->DstMemAddr;
+		break;
+
+	// Peripheral to peripheral
+	case GPDMA_TRANSFERTYPE_P2P:
+		pDMAch->DMACCSrcAddr = (uint32_t) GPDMA_LUTPerAddr[GPDMAChannelConfig->SrcConn];
+		pDMAch->DMACCDestAddr = (uint32_t) GPDMA_LUTPerAddr[GPDMAChannelConfig->DstConn];
+		break;
+
+	// Do not support any more transfer type, return ERROR
+	default:
+		return ERROR;
+	}
+
+	pDMAch->DMACCControl = gpdma_control(GPDMAChannelConfig, \
+			(GPDMAChannelConfig->DMALLI == 0) ? ENABLE : DISABLE);
+
+	/* Re-Configure DMA Request Select for source peripheral */
+	if (GPDMAChannelConfig->SrcConn > 15)
+	{
+		LPC_SC->DMAREQSEL |= (1<<(GPDMAChannelConfig->SrcConn - 16));
+	}
+	else if (GPDMAChannelConfig->SrcConn > 7)
+	{
+		LPC_SC->DMAREQSEL &= ~(1<<(GPDMAChannelConfig->SrcConn - 8));
+	}
+
+	/* Re-Configure DMA Request Select for Destination peripheral */
+	if (GPDMAChannelConfig->DstConn > 15)
+	{
+		LPC_SC->DMAREQSEL |= (1<<(GPDMAChannelConfig->DstConn - 16));
+	}
+	else if (GPDMAChannelConfig->DstConn > 7)
+	{
+		LPC_SC->DMAREQSEL &= ~(1<<(GPDMAChannelConfig->DstConn - 8));
+	}
+
+	/* Matched peripheral numbers share the UART request lines */
+	tmp1 = GPDMAChannelConfig->SrcConn;
+	tmp1 = ((tmp1 > 15) ? (tmp1 - 8) : tmp1);
+	tmp2 = GPDMAChannelConfig->DstConn;
+	tmp2 = ((tmp2 > 15) ? (tmp2 - 8) : tmp2);
+
+	// Configure DMA Channel, enable Error Counter and Terminate counter
+	pDMAch->DMACCConfig = GPDMA_DMACCxConfig_IE | GPDMA_DMACCxConfig_ITC \
+		| GPDMA_DMACCxConfig_TransferType((uint32_t)GPDMAChannelConfig->TransferType) \
+		| GPDMA_DMACCxConfig_SrcPeripheral(tmp1) \
+		| GPDMA_DMACCxConfig_DestPeripheral(tmp2);
+
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Fill a Linked List Item from a channel configuration
+ * @param[out]	LLI		Pointer to the LLI to fill (word aligned, DMA
+ * 						accessible RAM)
+ * @param[in]	GPDMAChannelConfig	Channel configuration describing this
+ * 						part of the transfer. SrcMemAddr, DstMemAddr and
+ * 						TransferSize give the chunk, peripheral addresses
+ * 						are taken from SrcConn/DstConn as in GPDMA_Setup()
+ * @param[in]	Next	Next LLI in the chain or NULL if this is the last
+ * 						one, the last LLI raises the terminal count interrupt
+ * @return		None
+ **********************************************************************/
+void GPDMA_LLI_Init(GPDMA_LLI_Type *LLI, GPDMA_Channel_CFG_Type *GPDMAChannelConfig, GPDMA_LLI_Type *Next)
+{
+	CHECK_PARAM(PARAM_GPDMA_TRANSFERTYPE(GPDMAChannelConfig->TransferType));
+
+	switch (GPDMAChannelConfig->TransferType)
+	{
+	case GPDMA_TRANSFERTYPE_M2P:
+		LLI->SrcAddr = GPDMAChannelConfig->SrcMemAddr;
+		LLI->DstAddr = (uint32_t) GPDMA_LUTPerAddr[GPDMAChannelConfig->DstConn];
+		break;
+
+	case GPDMA_TRANSFERTYPE_P2M:
+		LLI->SrcAddr = (uint32_t) GPDMA_LUTPerAddr[GPDMAChannelConfig->SrcConn];
+		LLI->DstAddr = GPDMAChannelConfig->DstMemAddr;
+		break;
+
+	case GPDMA_TRANSFERTYPE_P2P:
+		LLI->SrcAddr = (uint32_t) GPDMA_LUTPerAddr[GPDMAChannelConfig->SrcConn];
+		LLI->DstAddr = (uint32_t) GPDMA_LUTPerAddr[GPDMAChannelConfig->DstConn];
+		break;
+
+	case GPDMA_TRANSFERTYPE_M2M:
+	default:
+		LLI->SrcAddr = GPDMAChannelConfig->SrcMemAddr;
+		LLI->DstAddr = GPDMAChannelConfig->DstMemAddr;
+		break;
+	}
+
+	LLI->NextLLI = ((uint32_t) Next) & GPDMA_DMACCxLLI_BITMASK;
+	LLI->Control = gpdma_control(GPDMAChannelConfig, (Next == NULL) ? ENABLE : DISABLE);
+}
+
+
+/*********************************************************************//**
+ * @brief		Allocate a free DMA channel
+ * @param		None
+ * @return		Channel number (0..7), lowest free number first so that
+ * 				the first allocation gets the highest priority, or
+ * 				(-1) if every channel is in use
+ **********************************************************************/
+int32_t GPDMA_AllocChannel(void)
+{
+	uint32_t primask;
+	int32_t ch;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	for (ch = 0; ch < GPDMA_NUM_CHANNELS; ch++)
+	{
+		if (!(GPDMA_ChannelUsed & (1UL << ch)))
+		{
+			GPDMA_ChannelUsed |= (1UL << ch);
+			break;
+		}
+	}
+
+	__set_PRIMASK(primask);
+
+	return ((ch < GPDMA_NUM_CHANNELS) ? ch : (-1));
+}
+
+
+/*********************************************************************//**
+ * @brief		Release a channel obtained with GPDMA_AllocChannel(),
+ * 				the channel is disabled and its callback removed
+ * @param[in]	channelNum	GPDMA channel, should be in range from 0 to 7
+ * @return		None
+ **********************************************************************/
+void GPDMA_FreeChannel(uint8_t channelNum)
+{
+	uint32_t primask;
+
+	CHECK_PARAM(PARAM_GPDMA_CHANNEL(channelNum));
+
+	GPDMA_ChannelCmd(channelNum, DISABLE);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	GPDMA_Callback[channelNum] = NULL;
+	GPDMA_ChannelUsed &= ~(1UL << channelNum);
+	__set_PRIMASK(primask);
+}
+
+
+/*********************************************************************//**
+ * @brief		Register the completion callback of a channel
+ * @param[in]	channelNum	GPDMA channel, should be in range from 0 to 7
+ * @param[in]	callback	Function called from DMA_IRQHandler() on terminal
+ * 							count or error, NULL to remove
+ * @return		None
+ **********************************************************************/
+void GPDMA_SetCallback(uint8_t channelNum, GPDMA_CALLBACK_Type callback)
+{
+	CHECK_PARAM(PARAM_GPDMA_CHANNEL(channelNum));
+
+	GPDMA_Callback[channelNum] = callback;
+}
+
+
+/*********************************************************************//**
+ * @brief		Enable/Disable DMA channel
+ * @param[in]	channelNum	GPDMA channel, should be in range from 0 to 7
+ * @param[in]	NewState	New State of this command, should be:
+ * 					- ENABLE.
+ * 					- DISABLE.
+ * @return		None
+ **********************************************************************/
+void GPDMA_ChannelCmd(uint8_t channelNum, FunctionalState NewState)
+{
+	LPC_GPDMACH_TypeDef *pDMAch;
+
+	CHECK_PARAM(PARAM_GPDMA_CHANNEL(channelNum));
+	CHECK_PARAM(PARAM_FUNCTIONALSTATE(NewState));
+
+	// Get Channel pointer
+	pDMAch = pGPDMACh[channelNum];
+
+	if (NewState == ENABLE)
+	{
+		pDMAch->DMACCConfig |= GPDMA_DMACCxConfig_E;
+	}
+	else
+	{
+		pDMAch->DMACCConfig &= (~GPDMA_DMACCxConfig_E);
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief		Check if corresponding channel does have an active interrupt
+ * 				request or not
+ * @param[in]	type		type of status, should be:
+ * 					- GPDMA_STAT_INT: 		GPDMA Interrupt Status
+ * 					- GPDMA_STAT_INTTC: 	GPDMA Interrupt Terminal Count Request Status
+ * 					- GPDMA_STAT_INTERR:	GPDMA Interrupt Error Status
+ * 					- GPDMA_STAT_RAWINTTC:	GPDMA Raw Interrupt Terminal Count Status
+ * 					- GPDMA_STAT_RAWINTERR:	GPDMA Raw Error Interrupt Status
+ * 					- GPDMA_STAT_ENABLED_CH:GPDMA Enabled Channel Status
+ * @param[in]	channel		GPDMA channel, should be in range from 0 to 7
+ * @return		IntStatus	status of DMA channel interrupt after masking
+ * 				Should be:
+ * 					- SET: the corresponding channel has no active interrupt request
+ * 					- RESET: the corresponding channel does have an active interrupt request
+ **********************************************************************/
+IntStatus GPDMA_IntGetStatus(GPDMA_Status_Type type, uint8_t channel)
+{
+	CHECK_PARAM(PARAM_GPDMA_STAT(type));
+	CHECK_PARAM(PARAM_GPDMA_CHANNEL(channel));
+
+	switch (type)
+	{
+	case GPDMA_STAT_INT: //check status of DMA channel interrupts
+		if (LPC_GPDMA->DMACIntStat & (GPDMA_DMACIntStat_Ch(channel)))
+			return SET;
+		return RESET;
+	case GPDMA_STAT_INTTC: // check terminal count interrupt request status for DMA
+		if (LPC_GPDMA->DMACIntTCStat & GPDMA_DMACIntTCStat_Ch(channel))
+			return SET;
+		return RESET;
+	case GPDMA_STAT_INTERR: //check interrupt status for DMA channels
+		if (LPC_GPDMA->DMACIntErrStat & GPDMA_DMACIntTCClear_Ch(channel))
+			return SET;
+		return RESET;
+	case GPDMA_STAT_RAWINTTC: //check status of the terminal count interrupt for DMA channels
+		if (LPC_GPDMA->DMACRawIntTCStat & GPDMA_DMACIntTCStat_Ch(channel))
+			return SET;
+		return RESET;
+	case GPDMA_STAT_RAWINTERR: //check status of the error interrupt for DMA channels
+		if (LPC_GPDMA->DMACRawIntErrStat & GPDMA_DMACIntErrStat_Ch(channel))
+			return SET;
+		return RESET;
+	default: //check enable status for DMA channels
+		if (LPC_GPDMA->DMACEnbldChns & GPDMA_DMACEnbldChns_Ch(channel))
+			return SET;
+		return RESET;
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief		Clear one or more interrupt requests on DMA channels
+ * @param[in]	type		type of interrupt request, should be:
+ * 					- GPDMA_STATCLR_INTTC: 	GPDMA Interrupt Terminal Count Request Clear
+ * 					- GPDMA_STATCLR_INTERR: GPDMA Interrupt Error Clear
+ * @param[in]	channel		GPDMA channel, should be in range from 0 to 7
+ * @return		None
+ **********************************************************************/
+void GPDMA_ClearIntPending(GPDMA_StateClear_Type type, uint8_t channel)
+{
+	CHECK_PARAM(PARAM_GPDMA_STATCLR(type));
+	CHECK_PARAM(PARAM_GPDMA_CHANNEL(channel));
+
+	if (type == GPDMA_STATCLR_INTTC) // clears the terminal count interrupt request on DMA channel
+		LPC_GPDMA->DMACIntTCClear = GPDMA_DMACIntTCClear_Ch(channel);
+	else // clear the error interrupt request
+		LPC_GPDMA->DMACIntErrClr = GPDMA_DMACIntErrClr_Ch(channel);
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
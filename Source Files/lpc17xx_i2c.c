@@ -12,6 +12,8 @@
  */
 
 /* Includes ------------------------------------------------------------------- */
+/* System header first: device headers it pulls in use the I2C types */
+#include "lpc_system_init.h"
 #include "lpc17xx_i2c.h"
 
 
@@ -34,6 +36,15 @@ typedef struct
   int32_t		dir;								/* Current direction phase, 0 - write, 1 - read */
 } I2C_CFG_T;
 
+/**
+ * @brief I2C master transaction queue type
+ */
+typedef struct
+{
+  I2C_XFER_Type * volatile head;					/* Transaction on the bus, NULL when idle */
+  I2C_XFER_Type *tail;								/* Last queued transaction */
+} I2C_QUEUE_T;
+
 /**
  * @}
  */
@@ -44,6 +55,11 @@ typedef struct
  */
 static I2C_CFG_T i2cdat[3];
 
+/**
+ * @brief Master transaction queues for I2C0, I2C1 and I2C2
+ */
+static I2C_QUEUE_T i2cq[3];
+
 static uint32_t I2C_MasterComplete[3];
 static uint32_t I2C_SlaveComplete[3];
 
@@ -69,6 +85,15 @@ static uint32_t I2C_GetByte (LPC_I2C_TypeDef *I2Cx, uint8_t *retdat, Bool ack);
 /* I2C set clock (hz) */
 static void I2C_SetClock (LPC_I2C_TypeDef *I2Cx, uint32_t target_clock);
 
+/* Load a queued transaction into the master state machine */
+static void I2C_QueueLoad (int32_t tmp, I2C_XFER_Type *xfer);
+
+/* Retire the current queued transaction and start the next one */
+static void I2C_QueueNext (LPC_I2C_TypeDef *I2Cx, int32_t tmp);
+
+/* Route an I2C interrupt to the master or slave handler */
+static void I2C_IRQHandler (LPC_I2C_TypeDef *I2Cx);
+
 /*--------------------------------------------------------------------------------*/
 /********************************************************************//**
  * @brief		Convert from I2C peripheral to number
@@ -216,6 +241,102 @@ static void I2C_SetClock (LPC_I2C_TypeDef *I2Cx, uint32_t target_clock)
 	I2Cx->I2SCLH = (uint32_t)(temp / 2);
 	I2Cx->I2SCLL = (uint32_t)(temp - I2Cx->I2SCLH);
 }
+
+/*********************************************************************//**
+ * @brief 		Load a queued transaction into the master state machine
+ * @param[in] 	tmp		I2C number, could be: 0..2
+ * @param[in]	xfer	Transaction to run next
+ * @return 		None
+ ***********************************************************************/
+static void I2C_QueueLoad (int32_t tmp, I2C_XFER_Type *xfer)
+{
+	xfer->setup.tx_count = 0;
+	xfer->setup.rx_count = 0;
+	xfer->setup.retransmissions_count = 0;
+	xfer->setup.status = 0;
+
+	i2cdat[tmp].txrx_setup = (uint32_t) &xfer->setup;
+	// Set direction phase, write first
+	i2cdat[tmp].dir = 0;
+}
+
+/*********************************************************************//**
+ * @brief 		Retire the transaction at the head of the queue and
+ * 				start the next one, called from the master handler
+ * 				instead of the final STOP.
+ * @param[in] 	I2Cx	I2C peripheral selected, should be:
+ * 				- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @param[in] 	tmp		I2C number, could be: 0..2
+ * @return 		None
+ *
+ * Note:
+ * A transaction submitted with chain set hands the bus to its successor
+ * with a repeated START, otherwise STOP and START are issued back-to-back.
+ * The callback runs last, so it may submit new transactions.
+ ***********************************************************************/
+static void I2C_QueueNext (LPC_I2C_TypeDef *I2Cx, int32_t tmp)
+{
+	I2C_XFER_Type *done, *next;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	done = i2cq[tmp].head;
+	next = done->next;
+	i2cq[tmp].head = next;
+	if (next == NULL)
+	{
+		i2cq[tmp].tail = NULL;
+	}
+
+	__set_PRIMASK(primask);
+
+	if (next == NULL)
+	{
+		// Queue empty, release the bus
+		I2C_IntCmd(I2Cx, 0);
+		I2C_Stop(I2Cx);
+	}
+	else
+	{
+		I2C_QueueLoad(tmp, next);
+		if (!done->chain)
+		{
+			// STO and STA together: STOP, then a new START
+			I2Cx->I2CONSET = I2C_I2CONSET_STO;
+		}
+		I2Cx->I2CONSET = I2C_I2CONSET_STA;
+		I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC;
+	}
+
+	if (done->complete != NULL)
+	{
+		done->complete(done, (done->setup.status & I2C_SETUP_STATUS_DONE) ? SUCCESS : ERROR);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Route an I2C interrupt to the master or slave handler
+ * @param[in] 	I2Cx	I2C peripheral selected, should be:
+ * 				- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @return 		None
+ ***********************************************************************/
+static void I2C_IRQHandler (LPC_I2C_TypeDef *I2Cx)
+{
+	if ((I2Cx->I2STAT & I2C_STAT_CODE_BITMASK) < I2C_I2STAT_S_RX_SLAW_ACK)
+	{
+		I2C_MasterHandler(I2Cx);
+	}
+	else
+	{
+		I2C_SlaveHandler(I2Cx);
+	}
+}
 /* End of Private Functions --------------------------------------------------- */
 
 
@@ -644,8 +765,10 @@ retry:
 			// check if retransmission is available
 			if (txrx_setup->retransmissions_count < txrx_setup->retransmissions_max)
 			{
-				// Clear tx count
+				// Clear counters and restart from the write phase
 				txrx_setup->tx_count = 0;
+				txrx_setup->rx_count = 0;
+				i2cdat[tmp].dir = 0;
 				I2Cx->I2CONSET = I2C_I2CONSET_STA;
 				I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC;
 				txrx_setup->retransmissions_count++;
@@ -654,6 +777,12 @@ retry:
 			else
 			{
 end_stage:
+				if (i2cq[tmp].head != NULL)
+				{
+					// Queued transaction, hand over to the next one
+					I2C_QueueNext(I2Cx, tmp);
+					break;
+				}
 				// Disable interrupt
 				I2C_IntCmd(I2Cx, 0);
 				// Send stop
@@ -1054,6 +1183,94 @@ error:
 	return ERROR;
 }
 
+/*********************************************************************//**
+ * @brief 		Write a header followed by a payload as one master write
+ * 				transfer in polling mode
+ * @param[in]	I2Cx		I2C peripheral selected, should be
+ *  			- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @param[in]	sl_addr7bit	Slave address in 7bit mode
+ * @param[in]	head		Header bytes, e.g. register or memory address
+ * @param[in]	head_len	Header length - 0 if not used
+ * @param[in]	data		Payload, sent straight from the caller's buffer
+ * @param[in]	data_len	Payload length - 0 if not used
+ * @return 		SUCCESS or ERROR (NACK or bus error, no retransmission)
+ **********************************************************************/
+Status I2C_MasterWriteGather(LPC_I2C_TypeDef *I2Cx, uint32_t sl_addr7bit, \
+		uint8_t *head, uint32_t head_len, uint8_t *data, uint32_t data_len)
+{
+	uint32_t CodeStatus, i;
+
+	CHECK_PARAM(PARAM_I2Cx(I2Cx));
+
+	CodeStatus = I2C_Start(I2Cx);
+	if ((CodeStatus != I2C_I2STAT_M_TX_START) && (CodeStatus != I2C_I2STAT_M_TX_RESTART))
+	{
+		goto error;
+	}
+
+	/* Send slave address + WR direction bit = 0 ----------------------------------- */
+	if (I2C_SendByte(I2Cx, (sl_addr7bit << 1)) != I2C_I2STAT_M_TX_SLAW_ACK)
+	{
+		goto error;
+	}
+
+	for (i = 0; i < head_len; i++)
+	{
+		if (I2C_SendByte(I2Cx, head[i]) != I2C_I2STAT_M_TX_DAT_ACK)
+		{
+			goto error;
+		}
+	}
+
+	for (i = 0; i < data_len; i++)
+	{
+		if (I2C_SendByte(I2Cx, data[i]) != I2C_I2STAT_M_TX_DAT_ACK)
+		{
+			goto error;
+		}
+	}
+
+	I2C_Stop(I2Cx);
+	return SUCCESS;
+
+error:
+	I2C_Stop(I2Cx);
+	return ERROR;
+}
+
+/*********************************************************************//**
+ * @brief 		Poll a slave with SLA+W until it acknowledges, e.g. an
+ * 				EEPROM that ignores its address during a write cycle
+ * @param[in]	I2Cx		I2C peripheral selected, should be
+ *  			- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @param[in]	sl_addr7bit	Slave address in 7bit mode
+ * @param[in]	max_tries	Number of address probes before giving up
+ * @return 		SUCCESS (slave acknowledged) or ERROR
+ **********************************************************************/
+Status I2C_MasterAckPoll(LPC_I2C_TypeDef *I2Cx, uint32_t sl_addr7bit, uint32_t max_tries)
+{
+	uint32_t CodeStatus;
+
+	CHECK_PARAM(PARAM_I2Cx(I2Cx));
+
+	while (max_tries--)
+	{
+		CodeStatus = I2C_Start(I2Cx);
+		if (((CodeStatus == I2C_I2STAT_M_TX_START) || (CodeStatus == I2C_I2STAT_M_TX_RESTART)) \
+				&& (I2C_SendByte(I2Cx, (sl_addr7bit << 1)) == I2C_I2STAT_M_TX_SLAW_ACK))
+		{
+			I2C_Stop(I2Cx);
+			return SUCCESS;
+		}
+		I2C_Stop(I2Cx);
+	}
+	return ERROR;
+}
+
 /*********************************************************************//**
  * @brief 		Receive and Transmit data in slave mode
  * @param[in]	I2Cx			I2C peripheral selected, should be
@@ -1451,6 +1668,113 @@ uint32_t I2C_MasterTransferComplete(LPC_I2C_TypeDef *I2Cx)
 	return retval;
 }
 
+/*********************************************************************//**
+ * @brief 		Queue master transactions, serviced from the I2C interrupt
+ * @param[in]	I2Cx	I2C peripheral selected, should be:
+ *  			- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @param[in]	xfer	Array of num transactions, filled in as for
+ * 						I2C_MasterTransferData() plus callback and argument
+ * @param[in]	num		Number of transactions in the batch
+ * @return 		SUCCESS or ERROR (empty batch)
+ *
+ * Note:
+ * - Transactions of one batch are chained with repeated START, the bus is
+ * released with STOP only after the last one.
+ * - The transactions and their data buffers belong to the driver until the
+ * completion callback has run; the callback is called in interrupt context.
+ * - Don't mix with I2C_MasterTransferData() on the same bus while the queue
+ * is busy.
+ **********************************************************************/
+Status I2C_MasterSubmit(LPC_I2C_TypeDef *I2Cx, I2C_XFER_Type *xfer, uint32_t num)
+{
+	uint32_t i, primask;
+	int32_t tmp;
+
+	CHECK_PARAM(PARAM_I2Cx(I2Cx));
+
+	if (num == 0)
+	{
+		return ERROR;
+	}
+
+	for (i = 0; i < num; i++)
+	{
+		xfer[i].chain = (i < (num - 1)) ? TRUE : FALSE;
+		xfer[i].next = (i < (num - 1)) ? &xfer[i + 1] : NULL;
+	}
+
+	tmp = I2C_getNum(I2Cx);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (i2cq[tmp].head != NULL)
+	{
+		// Bus busy, the interrupt will get to this batch
+		i2cq[tmp].tail->next = xfer;
+		i2cq[tmp].tail = &xfer[num - 1];
+		__set_PRIMASK(primask);
+		return SUCCESS;
+	}
+
+	i2cq[tmp].head = xfer;
+	i2cq[tmp].tail = &xfer[num - 1];
+	I2C_QueueLoad(tmp, xfer);
+
+	/* First Start condition -------------------------------------------------------------- */
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+	I2Cx->I2CONSET = I2C_I2CONSET_STA;
+	I2C_IntCmd(I2Cx, 1);
+
+	__set_PRIMASK(primask);
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief 		Check whether the master transaction queue is running
+ * @param[in]	I2Cx	I2C peripheral selected, should be:
+ *  			- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @return 		SET while transactions are pending, otherwise RESET
+ **********************************************************************/
+FlagStatus I2C_MasterQueueBusy(LPC_I2C_TypeDef *I2Cx)
+{
+	return ((i2cq[I2C_getNum(I2Cx)].head != NULL) ? SET : RESET);
+}
+
+/*********************************************************************//**
+ * @brief	I2C0 interrupt handler sub-routine
+ * @param	None
+ * @return	None
+ **********************************************************************/
+void I2C0_IRQHandler(void)
+{
+	I2C_IRQHandler(LPC_I2C0);
+}
+
+/*********************************************************************//**
+ * @brief	I2C1 interrupt handler sub-routine
+ * @param	None
+ * @return	None
+ **********************************************************************/
+void I2C1_IRQHandler(void)
+{
+	I2C_IRQHandler(LPC_I2C1);
+}
+
+/*********************************************************************//**
+ * @brief	I2C2 interrupt handler sub-routine
+ * @param	None
+ * @return	None
+ **********************************************************************/
+void I2C2_IRQHandler(void)
+{
+	I2C_IRQHandler(LPC_I2C2);
+}
+
 /*********************************************************************//**
  * @brief 		Get status of Slave Transfer
  * @param[in]	I2Cx	I2C peripheral selected, should be:
@@ -21,12 +21,34 @@
  */
 
 
+/* Private Types -------------------------------------------------------------- */
+/** @brief SSP DMA transfer state, one per SSP port */
+typedef struct {
+	LPC_SSP_TypeDef *SSPx;					/**< SSP port of this state */
+	SSP_DATA_SETUP_Type *dataCfg;			/**< Transfer in progress, NULL if idle */
+	uint32_t tx_ch;							/**< GPDMA channel feeding the TX FIFO */
+	uint32_t rx_ch;							/**< GPDMA channel draining the RX FIFO */
+	uint32_t width;							/**< Bytes per frame, 1 or 2 */
+	uint32_t done;							/**< Bytes programmed into the DMA so far */
+	GPDMA_LLI_Type tx_lli[SSP_DMA_LLI_NUM];	/**< TX chain of the current segment */
+	GPDMA_LLI_Type rx_lli[SSP_DMA_LLI_NUM];	/**< RX chain of the current segment */
+} SSP_DMA_STATE_Type;
+
+/* Private Variables ---------------------------------------------------------- */
+static SSP_DMA_STATE_Type ssp_dma[2];
+
+/** Dummy transmit word and receive sink for one-directional DMA transfers */
+static uint32_t ssp_dma_dummy_tx = 0xFFFF;
+static uint32_t ssp_dma_dummy_rx;
+
 /* Public Functions ----------------------------------------------------------- */
 /** @addtogroup SSP_Public_Functions
  * @{
  */
 
-static void setSSPclock (LPC_SSP_TypeDef *SSPx, uint32_t target_clock);
+static void ssp_dma_segment (SSP_DMA_STATE_Type *st);
+static void ssp_dma_finish (SSP_DMA_STATE_Type *st, uint32_t status);
+static void ssp_dma_callback (uint32_t ChannelNum, uint32_t Status);
 
 
 /*********************************************************************//**
@@ -194,10 +216,11 @@ void SSP_Config (LPC_SSP_TypeDef *SSPx)
  * @param[in] 	SSPx	SSP peripheral definition, should be:
  * 						- LPC_SSP0: SSP0 peripheral
  * 						- LPC_SSP1: SSP1 peripheral
- * @param[in]	target_clock : clock of SSP (Hz)
+ * @param[in]	target_clock : clock of SSP (Hz), the achieved rate is
+ * 				the closest one at or under it
  * @return 		None
  ***********************************************************************/
-static void setSSPclock (LPC_SSP_TypeDef *SSPx, uint32_t target_clock)
+void SSP_SetClock (LPC_SSP_TypeDef *SSPx, uint32_t target_clock)
 {
     uint32_t prescale, cr0_div, cmp_clk, ssp_clk;
 
@@ -239,6 +262,152 @@ static void setSSPclock (LPC_SSP_TypeDef *SSPx, uint32_t target_clock)
     SSPx->CPSR = prescale & SSP_CPSR_BITMASK;
 }
 
+
+/*********************************************************************//**
+ * @brief 		Program the next DMA segment of the transfer in progress,
+ * 				the first GPDMA_MAX_TRANSFER frames go to the channel
+ * 				registers and the rest to the LLI chain of the port
+ * @param[in]	st		DMA state of the SSP port
+ * @return 		None
+ ***********************************************************************/
+static void ssp_dma_segment (SSP_DMA_STATE_Type *st)
+{
+	GPDMA_Channel_CFG_Type txcfg, rxcfg;
+	SSP_DATA_SETUP_Type *dataCfg = st->dataCfg;
+	uint32_t frames, nlli, offset, i;
+
+	frames = (dataCfg->length - st->done) / st->width;
+	frames = MIN(frames, GPDMA_MAX_TRANSFER * (SSP_DMA_LLI_NUM + 1));
+	nlli = (frames - 1) / GPDMA_MAX_TRANSFER;
+
+	// TX: memory (or dummy word) to SSP data register
+	GPDMA_ConfigStructInit(&txcfg);
+	txcfg.ChannelNum = st->tx_ch;
+	txcfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+	txcfg.DstConn = (st->SSPx == LPC_SSP0) ? GPDMA_CONN_SSP0_Tx : GPDMA_CONN_SSP1_Tx;
+	txcfg.TransferWidth = (st->width == 2) ? GPDMA_WIDTH_HALFWORD : GPDMA_WIDTH_BYTE;
+	txcfg.SrcFixed = (dataCfg->tx_data == NULL) ? TRUE : FALSE;
+	txcfg.SrcMemAddr = (uint32_t) &ssp_dma_dummy_tx;
+
+	// RX: SSP data register to memory (or sink word)
+	GPDMA_ConfigStructInit(&rxcfg);
+	rxcfg.ChannelNum = st->rx_ch;
+	rxcfg.TransferType = GPDMA_TRANSFERTYPE_P2M;
+	rxcfg.SrcConn = (st->SSPx == LPC_SSP0) ? GPDMA_CONN_SSP0_Rx : GPDMA_CONN_SSP1_Rx;
+	rxcfg.TransferWidth = txcfg.TransferWidth;
+	rxcfg.DstFixed = (dataCfg->rx_data == NULL) ? TRUE : FALSE;
+	rxcfg.DstMemAddr = (uint32_t) &ssp_dma_dummy_rx;
+
+	for (i = 0; i <= nlli; i++)
+	{
+		offset = i * GPDMA_MAX_TRANSFER;
+		txcfg.TransferSize = rxcfg.TransferSize = MIN(frames - offset, GPDMA_MAX_TRANSFER);
+		if (txcfg.SrcFixed == FALSE)
+		{
+			txcfg.SrcMemAddr = (uint32_t)dataCfg->tx_data + st->done + (offset * st->width);
+		}
+		if (rxcfg.DstFixed == FALSE)
+		{
+			rxcfg.DstMemAddr = (uint32_t)dataCfg->rx_data + st->done + (offset * st->width);
+		}
+
+		if (i == 0)
+		{
+			txcfg.DMALLI = (nlli) ? (uint32_t) &st->tx_lli[0] : 0;
+			rxcfg.DMALLI = (nlli) ? (uint32_t) &st->rx_lli[0] : 0;
+			GPDMA_Setup(&txcfg);
+			GPDMA_Setup(&rxcfg);
+		}
+		else
+		{
+			GPDMA_LLI_Init(&st->tx_lli[i-1], &txcfg, (i < nlli) ? &st->tx_lli[i] : NULL);
+			GPDMA_LLI_Init(&st->rx_lli[i-1], &rxcfg, (i < nlli) ? &st->rx_lli[i] : NULL);
+		}
+	}
+
+	st->done += frames * st->width;
+
+	// RX first so that nothing is lost once TX starts clocking
+	GPDMA_ChannelCmd(st->rx_ch, ENABLE);
+	GPDMA_ChannelCmd(st->tx_ch, ENABLE);
+}
+
+
+/*********************************************************************//**
+ * @brief 		End the DMA transfer of a port and release its channels
+ * @param[in]	st		DMA state of the SSP port
+ * @param[in]	status	SSP_STAT_DONE or SSP_STAT_ERROR
+ * @return 		None
+ ***********************************************************************/
+static void ssp_dma_finish (SSP_DMA_STATE_Type *st, uint32_t status)
+{
+	st->SSPx->DMACR = 0;
+
+	GPDMA_FreeChannel(st->tx_ch);
+	GPDMA_FreeChannel(st->rx_ch);
+
+	if (status == SSP_STAT_ERROR)
+	{
+		status |= st->SSPx->RIS;
+	}
+	st->dataCfg->status = status;
+	st->dataCfg = NULL;
+}
+
+
+/*********************************************************************//**
+ * @brief 		GPDMA completion callback of the SSP DMA channels, the RX
+ * 				channel terminal count closes a segment since RX always
+ * 				finishes after TX
+ * @param[in]	ChannelNum	GPDMA channel that raised the interrupt
+ * @param[in]	Status		GPDMA_STAT_DONE or GPDMA_STAT_ERROR
+ * @return 		None
+ ***********************************************************************/
+static void ssp_dma_callback (uint32_t ChannelNum, uint32_t Status)
+{
+	SSP_DMA_STATE_Type *st;
+
+	if ((ssp_dma[0].dataCfg != NULL) && \
+		((ssp_dma[0].tx_ch == ChannelNum) || (ssp_dma[0].rx_ch == ChannelNum)))
+	{
+		st = &ssp_dma[0];
+	}
+	else if ((ssp_dma[1].dataCfg != NULL) && \
+		((ssp_dma[1].tx_ch == ChannelNum) || (ssp_dma[1].rx_ch == ChannelNum)))
+	{
+		st = &ssp_dma[1];
+	}
+	else
+	{
+		return;
+	}
+
+	if (Status & GPDMA_STAT_ERROR)
+	{
+		GPDMA_ChannelCmd(st->tx_ch, DISABLE);
+		GPDMA_ChannelCmd(st->rx_ch, DISABLE);
+		ssp_dma_finish(st, SSP_STAT_ERROR);
+		return;
+	}
+
+	if (ChannelNum != st->rx_ch)
+	{
+		return;
+	}
+
+	st->dataCfg->tx_cnt = st->done;
+	st->dataCfg->rx_cnt = st->done;
+
+	if (st->done < st->dataCfg->length)
+	{
+		ssp_dma_segment(st);
+	}
+	else
+	{
+		ssp_dma_finish(st, SSP_STAT_DONE);
+	}
+}
+
 /**
  * @}
  */
@@ -289,7 +458,7 @@ void SSP_Init(LPC_SSP_TypeDef *SSPx, SSP_CFG_Type *SSP_ConfigStruct)
 	SSPx->CR1 = tmp;
 
 	// Set clock rate for SSP peripheral
-	setSSPclock(SSPx, SSP_ConfigStruct->ClockRate);
+	SSP_SetClock(SSPx, SSP_ConfigStruct->ClockRate);
 }
 
 /*********************************************************************//**
@@ -474,10 +643,15 @@ uint16_t SSP_ReceiveData(LPC_SSP_TypeDef* SSPx)
  * @param[in]	xfType	Transfer type, should be:
  * 						- SSP_TRANSFER_POLLING: Polling mode
  * 						- SSP_TRANSFER_INTERRUPT: Interrupt mode
+ * 						- SSP_TRANSFER_DMA: GPDMA mode
  * @return 		Actual Data length has been transferred in polling mode.
- * 				In interrupt mode, always return (0)
- * 				Return (-1) if error.
+ * 				In interrupt and DMA mode, always return (0)
+ * 				Return (-1) if error, or while a DMA transfer is still
+ * 				running on SSPx.
  * Note: This function can be used in both master and slave mode.
+ * 		In DMA mode GPDMA_Init() must have been called, dataCfg must stay
+ * 		valid until dataCfg->status reports SSP_STAT_DONE or SSP_STAT_ERROR
+ * 		(see SSP_DMABusy()), and tx_data/rx_data must be DMA accessible.
  ***********************************************************************/
 int32_t SSP_ReadWrite (LPC_SSP_TypeDef *SSPx, SSP_DATA_SETUP_Type *dataCfg, \
 						SSP_TRANSFER_Type xfType)
@@ -489,6 +663,20 @@ int32_t SSP_ReadWrite (LPC_SSP_TypeDef *SSPx, SSP_DATA_SETUP_Type *dataCfg, \
     uint32_t stat;
     uint32_t tmp;
     int32_t dataword;
+    int32_t tx_ch, rx_ch;
+
+	if(SSP_GetDataSize(SSPx)>8)
+		dataword = 1;
+	else dataword = 0;
+
+	/* A GPDMA transfer still owns the FIFO, the counters and the status of
+	 * its own dataCfg, so refuse before touching any of them */
+	if (ssp_dma[(SSPx == LPC_SSP0) ? 0 : 1].dataCfg != NULL){
+		return (-1);
+	}
+	if ((xfType == SSP_TRANSFER_DMA) && (dataCfg->length % (dataword + 1))){
+		return (-1);
+	}
 
     dataCfg->rx_cnt = 0;
     dataCfg->tx_cnt = 0;
@@ -502,9 +690,6 @@ int32_t SSP_ReadWrite (LPC_SSP_TypeDef *SSPx, SSP_DATA_SETUP_Type *dataCfg, \
 
 	// Clear status
 	SSPx->ICR = SSP_ICR_BITMASK;
-	if(SSP_GetDataSize(SSPx)>8)
-		dataword = 1;
-	else dataword = 0;
 
 	// Polling mode ----------------------------------------------------------------------
 	if (xfType == SSP_TRANSFER_POLLING){
@@ -647,6 +832,38 @@ int32_t SSP_ReadWrite (LPC_SSP_TypeDef *SSPx, SSP_DATA_SETUP_Type *dataCfg, \
 		return (0);
 	}
 
+	// DMA mode ----------------------------------------------------------------------
+	else if (xfType == SSP_TRANSFER_DMA){
+		SSP_DMA_STATE_Type *st = &ssp_dma[(SSPx == LPC_SSP0) ? 0 : 1];
+
+		if (dataCfg->length == 0){
+			dataCfg->status = SSP_STAT_DONE;
+			return (0);
+		}
+
+		// RX gets the lower (higher priority) channel to avoid RX overrun
+		rx_ch = GPDMA_AllocChannel();
+		tx_ch = GPDMA_AllocChannel();
+		if ((rx_ch < 0) || (tx_ch < 0)){
+			if (rx_ch >= 0) GPDMA_FreeChannel(rx_ch);
+			if (tx_ch >= 0) GPDMA_FreeChannel(tx_ch);
+			return (-1);
+		}
+		st->rx_ch = (uint32_t)rx_ch;
+		st->tx_ch = (uint32_t)tx_ch;
+		GPDMA_SetCallback(st->rx_ch, ssp_dma_callback);
+		GPDMA_SetCallback(st->tx_ch, ssp_dma_callback);
+
+		st->SSPx = SSPx;
+		st->width = dataword + 1;
+		st->done = 0;
+		st->dataCfg = dataCfg;
+
+		SSPx->DMACR = SSP_DMA_RXDMA_EN | SSP_DMA_TXDMA_EN;
+		ssp_dma_segment(st);
+		return (0);
+	}
+
 	return (-1);
 }
 
@@ -811,6 +1028,21 @@ void SSP_DMACmd(LPC_SSP_TypeDef *SSPx, uint32_t DMAMode, FunctionalState NewStat
 	}
 }
 
+/*********************************************************************//**
+ * @brief		Check whether a SSP_TRANSFER_DMA transfer is still running
+ * @param[in]	SSPx	SSP peripheral selected, should be:
+ *  					- LPC_SSP0: SSP0 peripheral
+ * 						- LPC_SSP1: SSP1 peripheral
+ * @return		SET while the transfer started by SSP_ReadWrite() is in
+ * 				progress, RESET once its status has been updated
+ **********************************************************************/
+FlagStatus SSP_DMABusy(LPC_SSP_TypeDef *SSPx)
+{
+	CHECK_PARAM(PARAM_SSPx(SSPx));
+
+	return ((ssp_dma[(SSPx == LPC_SSP0) ? 0 : 1].dataCfg != NULL) ? SET : RESET);
+}
+
 /**
  * @}
  */
@@ -16,8 +16,32 @@
 
 /* Global Variables------------------------------------------------------------ */
 uint16 EscFlag=0;
-uchar TrgLvlU0=0,TrgLvlU2=0;
-Bool UART0_RxReady=0,UART2_RxReady=0;
+
+#ifdef INTERRUPT_MODE
+/* Private Variables ---------------------------------------------------------- */
+#if (UART0_RING_BUFSIZE & (UART0_RING_BUFSIZE-1)) || (UART1_RING_BUFSIZE & (UART1_RING_BUFSIZE-1)) \
+	|| (UART2_RING_BUFSIZE & (UART2_RING_BUFSIZE-1)) || (UART3_RING_BUFSIZE & (UART3_RING_BUFSIZE-1))
+	#error UART ring buffer sizes must be powers of 2
+#endif
+
+static uint8_t uart0_tx[UART0_RING_BUFSIZE], uart0_rx[UART0_RING_BUFSIZE];
+static uint8_t uart1_tx[UART1_RING_BUFSIZE], uart1_rx[UART1_RING_BUFSIZE];
+static uint8_t uart2_tx[UART2_RING_BUFSIZE], uart2_rx[UART2_RING_BUFSIZE];
+static uint8_t uart3_tx[UART3_RING_BUFSIZE], uart3_rx[UART3_RING_BUFSIZE];
+
+// UART Ring buffers, indexed by UART number
+static UART_PORT_Type uart_port[4] =
+{
+	{ {0, 0, UART0_RING_BUFSIZE-1, uart0_tx}, {0, 0, UART0_RING_BUFSIZE-1, uart0_rx}, RESET },
+	{ {0, 0, UART1_RING_BUFSIZE-1, uart1_tx}, {0, 0, UART1_RING_BUFSIZE-1, uart1_rx}, RESET },
+	{ {0, 0, UART2_RING_BUFSIZE-1, uart2_tx}, {0, 0, UART2_RING_BUFSIZE-1, uart2_rx}, RESET },
+	{ {0, 0, UART3_RING_BUFSIZE-1, uart3_tx}, {0, 0, UART3_RING_BUFSIZE-1, uart3_rx}, RESET },
+};
+
+#ifdef UART_STATS_MODE
+static UART_STATS_Type uart_stats[4];
+#endif
+#endif
 
 /* Private Functions ---------------------------------------------------------- */
 static Status uart_set_divisors(LPC_UART_TypeDef *UARTx, uint32_t baudrate);
@@ -26,24 +50,54 @@ void UART_IntReceive(LPC_UART_TypeDef *UARTx);
 
 #ifdef INTERRUPT_MODE
 /*********************************************************************//**
- * @brief	UART0 interrupt handler sub-routine
- * @param	None
+ * @brief		Get the ring buffers of a UART port
+ * @param[in]	UARTx	UART peripheral selected, should be:
+ *  			- LPC_UART0: UART0 peripheral
+ * 				- LPC_UART1: UART1 peripheral
+ * 				- LPC_UART2: UART2 peripheral
+ * 				- LPC_UART3: UART3 peripheral
+ * @return 		Pointer to the port buffers
+ **********************************************************************/
+static UART_PORT_Type *uart_get_port(LPC_UART_TypeDef *UARTx)
+{
+	if (UARTx == LPC_UART0)
+	{
+		return &uart_port[0];
+	}
+	else if (((LPC_UART1_TypeDef *)UARTx) == LPC_UART1)
+	{
+		return &uart_port[1];
+	}
+	else if (UARTx == LPC_UART2)
+	{
+		return &uart_port[2];
+	}
+	return &uart_port[3];
+}
+
+
+/*********************************************************************//**
+ * @brief	UART interrupt handler sub-routine, common to all ports
+ * @param[in]	UARTx	UART peripheral that raised the interrupt
  * @return	None
  **********************************************************************/
-void UART0_IRQHandler(void)
+static void uart_irq(LPC_UART_TypeDef *UARTx)
 {
-	// Call Standard UART 0 interrupt handler
 	uint32_t intsrc, tmp, tmp1;
+#ifdef UART_STATS_MODE
+	UART_STATS_Type *stats = &uart_stats[uart_get_port(UARTx) - uart_port];
+	uint32_t start = DWT_CYCCNT;
+#endif
 
 	// Determine the interrupt source
-	intsrc = UART_GetIntId(LPC_UART0);
+	intsrc = UART_GetIntId(UARTx);
 	tmp = intsrc & UART_IIR_INTID_MASK;
 
 	// Receive Line Status
 	if (tmp == UART_IIR_INTID_RLS)
 	{
 		// Check line status
-		tmp1 = UART_GetLineStatus(LPC_UART0);
+		tmp1 = UART_GetLineStatus(UARTx);
 		// Mask out the Receive Ready and Transmit Holding empty status
 		tmp1 &= (UART_LSR_OE | UART_LSR_PE | UART_LSR_FE | UART_LSR_BI | UART_LSR_RXFE);
 		// If any error exist
@@ -63,16 +117,16 @@ void UART0_IRQHandler(void)
     {
         // Clear interrupt pending
         if(intsrc & UART_IIR_ABEO_INT)
-            UART_ABClearIntPending(LPC_UART0, UART_AUTOBAUD_INTSTAT_ABEO);
+            UART_ABClearIntPending(UARTx, UART_AUTOBAUD_INTSTAT_ABEO);
         if (intsrc & UART_IIR_ABTO_INT)
-            UART_ABClearIntPending(LPC_UART0, UART_AUTOBAUD_INTSTAT_ABTO);
+            UART_ABClearIntPending(UARTx, UART_AUTOBAUD_INTSTAT_ABTO);
         if (Synchronous == RESET)
         {
             /* Interrupt caused by End of auto-baud */
             if (intsrc & UART_AUTOBAUD_INTSTAT_ABEO)
             {
                 // Disable AB interrupt
-                UART_IntConfig(LPC_UART0, UART_INTCFG_ABEO, DISABLE);
+                UART_IntConfig(UARTx, UART_INTCFG_ABEO, DISABLE);
                 // Set Sync flag
                 Synchronous = SET;
             }
@@ -81,7 +135,7 @@ void UART0_IRQHandler(void)
             if (intsrc & UART_AUTOBAUD_INTSTAT_ABTO)
             {
                 /* Just clear this bit - Add your code here */
-                UART_ABClearIntPending(LPC_UART0, UART_AUTOBAUD_INTSTAT_ABTO);
+                UART_ABClearIntPending(UARTx, UART_AUTOBAUD_INTSTAT_ABTO);
             }
         }
     }
@@ -90,91 +144,64 @@ void UART0_IRQHandler(void)
 	// Receive Data Available or Character time-out
 	if ((tmp == UART_IIR_INTID_RDA) || (tmp == UART_IIR_INTID_CTI))
 	{
-		UART0_RxReady=1;
-		UART_IntReceive(LPC_UART0);
+		UART_IntReceive(UARTx);
 	}
 	// Transmit Holding Empty
 	if (tmp == UART_IIR_INTID_THRE)
 	{
-		UART_IntTransmit(LPC_UART0);
+		UART_IntTransmit(UARTx);
 	}
 
+#ifdef UART_STATS_MODE
+	stats->cycles = DWT_CYCCNT - start;
+	stats->max = MAX(stats->max, stats->cycles);
+	stats->total += stats->cycles;
+	stats->count++;
+#endif
 }
 
 
 /*********************************************************************//**
- * @brief	UART2 interrupt handler sub-routine
+ * @brief	UART0 interrupt handler sub-routine
  * @param	None
  * @return	None
  **********************************************************************/
-void UART2_IRQHandler(void)
+void UART0_IRQHandler(void)
 {
-	// Call Standard UART 2 interrupt handler
-	uint32_t intsrc, tmp, tmp1;
+	uart_irq(LPC_UART0);
+}
 
-	/* Determine the interrupt source */
-	intsrc = UART_GetIntId(LPC_UART2);
-	tmp = intsrc & UART_IIR_INTID_MASK;
 
-	// Receive Line Status
-	if (tmp == UART_IIR_INTID_RLS)
-	{
-		// Check line status
-		tmp1 = UART_GetLineStatus(LPC_UART2);
-		// Mask out the Receive Ready and Transmit Holding empty status
-		tmp1 &= (UART_LSR_OE | UART_LSR_PE | UART_LSR_FE | UART_LSR_BI | UART_LSR_RXFE);
-		// If any error exist
-		if (tmp1)
-		{
-			while(tmp1)
-			{
-				; //implement error handling here
-			}
-		}
-	}
+/*********************************************************************//**
+ * @brief	UART1 interrupt handler sub-routine
+ * @param	None
+ * @return	None
+ **********************************************************************/
+void UART1_IRQHandler(void)
+{
+	uart_irq((LPC_UART_TypeDef *)LPC_UART1);
+}
 
-#ifdef AB_MODE
-    intsrc &= (UART_IIR_ABEO_INT | UART_IIR_ABTO_INT);
-    // Check if End of auto-baudrate interrupt or Auto baudrate time out
-    if (intsrc)
-    {
-        // Clear interrupt pending
-        if(intsrc & UART_IIR_ABEO_INT)
-            UART_ABClearIntPending(LPC_UART2, UART_AUTOBAUD_INTSTAT_ABEO);
-        if (intsrc & UART_IIR_ABTO_INT)
-            UART_ABClearIntPending(LPC_UART2, UART_AUTOBAUD_INTSTAT_ABTO);
-        if (Synchronous == RESET)
-        {
-            /* Interrupt caused by End of auto-baud */
-            if (intsrc & UART_AUTOBAUD_INTSTAT_ABEO)
-            {
-                // Disable AB interrupt
-                UART_IntConfig(LPC_UART2, UART_INTCFG_ABEO, DISABLE);
-                // Set Sync flag
-                Synchronous = SET;
-            }
 
-            /* Auto-Baudrate Time-Out interrupt (not implemented) */
-            if (intsrc & UART_AUTOBAUD_INTSTAT_ABTO)
-            {
-                /* Just clear this bit - Add your code here */
-                UART_ABClearIntPending(LPC_UART2, UART_AUTOBAUD_INTSTAT_ABTO);
-            }
-        }
-    }
-#endif
+/*********************************************************************//**
+ * @brief	UART2 interrupt handler sub-routine
+ * @param	None
+ * @return	None
+ **********************************************************************/
+void UART2_IRQHandler(void)
+{
+	uart_irq(LPC_UART2);
+}
 
-	// Receive Data Available or Character time-out
-	if ((tmp == UART_IIR_INTID_RDA) || (tmp == UART_IIR_INTID_CTI))
-	{
-		UART2_RxReady=1;
-		UART_IntReceive(LPC_UART2);
-	}
-	// Transmit Holding Empty
-	if (tmp == UART_IIR_INTID_THRE)
-	{
-		UART_IntTransmit(LPC_UART2);
-	}
+
+/*********************************************************************//**
+ * @brief	UART3 interrupt handler sub-routine
+ * @param	None
+ * @return	None
+ **********************************************************************/
+void UART3_IRQHandler(void)
+{
+	uart_irq(LPC_UART3);
 }
 
 #endif
@@ -328,6 +355,9 @@ void UART_Config(LPC_UART_TypeDef *UARTx, long int baud)
     // Auto baudrate configuration structure
     UART_AB_CFG_Type ABConfig;
 #endif
+#ifdef INTERRUPT_MODE
+	UART_PORT_Type *port;
+#endif
 
 	// UART Configuration structure variable
 	UART_CFG_Type UARTConfigStruct;
@@ -399,6 +429,21 @@ void UART_Config(LPC_UART_TypeDef *UARTx, long int baud)
 		PINSEL_ConfigPin(&PinCfg);
 	}
 
+	else if(UARTx == LPC_UART3)
+	{
+		/*
+		 * Initialize UART3 pin connect
+		 */
+		PinCfg.Funcnum = 2;
+		PinCfg.OpenDrain = 0;
+		PinCfg.Pinmode = 0;
+		PinCfg.Pinnum = 0;
+		PinCfg.Portnum = 0;
+		PINSEL_ConfigPin(&PinCfg);
+		PinCfg.Pinnum = 1;
+		PINSEL_ConfigPin(&PinCfg);
+	}
+
 	/* Initialize UART Configuration parameter structure to default state:
 	 * Baudrate = 9600bps
 	 * 8 data bit
@@ -442,41 +487,45 @@ void UART_Config(LPC_UART_TypeDef *UARTx, long int baud)
 
 	/**
 	 * Do not enable transmit interrupt here, since it is handled by
-	 * UART_Send() function, just to reset Tx Interrupt state for the
-	 * first time
+	 * UART_Send() function, just to reset Tx Interrupt state and the
+	 * ring buffers for the first time
 	 */
-	TxIntStat = RESET;
-
-	// Reset ring buf head and tail idx
-//	__BUF_RESET(rb.rx_head);
-//	__BUF_RESET(rb.rx_tail);
-//	__BUF_RESET(rb.tx_head);
-//	__BUF_RESET(rb.tx_tail);
+	port = uart_get_port(UARTx);
+	port->TxIntStat = RESET;
+	port->tx.head = port->tx.tail = 0;
+	port->rx.head = port->rx.tail = 0;
+
+#ifdef UART_STATS_MODE
+	// Start the DWT cycle counter used for the interrupt statistics
+	DWT_CycleInit();
+	UART_ResetStats(UARTx);
+#endif
 
 	if(UARTx == LPC_UART0)
 	{
-		// Reset ring buf head and tail idx
-		__BUF_RESET(rb0.rx_head);
-		__BUF_RESET(rb0.rx_tail);
-		__BUF_RESET(rb0.tx_head);
-		__BUF_RESET(rb0.tx_tail);
 		/* preemption = 1, sub-priority = 1 */
 		NVIC_SetPriority(UART0_IRQn, ((0x01<<3)|0x01));
 		/* Enable Interrupt for UART0 channel */
 		NVIC_EnableIRQ(UART0_IRQn);
 	}
+	else if((LPC_UART1_TypeDef *)UARTx == LPC_UART1)
+	{
+		NVIC_SetPriority(UART1_IRQn, 2);
+		/* Enable Interrupt for UART1 channel */
+		NVIC_EnableIRQ(UART1_IRQn);
+	}
 	else if(UARTx == LPC_UART2)
 	{
-		// Reset ring buf head and tail idx
-		__BUF_RESET(rb2.rx_head);
-		__BUF_RESET(rb2.rx_tail);
-		__BUF_RESET(rb2.tx_head);
-		__BUF_RESET(rb2.tx_tail);
-		/* preemption = 1, sub-priority = 1 */
 		NVIC_SetPriority(UART2_IRQn, 2);
 		/* Enable Interrupt for UART2 channel */
 		NVIC_EnableIRQ(UART2_IRQn);
 	}
+	else if(UARTx == LPC_UART3)
+	{
+		NVIC_SetPriority(UART3_IRQn, 2);
+		/* Enable Interrupt for UART3 channel */
+		NVIC_EnableIRQ(UART3_IRQn);
+	}
 
 #ifdef AB_MODE
     /* ---------------------- Auto baud rate section ----------------------- */
@@ -1105,50 +1154,189 @@ uchar get_line(LPC_UART_TypeDef *UARTx, schar s[], uchar lim)
 }
 
 
+/* printf() output accumulator */
+typedef struct
+{
+	LPC_UART_TypeDef *UARTx;
+	uint32_t len;
+	int16 count;
+	uchar buf[UART_PRINTF_BUFSIZE];
+} UART_PRINTF_Type;
+
+/* printf() field flags */
+#define PF_LEFT		((uint8_t)(1<<0))	/* '-' left justify */
+#define PF_ZERO		((uint8_t)(1<<1))	/* '0' pad with zeros */
+#define PF_PLUS		((uint8_t)(1<<2))	/* '+' always print the sign */
+#define PF_LOWER	((uint8_t)(1<<3))	/* lower case hex digits */
+
+static void pf_format(UART_PRINTF_Type *out, const char *format, va_list ap);
+
 /*********************************************************************//**
- * @brief		Modified version of Standard Printf statement
- *
- * @par			Supports standard formats "%c %s %d %x"
- * 				"%d" and "%x" requires non-standard qualifiers,"%dfn, %xfn":-
- *		        f supplies a fill character
- *		        n supplies a field width
- *
- *		        ENABLE RTC_SUPPORT in lpc17xx_uart.h for RTC Features
- *
- *				Supports custom formats  "%b  %u %t %y %a"
- *				"%b"	prints a 2 digit BCD value with leading zero
- *				"%u"	prints the 16 bit unsigned integer in hex format
- *				"%t"    prints current time
- *				"%y"    prints current date
- *				"%a"    prints alarm time and date
- * @param[in]	UARTx	Selected UART peripheral used to send data,
- * 				should be:
- *  			- LPC_UART0: UART0 peripheral
- * 				- LPC_UART1: UART1 peripheral
- * 				- LPC_UART2: UART2 peripheral
- * 				- LPC_UART3: UART3 peripheral
+ * @brief		Queue the accumulated printf() output with one UART_Send()
+ * @param[in]	out		printf() accumulator
+ * @return 		None
+ **********************************************************************/
+static void pf_flush(UART_PRINTF_Type *out)
+{
+	if (out->len)
+	{
+		UART_Send(out->UARTx, out->buf, out->len, BLOCKING);
+		out->len = 0;
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief		Add one character to the printf() output
+ * @param[in]	out		printf() accumulator
+ * @param[in]	c		character
+ * @return 		None
+ **********************************************************************/
+static void pf_putc(UART_PRINTF_Type *out, uchar c)
+{
+	if (out->len == UART_PRINTF_BUFSIZE)
+	{
+		pf_flush(out);
+	}
+	out->buf[out->len++] = c;
+	out->count++;
+}
+
+
+/*********************************************************************//**
+ * @brief		Add n copies of a character to the printf() output
+ * @param[in]	out		printf() accumulator
+ * @param[in]	c		character
+ * @param[in]	n		number of copies, nothing if not positive
+ * @return 		None
+ **********************************************************************/
+static void pf_pad(UART_PRINTF_Type *out, uchar c, int16 n)
+{
+	while (n-- > 0)
+	{
+		pf_putc(out, c);
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief		printf() into the same accumulator, used for the composite
+ * 				RTC formats
+ * @param[in]	out		printf() accumulator
  * @param[in] 	*format Character format
  * @param[in]   ...  <multiple argument>
- *
- * @return 		return with valid character or nothing
+ * @return 		None
  **********************************************************************/
-int16 printf(LPC_UART_TypeDef *UARTx, const char *format, ...)
+static void pf_printf(UART_PRINTF_Type *out, const char *format, ...)
+{
+	va_list ap;
+
+	va_start(ap, format);
+	pf_format(out, format, ap);
+	va_end(ap);
+}
+
+
+/*********************************************************************//**
+ * @brief		Format a number into a field
+ * @param[in]	out		printf() accumulator
+ * @param[in]	val		magnitude
+ * @param[in]	neg		TRUE for a negative value
+ * @param[in]	base	10 or 16
+ * @param[in]	width	minimum field width
+ * @param[in]	flags	PF_LEFT, PF_ZERO, PF_PLUS, PF_LOWER
+ * @param[in]	frac	number of digits after a decimal point (fixed
+ * 						point), 0 for an integer
+ * @return 		None
+ **********************************************************************/
+static void pf_number(UART_PRINTF_Type *out, uint64_t val, Bool neg, uint8_t base, \
+		uint8_t width, uint8_t flags, uint8_t frac)
+{
+	const char *digit = (flags & PF_LOWER) ? "0123456789abcdef" : "0123456789ABCDEF";
+	uchar str[24 + 1];
+	uchar sign = 0;
+	uint32_t v32;
+	int16 n = 0;
+
+	if (neg)
+	{
+		sign = '-';
+	}
+	else if (flags & PF_PLUS)
+	{
+		sign = '+';
+	}
+
+	frac = MIN(frac, 20);
+	do
+	{
+		if (frac && (n == frac))
+		{
+			str[n++] = '.';
+		}
+		if (val >> 32)          // 64-bit division only while it is needed
+		{
+			str[n++] = digit[val % base];
+			val /= base;
+		}
+		else
+		{
+			v32 = (uint32_t)val;
+			str[n++] = digit[v32 % base];
+			val = v32 / base;
+		}
+	} while (val || (n <= frac));
+
+	width -= MIN(width, n + (sign ? 1 : 0));
+
+	if (!(flags & (PF_LEFT | PF_ZERO)))
+	{
+		pf_pad(out, ' ', width);
+	}
+	if (sign)
+	{
+		pf_putc(out, sign);
+	}
+	if (!(flags & PF_LEFT) && (flags & PF_ZERO))
+	{
+		pf_pad(out, '0', width);
+	}
+	while (n)
+	{
+		pf_putc(out, str[--n]);
+	}
+	if (flags & PF_LEFT)
+	{
+		pf_pad(out, ' ', width);
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief		printf() formatting engine, see printf()
+ * @param[in]	out		printf() accumulator
+ * @param[in] 	*format Character format
+ * @param[in]   ap  	argument list
+ * @return 		None
+ **********************************************************************/
+static void pf_format(UART_PRINTF_Type *out, const char *format, va_list ap)
 {
 	uchar hex[]= "0123456789ABCDEF";
 	unsigned int width_dec[10] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000};
 	unsigned int width_hex[10] = { 0x1, 0x10, 0x100, 0x1000, 0x10000, 0x100000, 0x1000000, 0x10000000};
-	unsigned int temp;
 
 	schar format_flag, fill_char;
 	ulong32 u_val, div_val;
 	uint16 base;
+	uint8_t flags, width, prec, lng;
+	int16 len;
+	int64_t s_val;
+	uint64_t val;
 
 	schar *ptr;
 #ifdef RTC_MODE
 	RTC_TIME_Type FullTime;
 #endif
-	va_list ap;
-	va_start(ap, format);
 
 	for(;;)
 	{
@@ -1156,28 +1344,129 @@ int16 printf(LPC_UART_TypeDef *UARTx, const char *format, ...)
 		{
 			if(!format_flag)
 			{                        /* until '%' or '\0' */
-				return (0);
+				return;
+			}
+			pf_putc(out, format_flag);
+		}
+
+		/* Standard field: %[-0+][width][.prec][l|ll] followed by d i u x X q s c */
+		flags = 0;
+		width = 0;
+		prec = 0;
+		lng = 0;
+		for (;; format++)
+		{
+			if (*format == '-')      flags |= PF_LEFT;
+			else if (*format == '0') flags |= PF_ZERO;
+			else if (*format == '+') flags |= PF_PLUS;
+			else break;
+		}
+		while ((*format >= '0') && (*format <= '9'))
+		{
+			width = (width * 10) + (*format++ - '0');
+		}
+		if (*format == '.')
+		{
+			format++;
+			while ((*format >= '0') && (*format <= '9'))
+			{
+				prec = (prec * 10) + (*format++ - '0');
+			}
+		}
+		while (*format == 'l')
+		{
+			lng++;
+			format++;
+		}
+
+		if (flags || width || prec || lng || (*format == 'i') || (*format == 'q') || (*format == 'X'))
+		{
+			switch(format_flag = *format++)
+			{
+				case 'd':
+				case 'i':
+				case 'q':
+					if (lng > 1)
+						s_val = va_arg(ap, long long);
+					else
+						s_val = lng ? va_arg(ap, long) : va_arg(ap, int);
+					val = (s_val < 0) ? (0 - (uint64_t)s_val) : (uint64_t)s_val;
+					pf_number(out, val, (s_val < 0), 10, width, flags, (format_flag == 'q') ? prec : 0);
+					continue;
+
+				case 'u':
+				case 'x':
+				case 'X':
+					if (lng > 1)
+						val = va_arg(ap, unsigned long long);
+					else
+						val = lng ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+					if (format_flag == 'x')
+					{
+						flags |= PF_LOWER;
+					}
+					pf_number(out, val, FALSE, (format_flag == 'u') ? 10 : 16, width, flags & ~PF_PLUS, 0);
+					continue;
+
+				case 's':
+					ptr = va_arg(ap, schar *);
+					for (len = 0; ptr[len]; len++);
+					if (!(flags & PF_LEFT))
+					{
+						pf_pad(out, ' ', (int16)width - len);
+					}
+					while(*ptr)
+					{
+						pf_putc(out, *ptr++);
+					}
+					if (flags & PF_LEFT)
+					{
+						pf_pad(out, ' ', (int16)width - len);
+					}
+					continue;
+
+				case 'c':
+					if (!(flags & PF_LEFT))
+					{
+						pf_pad(out, ' ', (int16)width - 1);
+					}
+					pf_putc(out, va_arg(ap, int));
+					if (flags & PF_LEFT)
+					{
+						pf_pad(out, ' ', (int16)width - 1);
+					}
+					continue;
+
+				default:
+					if(!format_flag)
+					{
+						return;
+					}
+					pf_putc(out, format_flag);
+					continue;
 			}
-			UART_Send(UARTx,&format_flag,1,BLOCKING);
 		}
 
 		switch(format_flag = *format++)
 		{
+			case '\0':
+				return;
+
 			case 'c':
 				format_flag = va_arg(ap, int);
-				UART_Send(UARTx,&format_flag,1,BLOCKING);
+				pf_putc(out, format_flag);
 
 				continue;
 
 			default:
-				UART_Send(UARTx,&format_flag,1,BLOCKING);
+				pf_putc(out, format_flag);
 
         		continue;
 
 			case 'b':
 				format_flag = va_arg(ap,int);
-				UART_Send(UARTx,&(hex[(uint16)format_flag >> 4]),1,BLOCKING);
-				UART_Send(UARTx,&(hex[(uint16)format_flag & 0x0F]),1,BLOCKING);
+				pf_putc(out, hex[(uint16)format_flag >> 4]);
+				pf_putc(out, hex[(uint16)format_flag & 0x0F]);
 
 				continue;
 
@@ -1185,27 +1474,27 @@ int16 printf(LPC_UART_TypeDef *UARTx, const char *format, ...)
 				ptr = va_arg(ap, schar *);
 				while(*ptr)
 				{
-					UART_Send(UARTx,&(*ptr++),1,BLOCKING);
+					pf_putc(out, *ptr++);
 				}
 
 				continue;
 #ifdef RTC_MODE
 			case 't':
 				RTC_GetFullTime (LPC_RTC, &FullTime);
-			    printf(UARTx, "%d02:%d02:%d02",FullTime.HOUR,FullTime.MIN,FullTime.SEC);
+			    pf_printf(out, "%d02:%d02:%d02",FullTime.HOUR,FullTime.MIN,FullTime.SEC);
 
 				continue;
 
 			case 'y':
 				RTC_GetFullTime (LPC_RTC, &FullTime);
-			    printf(UARTx, "%d02/%d02/%d04",FullTime.DOM,FullTime.MONTH,FullTime.YEAR);
+			    pf_printf(out, "%d02/%d02/%d04",FullTime.DOM,FullTime.MONTH,FullTime.YEAR);
 
 				continue;
 
 			case 'a':
 				RTC_GetFullAlarmTime (LPC_RTC, &FullTime);
-				printf(UARTx, "Time: %d02:%d02:%d02",FullTime.HOUR,FullTime.MIN,FullTime.SEC);
-				printf(UARTx, "  Date: %d02/%d02/%d04",FullTime.DOM,FullTime.MONTH,FullTime.YEAR);
+				pf_printf(out, "Time: %d02:%d02:%d02",FullTime.HOUR,FullTime.MIN,FullTime.SEC);
+				pf_printf(out, "  Date: %d02/%d02/%d04",FullTime.DOM,FullTime.MONTH,FullTime.YEAR);
 
 				continue;
 #endif
@@ -1215,7 +1504,7 @@ int16 printf(LPC_UART_TypeDef *UARTx, const char *format, ...)
 				u_val = va_arg(ap, uint32_t);
 				do
 				{
-					UART_Send(UARTx,&(hex[u_val/div_val]),1,BLOCKING);
+					pf_putc(out, hex[u_val/div_val]);
 					u_val %= div_val;
 					div_val /= base;
 				}while(div_val);
@@ -1232,8 +1521,7 @@ int16 printf(LPC_UART_TypeDef *UARTx, const char *format, ...)
 				if(((int)u_val) < 0)
 				{
 					u_val = - u_val;    /* applied to unsigned type, result still unsigned */
-					temp = '-';
-				    UART_Send(UARTx,&temp,1,BLOCKING);
+					pf_putc(out, '-');
 				}
 
 				goto  CONVERSION_LOOP;
@@ -1249,18 +1537,74 @@ int16 printf(LPC_UART_TypeDef *UARTx, const char *format, ...)
 				while(div_val > 1 && div_val > u_val)
 				{
 					div_val /= base;
-					UART_Send(UARTx,&fill_char,1,BLOCKING);
+					pf_putc(out, fill_char);
 				}
 
 				do
 				{
-					UART_Send(UARTx,&(hex[u_val/div_val]),1,BLOCKING);
+					pf_putc(out, hex[u_val/div_val]);
 					u_val %= div_val;
 					div_val /= base;
 				}while(div_val);
 		}/* end of switch statement */
 	}
-	return(0);
+}
+
+
+/*********************************************************************//**
+ * @brief		Modified version of Standard Printf statement. The output
+ * 				is rendered into a UART_PRINTF_BUFSIZE stack buffer and
+ * 				queued with one UART_Send() per buffer
+ *
+ * @par			Supports standard formats "%c %s %d %x"
+ * 				"%d" and "%x" requires non-standard qualifiers,"%dfn, %xfn":-
+ *		        f supplies a fill character
+ *		        n supplies a field width
+ *
+ * @par			Standard fields "%[-0+][width][.prec][l|ll]conv" where conv is
+ * 				"d i u x X q s c", e.g. "%-8s %+6i %08lX %llu"
+ * 				"-" left justifies, "0" pads with zeros, "+" forces the sign
+ * 				"ll" takes a 64-bit argument, 32-bit otherwise
+ * 				"%.nq"  prints a signed fixed point value scaled by 10^n,
+ * 						e.g. "%.2q" of 12345 prints 123.45
+ * 				"%i", "%q" and "%X" are always standard, "%d", "%x", "%u"
+ * 				keep the formats below unless a flag, width, precision or
+ * 				length is given
+ *
+ *		        ENABLE RTC_SUPPORT in lpc17xx_uart.h for RTC Features
+ *
+ *				Supports custom formats  "%b  %u %t %y %a"
+ *				"%b"	prints a 2 digit BCD value with leading zero
+ *				"%u"	prints the 16 bit unsigned integer in hex format
+ *				"%t"    prints current time
+ *				"%y"    prints current date
+ *				"%a"    prints alarm time and date
+ * @param[in]	UARTx	Selected UART peripheral used to send data,
+ * 				should be:
+ *  			- LPC_UART0: UART0 peripheral
+ * 				- LPC_UART1: UART1 peripheral
+ * 				- LPC_UART2: UART2 peripheral
+ * 				- LPC_UART3: UART3 peripheral
+ * @param[in] 	*format Character format
+ * @param[in]   ...  <multiple argument>
+ *
+ * @return 		Number of characters printed
+ **********************************************************************/
+int16 printf(LPC_UART_TypeDef *UARTx, const char *format, ...)
+{
+	UART_PRINTF_Type out;
+	va_list ap;
+
+	out.UARTx = UARTx;
+	out.len = 0;
+	out.count = 0;
+
+	va_start(ap, format);
+	pf_format(&out, format, ap);
+	va_end(ap);
+
+	pf_flush(&out);
+	return(out.count);
 }
 
 
@@ -1465,32 +1809,16 @@ void UART_FIFOConfig(LPC_UART_TypeDef *UARTx, UART_FIFO_CFG_Type *FIFOCfg)
 	switch (FIFOCfg->FIFO_Level){
 	case UART_FIFO_TRGLEV0:
 		tmp |= UART_FCR_TRG_LEV0;
-		if(UARTx==LPC_UART0)
-			TrgLvlU0=1;
-		else if(UARTx==LPC_UART2)
-			TrgLvlU2=1;
 		break;
 	case UART_FIFO_TRGLEV1:
 		tmp |= UART_FCR_TRG_LEV1;
-		if(UARTx==LPC_UART0)
-			TrgLvlU0=4;
-		else if(UARTx==LPC_UART2)
-			TrgLvlU2=4;
 		break;
 	case UART_FIFO_TRGLEV2:
 		tmp |= UART_FCR_TRG_LEV2;
-		if(UARTx==LPC_UART0)
-			TrgLvlU0=8;
-		else if(UARTx==LPC_UART2)
-			TrgLvlU2=8;
 		break;
 	case UART_FIFO_TRGLEV3:
 	default:
 		tmp |= UART_FCR_TRG_LEV3;
-		if(UARTx==LPC_UART0)
-			TrgLvlU0=14;
-		else if(UARTx==LPC_UART2)
-			TrgLvlU2=14;
 		break;
 	}
 
@@ -2013,212 +2341,234 @@ uint32_t UART_RS485SendData(LPC_UART1_TypeDef *UARTx, uint8_t *pData, uint32_t s
 #ifdef INTERRUPT_MODE
 
 /********************************************************************//**
- * @brief 		UART0 receive function (ring buffer used)
- * @param[in]	None
+ * @brief 		UART receive function (ring buffer used), called from the
+ * 				UART interrupt as the only producer of the RX ring
+ * @param[in]	UARTx	UART peripheral that raised the interrupt
  * @return 		None
  *********************************************************************/
 void UART_IntReceive(LPC_UART_TypeDef *UARTx)
 {
-	uint8_t tmpc=0;
+	UART_RING_Type *rx = &uart_get_port(UARTx)->rx;
+	uint32_t head = rx->head;
+	uint8_t tmpc;
 
-	if(UARTx==LPC_UART0)
+	while (UARTx->LSR & UART_LSR_RDR)
 	{
-		while(1)
-		{
-			// Call UART read function in UART driver
-			tmpc = UART_ReceiveByte(LPC_UART0);
-
-			if (tmpc)
-			{
-				/* Check if buffer is more space
-				 * If no more space, remaining character will be trimmed out
-				 */
-				if (!__BUF_IS_FULL(rb0.rx_head,rb0.rx_tail))
-				{
-					rb0.rx[rb0.rx_head] = tmpc;
-					__BUF_INCR(rb0.rx_head);
-				}
-			}
-			// no more data
-			else
-			{
-				break;
-			}
-		}
-	}
+		// Call UART read function in UART driver
+		tmpc = UART_ReceiveByte(UARTx);
 
-	if(UARTx==LPC_UART2)
-	{
-		while(1)
+		/* Check if buffer is more space
+		 * If no more space, remaining character will be trimmed out
+		 */
+		if ((head - rx->tail) <= rx->mask)
 		{
-			// Call UART read function in UART driver
-
-			tmpc = UART_ReceiveByte(LPC_UART2);
-
-			if (tmpc)
-			{
-				/* Check if buffer is more space
-				 * If no more space, remaining character will be trimmed out
-				 */
-				if (!__BUF_IS_FULL(rb2.rx_head,rb2.rx_tail))
-				{
-					rb2.rx[rb2.rx_head] = tmpc;
-					__BUF_INCR(rb2.rx_head);
-				}
-			}
-			// no more data
-			else
-			{
-				break;
-			}
+			rx->buf[head & rx->mask] = tmpc;
+			head++;
 		}
 	}
+	// Publish the new bytes, the data stores are volatile and come first
+	rx->head = head;
 }
 
 
 /********************************************************************//**
- * @brief 		UART transmit function (ring buffer used)
- * @param[in]	None
+ * @brief 		UART transmit function (ring buffer used). It is the only
+ * 				consumer of the TX ring: called from the THRE interrupt, or
+ * 				by UART_TxCommit() while the THRE interrupt is disabled.
+ * 				An empty TX FIFO is loaded with up to UART_TX_FIFO_SIZE
+ * 				bytes at once; a FIFO that is still draining is left to
+ * 				the THRE interrupt, so nothing waits here
+ * @param[in]	UARTx	UART peripheral selected
  * @return 		None
  *********************************************************************/
 void UART_IntTransmit(LPC_UART_TypeDef *UARTx)
 {
-	uint32_t bToSend, bSent, timeOut, fifo_cnt;
-	uint8_t *pChar;
+	UART_PORT_Type *port = uart_get_port(UARTx);
+	UART_RING_Type *tx = &port->tx;
+	uint32_t tail = tx->tail, fifo_cnt;
 
-	if(UARTx==LPC_UART0)
+	if (UARTx->LSR & UART_LSR_THRE)
 	{
-		// Disable THRE interrupt
-		UART_IntConfig(UARTx, UART_INTCFG_THRE, DISABLE);
-
-		/* Wait for FIFO buffer empty, transfer UART_TX_FIFO_SIZE bytes
-		 * of data or break whenever ring buffers are empty */
-		/* Wait until THR empty */
-		while (UART_CheckBusy(UARTx) == SET);
-
-		while (!__BUF_IS_EMPTY(rb0.tx_head,rb0.tx_tail))
-		{
-			/* Move a piece of data into the transmit FIFO */
-			// None blocking mode
-			pChar = &rb0.tx[rb0.tx_tail];
-			bToSend = 1;
-			bSent = 0;
-			while (bToSend)
-			{
-				timeOut = UART_BLOCKING_TIMEOUT;
-				// Wait for THR empty with timeout
-				while (!(UARTx->LSR & UART_LSR_THRE))
-				{
-					if (timeOut == 0) break;
-					timeOut--;
-				}
-				// Time out!
-				if(timeOut == 0) break;
-				fifo_cnt = UART_TX_FIFO_SIZE;
-				while (fifo_cnt && bToSend)
-				{
-					UART_SendByte(UARTx, (*pChar++));
-					fifo_cnt--;
-					bToSend--;
-					bSent++;
-				}
-			}
-
-			if(bSent)
-			{
-				/* Update transmit ring FIFO tail pointer */
-				__BUF_INCR(rb0.tx_tail);
-			}
-			else
-			{
-				break;
-			}
-		}
-
-		/* If there is no more data to send, disable the transmit
-		   interrupt - else enable it or keep it enabled */
-		if (__BUF_IS_EMPTY(rb0.tx_head, rb0.tx_tail))
-		{
-			UART_IntConfig(UARTx, UART_INTCFG_THRE, DISABLE);
-			// Reset Tx Interrupt state
-			TxIntStat = RESET;
-		}
-		else
+		fifo_cnt = MIN(tx->head - tail, UART_TX_FIFO_SIZE);
+#ifdef UART_STATS_MODE
+		uart_stats[port - uart_port].tx_bytes += fifo_cnt;
+#endif
+		while (fifo_cnt--)
 		{
-			// Set Tx Interrupt state
-			TxIntStat = SET;
-			UART_IntConfig(UARTx, UART_INTCFG_THRE, ENABLE);
+			UARTx->THR = tx->buf[tail & tx->mask];
+			tail++;
 		}
+		/* Update transmit ring FIFO tail pointer */
+		tx->tail = tail;
 	}
 
-	if(UARTx==LPC_UART2)
+	/* If there is no more data to send, disable the transmit
+	   interrupt - else enable it or keep it enabled */
+	if (tail == tx->head)
 	{
-		// Disable THRE interrupt
 		UART_IntConfig(UARTx, UART_INTCFG_THRE, DISABLE);
+		// Reset Tx Interrupt state
+		port->TxIntStat = RESET;
+	}
+	else
+	{
+		// Set Tx Interrupt state
+		port->TxIntStat = SET;
+		UART_IntConfig(UARTx, UART_INTCFG_THRE, ENABLE);
+	}
+}
 
-		/* Wait for FIFO buffer empty, transfer UART_TX_FIFO_SIZE bytes
-		 * of data or break whenever ring buffers are empty */
-		/* Wait until THR empty */
-		while (UART_CheckBusy(UARTx) == SET);
 
-		while (!__BUF_IS_EMPTY(rb2.tx_head,rb2.tx_tail))
-		{
-			/* Move a piece of data into the transmit FIFO */
-			// None blocking mode
-			pChar = &rb2.tx[rb2.tx_tail];
-			bToSend = 1;
-			bSent = 0;
-			while (bToSend)
-			{
-				timeOut = UART_BLOCKING_TIMEOUT;
-				// Wait for THR empty with timeout
-				while (!(UARTx->LSR & UART_LSR_THRE))
-				{
-					if (timeOut == 0) break;
-					timeOut--;
-				}
-				// Time out!
-				if(timeOut == 0) break;
-				fifo_cnt = UART_TX_FIFO_SIZE;
-				while (fifo_cnt && bToSend)
-				{
-					UART_SendByte(UARTx, (*pChar++));
-					fifo_cnt--;
-					bToSend--;
-					bSent++;
-				}
-			}
+/*********************************************************************//**
+ * @brief		Get the free space at the head of the transmit ring, so
+ * 				data can be written in place and queued with UART_TxCommit()
+ * @param[in]	UARTx	Selected UART peripheral, should be:
+ *   			- LPC_UART0: UART0 peripheral
+ * 				- LPC_UART1: UART1 peripheral
+ * 				- LPC_UART2: UART2 peripheral
+ * 				- LPC_UART3: UART3 peripheral
+ * @param[out]	buf 	Set to the first free byte
+ * @return 		Number of contiguous free bytes at buf (up to the wrap)
+ **********************************************************************/
+uint32_t UART_TxPeek(LPC_UART_TypeDef *UARTx, uint8_t **buf)
+{
+	UART_RING_Type *tx;
+	uint32_t head, idx, space;
 
-			if(bSent)
-			{
-				/* Update transmit ring FIFO tail pointer */
-				__BUF_INCR(rb2.tx_tail);
-			}
-			else
-			{
-				break;
-			}
-		}
+	CHECK_PARAM(PARAM_UARTx(UARTx));
 
-		/* If there is no more data to send, disable the transmit
-		   interrupt - else enable it or keep it enabled */
-		if (__BUF_IS_EMPTY(rb2.tx_head, rb2.tx_tail))
-		{
-			UART_IntConfig(UARTx, UART_INTCFG_THRE, DISABLE);
-			// Reset Tx Interrupt state
-			TxIntStat = RESET;
-		}
-		else
-		{
-			// Set Tx Interrupt state
-			TxIntStat = SET;
-			UART_IntConfig(UARTx, UART_INTCFG_THRE, ENABLE);
-		}
+	tx = &uart_get_port(UARTx)->tx;
+	head = tx->head;
+	idx = head & tx->mask;
+	space = tx->mask + 1 - (head - tx->tail);
+
+	*buf = (uint8_t *)&tx->buf[idx];
+	return MIN(space, tx->mask + 1 - idx);
+}
+
+
+/*********************************************************************//**
+ * @brief		Queue bytes written at the pointer given by UART_TxPeek()
+ * 				and start the transmitter if it is idle
+ * @param[in]	UARTx	Selected UART peripheral, should be:
+ *   			- LPC_UART0: UART0 peripheral
+ * 				- LPC_UART1: UART1 peripheral
+ * 				- LPC_UART2: UART2 peripheral
+ * 				- LPC_UART3: UART3 peripheral
+ * @param[in]	len 	Number of bytes written, at most the peeked length
+ * @return 		None
+ **********************************************************************/
+void UART_TxCommit(LPC_UART_TypeDef *UARTx, uint32_t len)
+{
+	UART_PORT_Type *port;
+
+	CHECK_PARAM(PARAM_UARTx(UARTx));
+
+	port = uart_get_port(UARTx);
+	port->tx.head += len;
+
+	/**
+	 * If the Tx interrupt is idle it will not fire for the new data,
+	 * UART_IntTransmit() primes the FIFO and re-arms it. Otherwise the
+	 * running interrupt picks up the new head by itself
+	 */
+	if (port->TxIntStat == RESET)
+	{
+		UART_IntTransmit(UARTx);
 	}
+}
+
+
+/*********************************************************************//**
+ * @brief		Get the received data at the tail of the receive ring, so
+ * 				it can be parsed in place and released with UART_RxCommit()
+ * @param[in]	UARTx	Selected UART peripheral, should be:
+ *   			- LPC_UART0: UART0 peripheral
+ * 				- LPC_UART1: UART1 peripheral
+ * 				- LPC_UART2: UART2 peripheral
+ * 				- LPC_UART3: UART3 peripheral
+ * @param[out]	buf 	Set to the oldest received byte
+ * @return 		Number of contiguous received bytes at buf (up to the wrap)
+ **********************************************************************/
+uint32_t UART_RxPeek(LPC_UART_TypeDef *UARTx, uint8_t **buf)
+{
+	UART_RING_Type *rx;
+	uint32_t tail, idx, count;
+
+	CHECK_PARAM(PARAM_UARTx(UARTx));
 
+	rx = &uart_get_port(UARTx)->rx;
+	tail = rx->tail;
+	idx = tail & rx->mask;
+	count = rx->head - tail;
+
+	*buf = (uint8_t *)&rx->buf[idx];
+	return MIN(count, rx->mask + 1 - idx);
+}
+
+
+/*********************************************************************//**
+ * @brief		Release bytes obtained with UART_RxPeek()
+ * @param[in]	UARTx	Selected UART peripheral, should be:
+ *   			- LPC_UART0: UART0 peripheral
+ * 				- LPC_UART1: UART1 peripheral
+ * 				- LPC_UART2: UART2 peripheral
+ * 				- LPC_UART3: UART3 peripheral
+ * @param[in]	len 	Number of bytes consumed, at most the peeked length
+ * @return 		None
+ **********************************************************************/
+void UART_RxCommit(LPC_UART_TypeDef *UARTx, uint32_t len)
+{
+	CHECK_PARAM(PARAM_UARTx(UARTx));
+
+	uart_get_port(UARTx)->rx.tail += len;
 }
 
 
+#ifdef UART_STATS_MODE
+/*********************************************************************//**
+ * @brief		Read the interrupt statistics of a UART port
+ * @param[in]	UARTx	Selected UART peripheral, should be:
+ *   			- LPC_UART0: UART0 peripheral
+ * 				- LPC_UART1: UART1 peripheral
+ * 				- LPC_UART2: UART2 peripheral
+ * 				- LPC_UART3: UART3 peripheral
+ * @param[out]	stats 	Filled with a copy of the counters
+ * @return 		None
+ **********************************************************************/
+void UART_GetStats(LPC_UART_TypeDef *UARTx, UART_STATS_Type *stats)
+{
+	CHECK_PARAM(PARAM_UARTx(UARTx));
+
+	*stats = uart_stats[uart_get_port(UARTx) - uart_port];
+}
+
+
+/*********************************************************************//**
+ * @brief		Clear the interrupt statistics of a UART port
+ * @param[in]	UARTx	Selected UART peripheral, should be:
+ *   			- LPC_UART0: UART0 peripheral
+ * 				- LPC_UART1: UART1 peripheral
+ * 				- LPC_UART2: UART2 peripheral
+ * 				- LPC_UART3: UART3 peripheral
+ * @return 		None
+ **********************************************************************/
+void UART_ResetStats(LPC_UART_TypeDef *UARTx)
+{
+	UART_STATS_Type *stats;
+
+	CHECK_PARAM(PARAM_UARTx(UARTx));
+
+	stats = &uart_stats[uart_get_port(UARTx) - uart_port];
+	stats->count = 0;
+	stats->cycles = 0;
+	stats->max = 0;
+	stats->total = 0;
+	stats->tx_bytes = 0;
+}
+#endif
+
+
 /*********************************************************************//**
  * @brief		Send a block of data via UART peripheral
  * @param[in]	UARTx	Selected UART peripheral used to send data, should be:
@@ -2229,85 +2579,40 @@ void UART_IntTransmit(LPC_UART_TypeDef *UARTx)
  * @param[in]	txbuf 	Pointer to Transmit buffer
  * @param[in]	buflen 	Length of Transmit buffer
  * @param[in] 	flag 	Flag used in  UART transfer, should be
- * 						NONE_BLOCKING or BLOCKING
- * @return 		Number of bytes sent.
+ * 						NONE_BLOCKING, BLOCKING or TIME_BLOCKING
+ * @return 		Number of bytes queued. NONE_BLOCKING stops when the ring
+ * 				is full, the blocking modes wait for the ring to drain
  *
- * Note: when using UART in BLOCKING mode, a time-out condition is used
+ * Note: when using UART in TIME_BLOCKING mode, a time-out condition is used
  * via defined symbol UART_BLOCKING_TIMEOUT.
  **********************************************************************/
 uint32_t UART_Send(LPC_UART_TypeDef *UARTx, uint8_t *txbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag)
 {
-	uint8_t *data = (uint8_t *) txbuf;
-	uint32_t bytes = 0;
+	uint8_t *data = txbuf, *ptr;
+	uint32_t bytes = 0, n, i, timeOut = UART_BLOCKING_TIMEOUT;
 
-	if(UARTx==LPC_UART0)
+	while (buflen > 0)
 	{
-
-		/* Temporarily lock out UART transmit interrupts during this
-		   read so the UART transmit interrupt won't cause problems
-		   with the index values */
-		UART_IntConfig(UARTx, UART_INTCFG_THRE, DISABLE);
-
-		/* Loop until transmit run buffer is full or until n_bytes
-		   expires */
-		while ((buflen > 0) && (!__BUF_IS_FULL(rb0.tx_head, rb0.tx_tail)))
+		n = MIN(UART_TxPeek(UARTx, &ptr), buflen);
+		if (n == 0)
 		{
-			/* Write data from buffer into ring buffer */
-			rb0.tx[rb0.tx_head] = *data;
-			data++;
-
-			/* Increment head pointer */
-			__BUF_INCR(rb0.tx_head);
-
-			/* Increment data count and decrement buffer size count */
-			bytes++;
-			buflen--;
+			if ((flag == NONE_BLOCKING) || ((flag == TIME_BLOCKING) && (timeOut-- == 0)))
+			{
+				break;
+			}
+			continue;               // THRE interrupt is draining the ring
 		}
 
-	}
-
-	if(UARTx==LPC_UART2)
-	{
-		/* Temporarily lock out UART transmit interrupts during this
-		   read so the UART transmit interrupt won't cause problems
-		   with the index values */
-		UART_IntConfig(UARTx, UART_INTCFG_THRE, DISABLE);
-
-		/* Loop until transmit run buffer is full or until n_bytes
-		   expires */
-		while ((buflen > 0) && (!__BUF_IS_FULL(rb2.tx_head, rb2.tx_tail)))
+		/* Write data from buffer into ring buffer */
+		for (i = 0; i < n; i++)
 		{
-			/* Write data from buffer into ring buffer */
-			rb2.tx[rb2.tx_head] = *data;
-			data++;
-
-			/* Increment head pointer */
-			__BUF_INCR(rb2.tx_head);
-
-			/* Increment data count and decrement buffer size count */
-			bytes++;
-			buflen--;
+			ptr[i] = *data++;
 		}
-	}
-
-	/**
-	 * Check if current Tx interrupt enable is reset,
-	 * that means the Tx interrupt must be re-enabled
-	 * due to call UART_IntTransmit() function to trigger
-	 * this interrupt type
-	 */
-
+		UART_TxCommit(UARTx, n);
 
-	if (TxIntStat == RESET)
-	{
-		UART_IntTransmit(UARTx);
-	}
-	/**
-	 * Otherwise, re-enables Tx Interrupt
-	 */
-	else
-	{
-		UART_IntConfig(UARTx, UART_INTCFG_THRE, ENABLE);
+		/* Increment data count and decrement buffer size count */
+		bytes += n;
+		buflen -= n;
 	}
 
 	return bytes;
@@ -2323,144 +2628,42 @@ uint32_t UART_Send(LPC_UART_TypeDef *UARTx, uint8_t *txbuf, uint32_t buflen, TRA
  * 				- LPC_UART3: UART3 peripheral
  * @param[out]	rxbuf 	Pointer to Received buffer
  * @param[in]	buflen 	Length of Received buffer
- * @param[in] 	flag 	Flag mode, should be NONE_BLOCKING or BLOCKING
+ * @param[in] 	flag 	Flag mode, should be NONE_BLOCKING, BLOCKING or
+ * 						TIME_BLOCKING
 
- * @return 		Number of bytes received
+ * @return 		Number of bytes received. NONE_BLOCKING returns what is in
+ * 				the ring, the blocking modes wait for buflen bytes
  *
- * Note: when using UART in BLOCKING mode, a time-out condition is used
+ * Note: when using UART in TIME_BLOCKING mode, a time-out condition is used
  * via defined symbol UART_BLOCKING_TIMEOUT.
  **********************************************************************/
 uint32_t UART_Receive(LPC_UART_TypeDef *UARTx, uint8_t *rxbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag)
 {
-	uint8_t *data = (uint8_t *) rxbuf,ind=0;
-	uint32_t bytes = 0,time=0;
-	if(UARTx==LPC_UART0)
-	{
-		ind=buflen/TrgLvlU0;
-		if((buflen%TrgLvlU0!=0) && (buflen>8))
-			ind++;
-		else if((buflen%TrgLvlU0!=0) && (buflen<8))
-			ind++;
+	uint8_t *data = rxbuf, *ptr;
+	uint32_t bytes = 0, n, i, timeOut = UART_BLOCKING_TIMEOUT;
 
-		if(flag==TIME_BLOCKING)
-		{
-			time=UART_BLOCKING_TIMEOUT;
-			while((time!=0))
-			{
-				time--;
-				if(UART0_RxReady==1)
-				{
-					ind--;
-					UART0_RxReady=0;
-				}
-				if(ind==0)
-					break;
-			}
-		}
-		else if(flag==BLOCKING)
-		{
-			while(1)
-			{
-				while(UART0_RxReady!=1);
-				ind--;
-				UART0_RxReady=0;
-				if(ind==0)
-					break;
-			}
-		}
-		else if(flag==NONE_BLOCKING)
-		{
-			UART0_RxReady=0;
-		}
-		/* Temporarily lock out UART receive interrupts during this
-		   read so the UART receive interrupt won't cause problems
-		   with the index values */
-		UART_IntConfig(UARTx, UART_INTCFG_RBR, DISABLE);
-		/* Loop until receive buffer ring is empty or
-			until max_bytes expires */
-
-		while ((buflen > 0) && (!(__BUF_IS_EMPTY(rb0.rx_head, rb0.rx_tail))))
-		{
-			/* Read data from ring buffer into user buffer */
-			*data = rb0.rx[rb0.rx_tail];
-			data++;
-
-			/* Update tail pointer */
-			__BUF_INCR(rb0.rx_tail);
-
-			/* Increment data count and decrement buffer size count */
-			bytes++;
-			buflen--;
-		}
-
-		/* Re-enable UART interrupts */
-		UART_IntConfig(UARTx, UART_INTCFG_RBR, ENABLE);
-	}
-
-	if((UARTx==LPC_UART2))
+	while (buflen > 0)
 	{
-		ind=buflen/TrgLvlU2;
-
-		if((buflen%TrgLvlU2!=0) && (buflen>8))
-			ind++;
-		else if((buflen%TrgLvlU2!=0) && (buflen<8))
-			ind++;
-
-		if(flag==TIME_BLOCKING)
+		n = MIN(UART_RxPeek(UARTx, &ptr), buflen);
+		if (n == 0)
 		{
-			time=UART_BLOCKING_TIMEOUT;
-			while((time!=0))
+			if ((flag == NONE_BLOCKING) || ((flag == TIME_BLOCKING) && (timeOut-- == 0)))
 			{
-				time--;
-				if(UART2_RxReady==1)
-				{
-					ind--;
-					UART2_RxReady=0;
-				}
-				if(ind==0)
-					break;
-			}
-		}
-		else if(flag==BLOCKING)
-		{
-			while(1)
-			{
-				while(UART2_RxReady!=1);
-				ind--;
-				UART2_RxReady=0;
-				if(ind==0)
-					break;
+				break;
 			}
-		}
-		else if(flag==NONE_BLOCKING)
-		{
-			UART2_RxReady=0;
+			continue;               // wait for the receive interrupt
 		}
 
-		/* Temporarily lock out UART receive interrupts during this
-		   read so the UART receive interrupt won't cause problems
-		   with the index values */
-
-		UART_IntConfig(UARTx, UART_INTCFG_RBR, DISABLE);
-		/* Loop until receive buffer ring is empty or
-			until max_bytes expires */
-		while ((buflen > 0) && (!(__BUF_IS_EMPTY(rb2.rx_head, rb2.rx_tail))))
+		/* Read data from ring buffer into user buffer */
+		for (i = 0; i < n; i++)
 		{
-			/* Read data from ring buffer into user buffer */
-			*data = rb2.rx[rb2.rx_tail];
-			data++;
-
-			/* Update tail pointer */
-			__BUF_INCR(rb2.rx_tail);
-
-			/* Increment data count and decrement buffer size count */
-			bytes++;
-			buflen--;
+			*data++ = ptr[i];
 		}
+		UART_RxCommit(UARTx, n);
 
-		/* Re-enable UART interrupts */
-		UART_IntConfig(UARTx, UART_INTCFG_RBR, ENABLE);
-		UART2_RxReady=0;
+		/* Increment data count and decrement buffer size count */
+		bytes += n;
+		buflen -= n;
 	}
 
     return bytes;
@@ -0,0 +1,283 @@
+/******************************************************************//**
+* @file		lpc_config.c
+* @brief	Contains the persisted system configuration, double
+*           buffered in EEPROM and mirrored in the RTC registers
+* @version	1.0
+* @date		19. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup CONFIG
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc_config.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc_crc32.h"
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+
+/* Record of five words, the same in an EEPROM slot (little endian) and in
+ * RTC GPREG0..4:
+ *   0: CFG_MAGIC << 24 | CFG_VERSION << 16 | generation
+ *   1..3: CFG_DATA_Type
+ *   4: CRC-32 of words 0..3
+ * The generation grows by one per save and selects the slot, gen & 1 */
+#define CFG_MAGIC           0xC5
+#define CFG_REC_WORDS       5
+#define CFG_REC_SIZE        (CFG_REC_WORDS * 4)
+/* CRC-32 of words 0..3, the words are little endian in RAM as in EEPROM */
+#define CFG_CRC(w)          CRC32_Calc((uint8_t *)(w), CFG_REC_SIZE - 4)
+
+
+/* Private Variables ---------------------------------------------------------- */
+/** @defgroup CONFIG_Private_Variables CONFIG Private Variables
+ * @{
+ */
+
+static CFG_DATA_Type cfg_data =
+{
+	CFG_DEF_UART0_BAUD, CFG_DEF_UART2_BAUD, CFG_DEF_LED_DELAY
+};
+static uint16_t cfg_gen = 0xFFFF;	// Generation in use, the first save is 0
+static uint8_t cfg_bus;				// CFG_BUS_INIT() done
+static CFG_INFO_Type cfg_info;
+
+/**
+ * @}
+ */
+
+
+/* Private Functions ---------------------------------------------------------- */
+static Status cfg_check (uint32_t *w);
+static void cfg_pack (uint32_t *w, uint16_t gen, CFG_DATA_Type *data);
+static void cfg_bytes (uint8_t *b, uint32_t *w, uint8_t to_bytes);
+static void cfg_mirror (uint32_t *w);
+
+
+/*********************************************************************//**
+ * @brief		Check magic, layout version and CRC of a record
+ * @param[in]	- w: record words
+ * @return 		SUCCESS if the record can be used
+ **********************************************************************/
+static Status cfg_check (uint32_t *w)
+{
+	if ((w[0] >> 16) != ((CFG_MAGIC << 8) | CFG_VERSION)) return ERROR;
+	if (w[CFG_REC_WORDS - 1] != CFG_CRC(w)) return ERROR;
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Build a record
+ * @param[out]	- w: record words
+ * @param[in]	- gen: generation
+ * @param[in]	- data: settings
+ * @return 		None
+ **********************************************************************/
+static void cfg_pack (uint32_t *w, uint16_t gen, CFG_DATA_Type *data)
+{
+	w[0] = ((uint32_t)CFG_MAGIC << 24) | (CFG_VERSION << 16) | gen;
+	w[1] = data->uart0_baud;
+	w[2] = data->uart2_baud;
+	w[3] = data->led_delay;
+	w[4] = CFG_CRC(w);
+}
+
+
+/*********************************************************************//**
+ * @brief		Convert a record between words and EEPROM bytes
+ * @param[in]	- b: bytes
+ * @param[in]	- w: words
+ * @param[in]	- to_bytes: 1 for words to bytes, 0 for bytes to words
+ * @return 		None
+ **********************************************************************/
+static void cfg_bytes (uint8_t *b, uint32_t *w, uint8_t to_bytes)
+{
+	uint32_t i;
+
+	for (i = 0; i < CFG_REC_WORDS; i++, b += 4)
+	{
+		if (to_bytes)
+		{
+			b[0] = w[i];
+			b[1] = w[i] >> 8;
+			b[2] = w[i] >> 16;
+			b[3] = w[i] >> 24;
+		}
+		else
+		{
+			w[i] = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+		}
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief		Copy a record to the RTC general purpose registers
+ * @param[in]	- w: record words
+ * @return 		None
+ **********************************************************************/
+static void cfg_mirror (uint32_t *w)
+{
+	uint32_t i;
+
+	for (i = 0; i < CFG_REC_WORDS; i++)
+	{
+		RTC_WriteGPREG(LPC_RTC, i, w[i]);
+	}
+}
+
+/* End of Private Functions --------------------------------------------------- */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup CONFIG_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Load the configuration at boot. The RTC mirror is used
+ *              when valid, otherwise both EEPROM slots are fetched in
+ *              one read and the newer valid one wins and is mirrored.
+ * @param[in]	None
+ * @return 		Where the configuration came from
+ **********************************************************************/
+CFG_SOURCE_Type CFG_Load (void)
+{
+	uint8_t buf[CFG_SLOT_SIZE + CFG_REC_SIZE];
+	uint32_t a[CFG_REC_WORDS], b[CFG_REC_WORDS];
+	uint32_t *w = NULL;
+	uint32_t i, start;
+
+	DWT_CycleInit();
+	start = DWT_CYCCNT;
+
+	CLKPWR_ConfigPPWR(CLKPWR_PCONP_PCRTC, ENABLE);
+	for (i = 0; i < CFG_REC_WORDS; i++)
+	{
+		a[i] = RTC_ReadGPREG(LPC_RTC, i);
+	}
+
+	if (cfg_check(a) == SUCCESS)
+	{
+		w = a;
+		cfg_info.source = CFG_SRC_GPREG;
+	}
+	else
+	{
+		CFG_BUS_INIT();
+		cfg_bus = 1;
+
+		if (NVM_Read(CFG_DEV, CFG_BASE, buf, sizeof(buf)) == SUCCESS)
+		{
+			cfg_bytes(buf, a, 0);
+			cfg_bytes(buf + CFG_SLOT_SIZE, b, 0);
+
+			if (cfg_check(a) == SUCCESS) w = a;
+			if ((cfg_check(b) == SUCCESS) &&
+				((w == NULL) || ((int16_t)((uint16_t)b[0] - (uint16_t)a[0]) > 0)))
+			{
+				w = b;
+			}
+		}
+
+		if (w != NULL)
+		{
+			cfg_mirror(w);
+			cfg_info.source = CFG_SRC_EEPROM;
+		}
+		else
+		{
+			cfg_info.source = CFG_SRC_DEFAULT;
+		}
+	}
+
+	if (w != NULL)
+	{
+		cfg_gen = w[0];
+		cfg_data.uart0_baud = w[1];
+		cfg_data.uart2_baud = w[2];
+		cfg_data.led_delay = w[3];
+	}
+
+	cfg_info.generation = cfg_gen;
+	cfg_info.cycles = DWT_CYCCNT - start;
+	return cfg_info.source;
+}
+
+
+/*********************************************************************//**
+ * @brief		Settings in use
+ * @param[in]	None
+ * @return 		Loaded, saved or default settings
+ **********************************************************************/
+const CFG_DATA_Type *CFG_Get (void)
+{
+	return &cfg_data;
+}
+
+
+/*********************************************************************//**
+ * @brief		Save new settings into the slot not holding the current
+ *              record, verify it, then update the RTC mirror
+ * @param[in]	- data: settings
+ * @return 		SUCCESS, ERROR if the slot could not be written; the
+ *              previous record stays in use
+ **********************************************************************/
+Status CFG_Save (CFG_DATA_Type *data)
+{
+	uint8_t buf[CFG_REC_SIZE];
+	uint32_t w[CFG_REC_WORDS];
+	uint16_t gen = cfg_gen + 1;
+	uint32_t addr = CFG_BASE + (gen & 1) * CFG_SLOT_SIZE;
+
+	if (!cfg_bus)
+	{
+		CFG_BUS_INIT();
+		cfg_bus = 1;
+	}
+
+	cfg_pack(w, gen, data);
+	cfg_bytes(buf, w, 1);
+
+	if ((NVM_Write(CFG_DEV, addr, buf, CFG_REC_SIZE) == ERROR) ||
+		(NVM_Verify(CFG_DEV, addr, buf, CFG_REC_SIZE) == ERROR))
+	{
+		return ERROR;
+	}
+
+	cfg_mirror(w);
+	cfg_gen = gen;
+	cfg_data = *data;
+	cfg_info.generation = gen;
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Read how the configuration was loaded
+ * @param[out]	- info: filled with source, generation and cycles
+ * @return 		None
+ **********************************************************************/
+void CFG_GetInfo (CFG_INFO_Type *info)
+{
+	*info = cfg_info;
+}
+
+/**
+ * @}
+ */
+
+/* End of Public Functions ---------------------------------------------------- */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -66,75 +66,59 @@ char I2C_Eeprom_Write_Byte (uint16 eep_address, uint8_t byte_data)
 
 
 /*********************************************************************//**
- * @brief	    Writes byte at given address
- * @param[in]	eep_address    Word Address range[0000 - 4000]
- * @param[in]   byte_data      Byte value
+ * @brief	    Writes array at given address, page by page. Each page
+ *              is sent straight from the caller's buffer behind its
+ *              address byte, then the device is ACK-polled until the
+ *              write cycle is done.
+ * @param[in]	eep_address    Word Address range[0000 - 07FF]
+ * @param[in]   byte_data      Source buffer
+ * @param[in]   length         Number of bytes to write
  * @return 		status
  **********************************************************************/
 char I2C_Eeprom_Write (uint16_t eep_address, uint8_t* byte_data, uint16_t length)
 {
-	/* Transmit setup */
-	I2C_M_SETUP_Type txsetup;
-	uint16_t ip_len,new_length,i;
-	uint16 new_address;
-	uint8_t set_addr;
-
-	/* Intern page length(ip_len) gives length from address that can be occupied in page */
-	ip_len = 0x10 - (eep_address % 0x10);
-	new_address = eep_address + ip_len;
-
-	set_addr =(eep_address & 0x7FF) >> 8;
-//    printf(LPC_UART0,"%x02",set_addr);
-
-    I2C_Tx_Buf[0] = (uchar)(eep_address & 0xFF);    // 2st byte extract
-
-	if(length > ip_len)
+	uint8_t addr, set_addr;
+	uint16_t chunk;
+#ifdef E2P24C16_SKIP_MODE
+	uint8_t page[E2P24C16_PAGE];
+	uint16_t i;
+#endif
+
+	while (length)
 	{
-		new_length = length - ip_len;
+		/* Bytes left up to the end of the current page */
+		chunk = E2P24C16_PAGE - (eep_address % E2P24C16_PAGE);
+		chunk = MIN(chunk, length);
 
-		for(i=1;i<(ip_len+1);i++)
+#ifdef E2P24C16_SKIP_MODE
+		i = chunk;
+		if (I2C_Eeprom_Read(eep_address, page, chunk) == 0)
 		{
-			I2C_Tx_Buf[i]=*byte_data++;
+			for (i = 0; (i < chunk) && (page[i] == byte_data[i]); i++);
 		}
-		txsetup.sl_addr7bit = E2P24C16_ID|set_addr;
-		txsetup.tx_data = I2C_Tx_Buf;
-		txsetup.tx_length = ip_len+1;
-		txsetup.rx_data = NULL;
-		txsetup.rx_length = 0;
-		txsetup.retransmissions_max = 50;
-
-		if(I2C_MasterTransferData(LPC_I2C0, &txsetup, I2C_TRANSFER_POLLING)==ERROR) //return status
+		if (i != chunk)
+#endif
 		{
-			return (-1);
+			set_addr = (eep_address & 0x7FF) >> 8;     // block select in slave address
+			addr = (uchar)(eep_address & 0xFF);        // 2st byte extract
+
+			if (I2C_MasterWriteGather(LPC_I2C0, E2P24C16_ID|set_addr, &addr, 1, byte_data, chunk) == ERROR)
+			{
+				return (-1);
+			}
+
+			/* Device NACKs its address until the write cycle is over */
+			if (I2C_MasterAckPoll(LPC_I2C0, E2P24C16_ID|set_addr, E2P24C16_ACKPOLL) == ERROR)
+			{
+				return (-1);
+			}
 		}
 
-		// Recursive function
-		delay_ms(5);
-		I2C_Eeprom_Write(new_address,byte_data,new_length);
-	}
-
-	if(length <= ip_len)
-	{
-		for(i=1;i<(length+1);i++)
-		{
-			I2C_Tx_Buf[i]=*byte_data++;
-		}
-		txsetup.sl_addr7bit = E2P24C16_ID|set_addr;
-		txsetup.tx_data = I2C_Tx_Buf;
-		txsetup.tx_length = length+1;
-		txsetup.rx_data = NULL;
-		txsetup.rx_length = 0;
-		txsetup.retransmissions_max = 50;
-
-		if(I2C_MasterTransferData(LPC_I2C0, &txsetup, I2C_TRANSFER_POLLING)==SUCCESS) //return status
-		{
-			return (0);
-		}
-		else
-		{
-			return (-1);
-		}
+		eep_address += chunk;
+		byte_data += chunk;
+		length -= chunk;
 	}
+	return (0);
 }
 
 
@@ -206,6 +190,38 @@ char I2C_Eeprom_Read (uint16_t eep_address, uint8_t* buf_data, uint16_t length)
 }
 
 
+/*********************************************************************//**
+ * @brief	    Queues an array read from given address on I2C0, the
+ *              caller continues while the interrupt runs the transfer
+ * @param[in]	xfer           Transaction, owned by the driver until cb
+ * @param[in]	eep_address    Word Address range[0000 - 07FF]
+ * @param[out]	buf_data       Destination, valid once cb reports SUCCESS
+ * @param[in]	length         Number of bytes to read
+ * @param[in]	cb             Completion callback, called from the I2C interrupt
+ * @param[in]	arg            User argument stored in xfer->arg
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status I2C_Eeprom_Read_Async (I2C_XFER_Type *xfer, uint16_t eep_address, uint8_t* buf_data,
+		uint16_t length, I2C_XFER_CB_Type cb, void *arg)
+{
+	uint8_t set_addr;
+
+	set_addr = (eep_address & 0x7FF) >> 8;          // block select in slave address
+	xfer->cmd[0] = (uchar)(eep_address & 0xFF);     // 2st byte extract
+
+	xfer->setup.sl_addr7bit = E2P24C16_ID|set_addr;
+	xfer->setup.tx_data = xfer->cmd;	// Get address to read at writing address
+	xfer->setup.tx_length = 1;
+	xfer->setup.rx_data = buf_data;
+	xfer->setup.rx_length = length;
+	xfer->setup.retransmissions_max = 3;
+	xfer->complete = cb;
+	xfer->arg = arg;
+
+	return (I2C_MasterSubmit(LPC_I2C0, xfer, 1));
+}
+
+
 /*********************************************************************//**
  * @brief	    Display Read data stored in array
  * @param[in]   *dest_addr     buffer address
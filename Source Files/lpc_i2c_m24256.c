@@ -30,7 +30,7 @@
 
 /*********************************************************************//**
  * @brief	    Writes byte at given address
- * @param[in]	eep_address    Word Address range[0000 - 4000]
+ * @param[in]	eep_address    Word Address range[0000 - 7FFF]
  * @param[in]   byte_data      Byte value
  * @return 		status
  **********************************************************************/
@@ -39,7 +39,7 @@ char I2C_IEeprom_Write_Byte (uint16_t eep_address, uint8_t byte_data)
 	/* Transmit setup */
 	I2C_M_SETUP_Type txsetup;
 
-	I2C_Tx_Buf[0] =(eep_address & 0x8FFF) >> 8;     // 1st byte extract
+	I2C_Tx_Buf[0] =(eep_address & E2PM24256_ADDR_MASK) >> 8;     // 1st byte extract
  //   printf(LPC_UART0,"%x02",set_addr);
 
     I2C_Tx_Buf[1] = (uchar)(eep_address & 0xFF);    // 2st byte extract
@@ -65,80 +65,65 @@ char I2C_IEeprom_Write_Byte (uint16_t eep_address, uint8_t byte_data)
 
 
 /*********************************************************************//**
- * @brief	    Writes byte at given address
- * @param[in]	eep_address    Word Address range[0000 - 4000]
- * @param[in]   byte_data      Byte value
+ * @brief	    Writes array at given address, page by page. Each page
+ *              is sent straight from the caller's buffer behind its
+ *              address bytes, then the device is ACK-polled until the
+ *              write cycle is done.
+ * @param[in]	eep_address    Word Address range[0000 - 7FFF]
+ * @param[in]   byte_data      Source buffer
+ * @param[in]   length         Number of bytes to write
  * @return 		status
  **********************************************************************/
 char I2C_IEeprom_Write (uint16_t eep_address, uint8_t* byte_data, uint16_t length)
 {
-	/* Transmit setup */
-	I2C_M_SETUP_Type txsetup;
-	uint16_t ip_len,new_length,i;
-	uint16_t new_address;
-
-	/* Intern page length(ip_len) gives length from address that can be occupied in page */
-	ip_len = 0x40 - (eep_address % 0x40);
-	new_address = eep_address + ip_len;
-
-	I2C_Tx_Buf[0] =(eep_address & 0x8FFF) >> 8;     // 1st byte extract
-  //  printf(LPC_UART0,"%x02",I2C_Tx_Buf[0]);
-
-    I2C_Tx_Buf[1] = (uchar)(eep_address & 0xFF);    // 2st byte extract
-
-	if(length > ip_len)
+	uint8_t addr[2];
+	uint16_t chunk;
+#ifdef E2PM24256_SKIP_MODE
+	uint8_t page[E2PM24256_PAGE];
+	uint16_t i;
+#endif
+
+	while (length)
 	{
-		new_length = length - ip_len;
+		/* Bytes left up to the end of the current page */
+		chunk = E2PM24256_PAGE - (eep_address % E2PM24256_PAGE);
+		chunk = MIN(chunk, length);
 
-		for(i=2;i<(ip_len+2);i++)
+#ifdef E2PM24256_SKIP_MODE
+		i = chunk;
+		if (I2C_IEeprom_Read(eep_address, page, chunk) == 0)
 		{
-			I2C_Tx_Buf[i]=*byte_data++;
+			for (i = 0; (i < chunk) && (page[i] == byte_data[i]); i++);
 		}
-		txsetup.sl_addr7bit = E2PM24256_ID;
-		txsetup.tx_data = I2C_Tx_Buf;
-		txsetup.tx_length = ip_len+2;
-		txsetup.rx_data = NULL;
-		txsetup.rx_length = 0;
-		txsetup.retransmissions_max = 50;
-
-		if(I2C_MasterTransferData(LPC_I2C0, &txsetup, I2C_TRANSFER_POLLING)==ERROR) //return status
+		if (i != chunk)
+#endif
 		{
-			return (-1);
+			addr[0] = (eep_address & E2PM24256_ADDR_MASK) >> 8;     // 1st byte extract
+			addr[1] = (uchar)(eep_address & 0xFF);     // 2st byte extract
+
+			if (I2C_MasterWriteGather(LPC_I2C0, E2PM24256_ID, addr, 2, byte_data, chunk) == ERROR)
+			{
+				return (-1);
+			}
+
+			/* Device NACKs its address until the write cycle is over */
+			if (I2C_MasterAckPoll(LPC_I2C0, E2PM24256_ID, E2PM24256_ACKPOLL) == ERROR)
+			{
+				return (-1);
+			}
 		}
 
-		// Recursive function
-		delay_ms(5);
-		I2C_IEeprom_Write(new_address,byte_data,new_length);
-	}
-
-	if(length <= ip_len)
-	{
-		for(i=2;i<(length+2);i++)
-		{
-			I2C_Tx_Buf[i]=*byte_data++;
-		}
-		txsetup.sl_addr7bit = E2PM24256_ID;
-		txsetup.tx_data = I2C_Tx_Buf;
-		txsetup.tx_length = length+2;
-		txsetup.rx_data = NULL;
-		txsetup.rx_length = 0;
-		txsetup.retransmissions_max = 50;
-
-		if(I2C_MasterTransferData(LPC_I2C0, &txsetup, I2C_TRANSFER_POLLING)==SUCCESS) //return status
-		{
-			return (0);
-		}
-		else
-		{
-			return (-1);
-		}
+		eep_address += chunk;
+		byte_data += chunk;
+		length -= chunk;
 	}
+	return (0);
 }
 
 
 /*********************************************************************//**
  * @brief	    Reads byte from given address
- * @param[in]	eep_address    Word Address range[0000 - 4000]
+ * @param[in]	eep_address    Word Address range[0000 - 7FFF]
  * @return 		Byte value
  **********************************************************************/
 uint8_t I2C_IEeprom_Read_Byte (uint16_t eep_address)
@@ -146,7 +131,7 @@ uint8_t I2C_IEeprom_Read_Byte (uint16_t eep_address)
 	/* Receive setup */
 	I2C_M_SETUP_Type rxsetup;
 
-	I2C_Tx_Buf[0] = (eep_address & 0x8FFF) >> 8;    // 1st byte extract
+	I2C_Tx_Buf[0] = (eep_address & E2PM24256_ADDR_MASK) >> 8;    // 1st byte extract
 //    printf(LPC_UART0,"%x02",set_addr);
 	I2C_Tx_Buf[1] = (uchar)(eep_address & 0xFF);    // 2st byte extract
 
@@ -170,7 +155,7 @@ uint8_t I2C_IEeprom_Read_Byte (uint16_t eep_address)
 
 /*********************************************************************//**
  * @brief	    Reads array from given address
- * @param[in]	eep_address    Word Address range[0000 - 4000]
+ * @param[in]	eep_address    Word Address range[0000 - 7FFF]
  * @return 		Byte value
  **********************************************************************/
 char I2C_IEeprom_Read (uint16_t eep_address, uint8_t* buf_data, uint16_t length)
@@ -178,7 +163,7 @@ char I2C_IEeprom_Read (uint16_t eep_address, uint8_t* buf_data, uint16_t length)
 	/* Receive setup */
 	I2C_M_SETUP_Type rxsetup;
 
-	I2C_Tx_Buf[0] = (eep_address & 0x8FFF) >> 8;
+	I2C_Tx_Buf[0] = (eep_address & E2PM24256_ADDR_MASK) >> 8;
  //   printf(LPC_UART0,"%x02",set_addr);
 
 	I2C_Tx_Buf[1] = (uchar)(eep_address & 0xFF);    // 2st byte extract
@@ -201,6 +186,36 @@ char I2C_IEeprom_Read (uint16_t eep_address, uint8_t* buf_data, uint16_t length)
 }
 
 
+/*********************************************************************//**
+ * @brief	    Queues an array read from given address on I2C0, the
+ *              caller continues while the interrupt runs the transfer
+ * @param[in]	xfer           Transaction, owned by the driver until cb
+ * @param[in]	eep_address    Word Address range[0000 - 7FFF]
+ * @param[out]	buf_data       Destination, valid once cb reports SUCCESS
+ * @param[in]	length         Number of bytes to read
+ * @param[in]	cb             Completion callback, called from the I2C interrupt
+ * @param[in]	arg            User argument stored in xfer->arg
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status I2C_IEeprom_Read_Async (I2C_XFER_Type *xfer, uint16_t eep_address, uint8_t* buf_data,
+		uint16_t length, I2C_XFER_CB_Type cb, void *arg)
+{
+	xfer->cmd[0] = (eep_address & E2PM24256_ADDR_MASK) >> 8;     // 1st byte extract
+	xfer->cmd[1] = (uchar)(eep_address & 0xFF);     // 2st byte extract
+
+	xfer->setup.sl_addr7bit = E2PM24256_ID;
+	xfer->setup.tx_data = xfer->cmd;	// Get address to read at writing address
+	xfer->setup.tx_length = 2;
+	xfer->setup.rx_data = buf_data;
+	xfer->setup.rx_length = length;
+	xfer->setup.retransmissions_max = 3;
+	xfer->complete = cb;
+	xfer->arg = arg;
+
+	return (I2C_MasterSubmit(LPC_I2C0, xfer, 1));
+}
+
+
 /*********************************************************************//**
  * @brief	    Display Read data stored in array
  * @param[in]   *dest_addr     buffer address
@@ -311,6 +311,50 @@ uchar TMP102_Read_Temp(BIT_Type res)
 }
 
 
+/*********************************************************************//**
+ * @brief	    Queues a Temperature register read on I2C0, convert the
+ *              result with TMP102_Temp_Count() from the callback
+ * @param[in]	xfer   Transaction, owned by the driver until cb
+ * @param[out]	buf    2 byte raw register value (MSB first)
+ * @param[in]	cb     Completion callback, called from the I2C interrupt
+ * @param[in]	arg    User argument stored in xfer->arg
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status TMP102_Read_Temp_Async(I2C_XFER_Type *xfer, uint8_t *buf, I2C_XFER_CB_Type cb, void *arg)
+{
+	xfer->cmd[0] = TMP_REG;    /* Select Temperature Register */
+
+	xfer->setup.sl_addr7bit = TMP102_ID;
+	xfer->setup.tx_data = xfer->cmd;
+	xfer->setup.tx_length = 1;
+	xfer->setup.rx_data = buf;
+	xfer->setup.rx_length = 2;
+	xfer->setup.retransmissions_max = 50;
+	xfer->complete = cb;
+	xfer->arg = arg;
+
+	return (I2C_MasterSubmit(LPC_I2C0, xfer, 1));
+}
+
+
+/*********************************************************************//**
+ * @brief	    Converts a raw Temperature register value
+ * @param[in]	buf  2 byte raw register value (MSB first)
+ * @param[in]	res  -TMP102_12B
+ *                   -TMP102_13B
+ * @return 		Signed temperature in 0.0625 degC steps
+ **********************************************************************/
+int16_t TMP102_Temp_Count(uint8_t *buf, BIT_Type res)
+{
+	/* Left justified two's complement, shift out the unused low bits */
+	if(res==TMP102_13B)
+	{
+		return ((int16_t)((buf[0]<<8)|buf[1]) >> 3);
+	}
+	return ((int16_t)((buf[0]<<8)|buf[1]) >> 4);
+}
+
+
 /**
  * @}
  */
@@ -27,6 +27,39 @@
 
 
 
+/* Private Functions ---------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief	    Completion of one queued register read
+ * @param[in]	xfer      Finished transaction
+ * @param[in]	result    SUCCESS or ERROR
+ * @return 		None
+ **********************************************************************/
+static void TSC2004_Async_Done (I2C_XFER_Type *xfer, Status result)
+{
+	TSC2004_ASYNC_Type *ctx = (TSC2004_ASYNC_Type *) xfer->arg;
+
+	if (result == ERROR)
+	{
+		ctx->result = ERROR;
+	}
+
+	/* Batch runs in order, the Z2 read completes it */
+	if (xfer == &ctx->xfer[3])
+	{
+		ctx->tc->x  = ((ctx->data[0][0]<<8)|ctx->data[0][1]) & MEAS_MASK;
+		ctx->tc->y  = ((ctx->data[1][0]<<8)|ctx->data[1][1]) & MEAS_MASK;
+		ctx->tc->z1 = ((ctx->data[2][0]<<8)|ctx->data[2][1]) & MEAS_MASK;
+		ctx->tc->z2 = ((ctx->data[3][0]<<8)|ctx->data[3][1]) & MEAS_MASK;
+
+		if (ctx->done != NULL)
+		{
+			ctx->done(ctx->tc, ctx->result);
+		}
+	}
+}
+
+
 /** @addtogroup TSC2004_Public_Functions
  * @{
  */
@@ -237,6 +270,42 @@ void TSC2004_Read_Values (ts_event *tc)
 }
 
 
+/*********************************************************************//**
+ * @brief	    Queue X,Y,Z1,Z2 reads as one I2C0 batch chained with
+ *              repeated START, the caller continues meanwhile
+ * @param[in]	ctx     Context, owned by the driver until done is called
+ * @param[out]	tc      store values in structure
+ * @param[in]	done    Called from the I2C interrupt after the last read
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status TSC2004_Read_Values_Async (TSC2004_ASYNC_Type *ctx, ts_event *tc,
+		void (*done)(ts_event *tc, Status result))
+{
+	uint8_t i;
+
+	ctx->tc = tc;
+	ctx->done = done;
+	ctx->result = SUCCESS;
+
+	for (i = 0; i < 4; i++)
+	{
+		/* X_REG..Z2_REG are consecutive */
+		ctx->xfer[i].cmd[0] = TSC2004_CMD0((X_REG + i), PND0_FALSE, READ_REG);
+
+		ctx->xfer[i].setup.sl_addr7bit = TSC2004_ID;
+		ctx->xfer[i].setup.tx_data = ctx->xfer[i].cmd;
+		ctx->xfer[i].setup.tx_length = 1;
+		ctx->xfer[i].setup.rx_data = ctx->data[i];
+		ctx->xfer[i].setup.rx_length = 2;
+		ctx->xfer[i].setup.retransmissions_max = 3;
+		ctx->xfer[i].complete = TSC2004_Async_Done;
+		ctx->xfer[i].arg = ctx;
+	}
+
+	return (I2C_MasterSubmit(LPC_I2C0, ctx->xfer, 4));
+}
+
+
 /*********************************************************************//**
  * @brief	    Read X,Y,Z1,Z2 Values and Display on Terminal
  * @param[in]	None
@@ -0,0 +1,368 @@
+/******************************************************************//**
+* @file		lpc_nvm.c
+* @brief	Contains the common nonvolatile memory interface and the
+*           EEPROM device backends on LPC17xx
+* @version	1.0
+* @date		18. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup NVM
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc_nvm.h"
+#include "string.h"
+#if NVM_M24256_SEL
+#include "lpc_i2c_m24256.h"
+#endif
+#if NVM_AT24C16_SEL
+#include "lpc_i2c_at24c16.h"
+#endif
+#if NVM_25AA160A_SSP_SEL
+#include "lpc_ssp_25aa160a.h"
+#endif
+#if NVM_25AA160A_SPI_SEL
+#include "lpc_spi_25aa160a.h"
+#endif
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+
+#if (NVM_25AA160A_SSP_SEL && NVM_25AA160A_SPI_SEL)
+	#error "The SPI and SSP0 25AA160A backends share pins, enable only one"
+#endif
+
+
+/* Private Functions ---------------------------------------------------------- */
+static Status nvm_check (const NVM_DEV_Type *dev, uint32_t addr, uint32_t len);
+static Status nvm_update_page (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf,
+		uint32_t len, uint8_t *tmp);
+
+
+/*********************************************************************//**
+ * @brief		Check a range against the device capacity
+ * @param[in]	- dev: device
+ * @param[in]	- addr: first byte
+ * @param[in]	- len: number of bytes
+ * @return 		SUCCESS if the range is inside the device
+ **********************************************************************/
+static Status nvm_check (const NVM_DEV_Type *dev, uint32_t addr, uint32_t len)
+{
+	if ((dev == NULL) || (dev->page > NVM_PAGE_MAX)) return ERROR;
+	if ((len > dev->size) || (addr > dev->size - len)) return ERROR;
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Write a range inside one page only if it differs from
+ *              the device content
+ * @param[in]	- dev: device
+ * @param[in]	- addr: first byte, addr..addr+len-1 inside one page
+ * @param[in]	- buf: new content
+ * @param[in]	- len: number of bytes
+ * @param[in]	- tmp: scratch of NVM_PAGE_MAX bytes
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status nvm_update_page (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf,
+		uint32_t len, uint8_t *tmp)
+{
+	if ((dev->read(addr, tmp, len) == SUCCESS) && (memcmp(tmp, buf, len) == 0))
+	{
+		return SUCCESS;
+	}
+	return dev->write(addr, buf, len);
+}
+
+
+/* Device backends ------------------------------------------------------------ */
+#if NVM_M24256_SEL
+static Status nvm_m24256_read (uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return (I2C_IEeprom_Read(addr, buf, len) == 0) ? SUCCESS : ERROR;
+}
+
+static Status nvm_m24256_write (uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return (I2C_IEeprom_Write(addr, buf, len) == 0) ? SUCCESS : ERROR;
+}
+
+const NVM_DEV_Type NVM_M24256 =
+{
+	"M24256", E2PM24256_SIZE, E2PM24256_PAGE, 5,
+	nvm_m24256_read, nvm_m24256_write
+};
+#endif
+
+#if NVM_AT24C16_SEL
+static Status nvm_at24c16_read (uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return (I2C_Eeprom_Read(addr, buf, len) == 0) ? SUCCESS : ERROR;
+}
+
+static Status nvm_at24c16_write (uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return (I2C_Eeprom_Write(addr, buf, len) == 0) ? SUCCESS : ERROR;
+}
+
+const NVM_DEV_Type NVM_AT24C16 =
+{
+	"AT24C16", E2P24C16_SIZE, E2P24C16_PAGE, 5,
+	nvm_at24c16_read, nvm_at24c16_write
+};
+#endif
+
+#if NVM_25AA160A_SSP_SEL
+static Status nvm_25aa160a_ssp_read (uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return Ssp_Eeprom_Read(NVM_25AA160A_PORT, addr, buf, len) ? SUCCESS : ERROR;
+}
+
+static Status nvm_25aa160a_ssp_write (uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return Ssp_Eeprom_Write(NVM_25AA160A_PORT, addr, buf, len) ? SUCCESS : ERROR;
+}
+
+const NVM_DEV_Type NVM_25AA160A_Ssp =
+{
+	"25AA160A SSP", EEP_SIZE, EEP_PAGE_SIZE, 5,
+	nvm_25aa160a_ssp_read, nvm_25aa160a_ssp_write
+};
+#endif
+
+#if NVM_25AA160A_SPI_SEL
+static Status nvm_25aa160a_spi_read (uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return Spi_Eeprom_Read(addr, buf, len) ? SUCCESS : ERROR;
+}
+
+static Status nvm_25aa160a_spi_write (uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return Spi_Eeprom_Write(addr, buf, len) ? SUCCESS : ERROR;
+}
+
+const NVM_DEV_Type NVM_25AA160A_Spi =
+{
+	"25AA160A SPI", EEP_SIZE, EEP_PAGE_SIZE, 5,
+	nvm_25aa160a_spi_read, nvm_25aa160a_spi_write
+};
+#endif
+
+/* End of Private Functions --------------------------------------------------- */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup NVM_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Read a range, in one sequential transfer of the backend
+ * @param[in]	- dev: device
+ * @param[in]	- addr: first byte
+ * @param[out]	- buf: destination
+ * @param[in]	- len: number of bytes
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status NVM_Read (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	if (nvm_check(dev, addr, len) == ERROR) return ERROR;
+	if (len == 0) return SUCCESS;
+
+	return dev->read(addr, buf, len);
+}
+
+
+/*********************************************************************//**
+ * @brief		Write a range, the backend splits it on its pages
+ * @param[in]	- dev: device
+ * @param[in]	- addr: first byte
+ * @param[in]	- buf: source
+ * @param[in]	- len: number of bytes
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status NVM_Write (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	if (nvm_check(dev, addr, len) == ERROR) return ERROR;
+	if (len == 0) return SUCCESS;
+
+	return dev->write(addr, buf, len);
+}
+
+
+/*********************************************************************//**
+ * @brief		Compare-before-write: each page of the range is read
+ *              first and only written if its content changes, saving
+ *              the write cycle and the wear of unchanged pages
+ * @param[in]	- dev: device
+ * @param[in]	- addr: first byte
+ * @param[in]	- buf: new content
+ * @param[in]	- len: number of bytes
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status NVM_Update (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	uint8_t tmp[NVM_PAGE_MAX];
+	uint32_t n;
+
+	if (nvm_check(dev, addr, len) == ERROR) return ERROR;
+
+	while (len)
+	{
+		n = MIN(dev->page - (addr % dev->page), len);
+		if (nvm_update_page(dev, addr, buf, n, tmp) == ERROR) return ERROR;
+
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Compare a range of the device with a buffer
+ * @param[in]	- dev: device
+ * @param[in]	- addr: first byte
+ * @param[in]	- buf: expected content
+ * @param[in]	- len: number of bytes
+ * @return 		SUCCESS if equal, ERROR on a difference or a read error
+ **********************************************************************/
+Status NVM_Verify (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	uint8_t tmp[NVM_PAGE_MAX];
+	uint32_t n;
+
+	if (nvm_check(dev, addr, len) == ERROR) return ERROR;
+
+	while (len)
+	{
+		n = MIN(NVM_PAGE_MAX, len);
+		if (dev->read(addr, tmp, n) == ERROR) return ERROR;
+		if (memcmp(tmp, buf, n) != 0) return ERROR;
+
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Copy a range between two devices, or inside one. The
+ *              copy goes page by page of the destination and pages that
+ *              already hold the data are not written. An overlapping
+ *              copy upwards inside one device runs from the end.
+ * @param[in]	- dst: destination device
+ * @param[in]	- dst_addr: first destination byte
+ * @param[in]	- src: source device
+ * @param[in]	- src_addr: first source byte
+ * @param[in]	- len: number of bytes
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status NVM_Copy (const NVM_DEV_Type *dst, uint32_t dst_addr,
+		const NVM_DEV_Type *src, uint32_t src_addr, uint32_t len)
+{
+	uint8_t buf[NVM_PAGE_MAX];
+	uint8_t tmp[NVM_PAGE_MAX];
+	uint32_t n, off;
+	uint8_t back;
+
+	if (nvm_check(dst, dst_addr, len) == ERROR) return ERROR;
+	if (nvm_check(src, src_addr, len) == ERROR) return ERROR;
+
+	back = (dst == src) && (dst_addr > src_addr) && (dst_addr < src_addr + len);
+
+	while (len)
+	{
+		if (back)
+		{
+			/* Last destination page of what is left */
+			n = (dst_addr + len) % dst->page;
+			if (n == 0) n = dst->page;
+			n = MIN(n, len);
+			off = len - n;
+		}
+		else
+		{
+			n = MIN(dst->page - (dst_addr % dst->page), len);
+			off = 0;
+		}
+
+		if (src->read(src_addr + off, buf, n) == ERROR) return ERROR;
+		if (nvm_update_page(dst, dst_addr + off, buf, n, tmp) == ERROR) return ERROR;
+
+		if (!back)
+		{
+			src_addr += n;
+			dst_addr += n;
+		}
+		len -= n;
+	}
+	return SUCCESS;
+}
+
+
+#ifdef NVM_BENCH_MODE
+/*********************************************************************//**
+ * @brief		Measure the read, write and unchanged-update throughput
+ *              of a device over one range. The range is read, written
+ *              back inverted, verified and updated with the same data.
+ *              It is left inverted, a second run restores it.
+ * @param[in]	- dev: device
+ * @param[in]	- addr: first byte
+ * @param[in]	- buf: scratch of len bytes
+ * @param[in]	- len: number of bytes
+ * @param[out]	- res: cycles and bytes per second of each pass
+ * @return 		SUCCESS, ERROR on a transfer error or a verify mismatch
+ **********************************************************************/
+Status NVM_Bench (const NVM_DEV_Type *dev, uint32_t addr, uint8_t *buf, uint32_t len,
+		NVM_BENCH_Type *res)
+{
+	uint32_t i, start;
+
+	if ((nvm_check(dev, addr, len) == ERROR) || (len == 0)) return ERROR;
+
+	DWT_CycleInit();
+
+	start = DWT_CYCCNT;
+	if (dev->read(addr, buf, len) == ERROR) return ERROR;
+	res->read_cycles = DWT_CYCCNT - start;
+
+	/* Every byte changes, so every page takes its write cycle */
+	for (i = 0; i < len; i++) buf[i] = ~buf[i];
+
+	start = DWT_CYCCNT;
+	if (dev->write(addr, buf, len) == ERROR) return ERROR;
+	res->write_cycles = DWT_CYCCNT - start;
+
+	if (NVM_Verify(dev, addr, buf, len) == ERROR) return ERROR;
+
+	start = DWT_CYCCNT;
+	if (NVM_Update(dev, addr, buf, len) == ERROR) return ERROR;
+	res->update_cycles = DWT_CYCCNT - start;
+
+	res->read_bps = ((uint64_t)len * SystemCoreClock) / MAX(res->read_cycles, 1);
+	res->write_bps = ((uint64_t)len * SystemCoreClock) / MAX(res->write_cycles, 1);
+	res->update_bps = ((uint64_t)len * SystemCoreClock) / MAX(res->update_cycles, 1);
+	return SUCCESS;
+}
+#endif
+
+/**
+ * @}
+ */
+
+/* End of Public Functions ---------------------------------------------------- */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
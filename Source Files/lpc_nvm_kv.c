@@ -0,0 +1,549 @@
+/******************************************************************//**
+* @file		lpc_nvm_kv.c
+* @brief	Contains the log-structured key/value store on an NVM
+*           device on LPC17xx
+* @version	1.0
+* @date		18. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup NVM_KV
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc_nvm_kv.h"
+#include "lpc_crc16.h"
+#include "string.h"
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+
+/* Record layout, little endian. The CRC covers everything before it.
+ * oldest is the lowest sequence still live when the record was written:
+ * at boot, records below the newest record's oldest are dead even if a
+ * later record of their key has been dropped (deleted keys). */
+#define KV_OFS_SEQ          0
+#define KV_OFS_OLDEST       4
+#define KV_OFS_KEY          8
+#define KV_OFS_LEN          10
+#define KV_OFS_VALUE        11
+#define KV_OFS_CRC          (KV_REC_SIZE - 2)
+
+#define KV_KEY_NONE         0xFFFF      /* Free index entry, never a key */
+#define KV_SEQ_NONE         0xFFFFFFFF  /* Erased slot */
+#define KV_TOMBSTONE        0xFF        /* Length of a delete record */
+
+
+/* Private Types -------------------------------------------------------------- */
+/** @defgroup NVM_KV_Private_Types NVM_KV Private Types
+ * @{
+ */
+
+/** @brief RAM index entry, the newest record of one key */
+typedef struct
+{
+	uint32_t seq;				/**< Sequence of the record */
+	uint16_t key;				/**< KV_KEY_NONE if the entry is free */
+	uint16_t slot;				/**< Log slot of the record */
+	uint8_t tomb;				/**< Record is a delete */
+}KV_ENTRY_Type;
+
+/**
+ * @}
+ */
+
+
+/* Private Variables ---------------------------------------------------------- */
+/** @defgroup NVM_KV_Private_Variables NVM_KV Private Variables
+ * @{
+ */
+
+static KV_ENTRY_Type kv_index[KV_KEYS_MAX];
+static uint32_t kv_head;			// Next slot to write
+static uint32_t kv_seq;				// Sequence of the next record
+static uint8_t kv_ready;			// KV_Init() done
+static uint8_t kv_rec[KV_REC_SIZE];
+static uint8_t kv_buf[KV_SCAN_CHUNK];
+#ifdef KV_STATS_MODE
+static KV_STATS_Type kv_stats;
+#endif
+
+/**
+ * @}
+ */
+
+
+/* Private Functions ---------------------------------------------------------- */
+static uint32_t kv_get32 (uint8_t *p);
+static void kv_put32 (uint8_t *p, uint32_t v);
+static uint16_t kv_crc (uint8_t *rec);
+static Status kv_valid (uint8_t *rec);
+static int32_t kv_find (uint16_t key);
+static int32_t kv_tail (void);
+static uint32_t kv_free (void);
+static Status kv_read (uint32_t slot);
+static Status kv_append (int32_t entry, uint16_t key, uint8_t *val, uint8_t len);
+static Status kv_step (void);
+static Status kv_reserve (void);
+
+
+static uint32_t kv_get32 (uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+static void kv_put32 (uint8_t *p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+
+/*********************************************************************//**
+ * @brief		CRC-16 of a record, seeded so a zeroed slot is invalid
+ * @param[in]	- rec: record
+ * @return 		CRC of the bytes before the CRC field
+ **********************************************************************/
+static uint16_t kv_crc (uint8_t *rec)
+{
+	return CRC16_Update(0xFFFF, rec, KV_OFS_CRC);
+}
+
+
+/*********************************************************************//**
+ * @brief		Check a record read from the log
+ * @param[in]	- rec: record
+ * @return 		SUCCESS if the record is complete, ERROR for an erased,
+ *              torn or corrupted slot
+ **********************************************************************/
+static Status kv_valid (uint8_t *rec)
+{
+	if (kv_get32(rec + KV_OFS_SEQ) == KV_SEQ_NONE) return ERROR;
+	if ((rec[KV_OFS_KEY] | (rec[KV_OFS_KEY + 1] << 8)) == KV_KEY_NONE) return ERROR;
+	if ((rec[KV_OFS_LEN] > KV_VALUE_MAX) && (rec[KV_OFS_LEN] != KV_TOMBSTONE)) return ERROR;
+	if ((rec[KV_OFS_CRC] | (rec[KV_OFS_CRC + 1] << 8)) != kv_crc(rec)) return ERROR;
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Look up a key in the index
+ * @param[in]	- key: key
+ * @return 		entry, or -1 if the key has no record
+ **********************************************************************/
+static int32_t kv_find (uint16_t key)
+{
+	uint32_t i;
+
+	for (i = 0; i < KV_KEYS_MAX; i++)
+	{
+		if (kv_index[i].key == key) return i;
+	}
+	return -1;
+}
+
+
+/*********************************************************************//**
+ * @brief		Oldest live record, the next one compaction handles
+ * @param[in]	None
+ * @return 		entry, or -1 if the index is empty
+ **********************************************************************/
+static int32_t kv_tail (void)
+{
+	int32_t tail = -1;
+	uint32_t i;
+
+	for (i = 0; i < KV_KEYS_MAX; i++)
+	{
+		if ((kv_index[i].key != KV_KEY_NONE) &&
+			((tail < 0) || (kv_index[i].seq < kv_index[tail].seq)))
+		{
+			tail = i;
+		}
+	}
+	return tail;
+}
+
+
+/*********************************************************************//**
+ * @brief		Number of slots that can be written before the oldest
+ *              live record would be overwritten
+ * @param[in]	None
+ * @return 		free slots
+ **********************************************************************/
+static uint32_t kv_free (void)
+{
+	int32_t tail = kv_tail();
+
+	if (tail < 0) return KV_SLOTS;
+	return (kv_index[tail].slot + KV_SLOTS - kv_head) % KV_SLOTS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Read and check one slot into kv_rec
+ * @param[in]	- slot: log slot
+ * @return 		SUCCESS if the slot holds a valid record
+ **********************************************************************/
+static Status kv_read (uint32_t slot)
+{
+	if (NVM_Read(KV_DEV, KV_BASE + slot * KV_REC_SIZE, kv_rec, KV_REC_SIZE) == ERROR)
+	{
+		return ERROR;
+	}
+	return kv_valid(kv_rec);
+}
+
+
+/*********************************************************************//**
+ * @brief		Append a record at the head and point an index entry
+ *              to it once it is written
+ * @param[in]	- entry: index entry of the key, a free one for a new key
+ * @param[in]	- key: key
+ * @param[in]	- val: value, unused for a tombstone
+ * @param[in]	- len: value length or KV_TOMBSTONE
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status kv_append (int32_t entry, uint16_t key, uint8_t *val, uint8_t len)
+{
+	uint32_t oldest = kv_seq;
+	uint32_t i;
+	uint16_t crc;
+
+	/* The entry's previous record dies with this one */
+	for (i = 0; i < KV_KEYS_MAX; i++)
+	{
+		if (((int32_t)i != entry) && (kv_index[i].key != KV_KEY_NONE) && (kv_index[i].seq < oldest))
+		{
+			oldest = kv_index[i].seq;
+		}
+	}
+
+	memset(kv_rec, 0xFF, KV_REC_SIZE);
+	kv_put32(kv_rec + KV_OFS_SEQ, kv_seq);
+	kv_put32(kv_rec + KV_OFS_OLDEST, oldest);
+	kv_rec[KV_OFS_KEY] = key;
+	kv_rec[KV_OFS_KEY + 1] = key >> 8;
+	kv_rec[KV_OFS_LEN] = len;
+	if (len != KV_TOMBSTONE) memcpy(kv_rec + KV_OFS_VALUE, val, len);
+	crc = kv_crc(kv_rec);
+	kv_rec[KV_OFS_CRC] = crc;
+	kv_rec[KV_OFS_CRC + 1] = crc >> 8;
+
+	if (NVM_Write(KV_DEV, KV_BASE + kv_head * KV_REC_SIZE, kv_rec, KV_REC_SIZE) == ERROR)
+	{
+		return ERROR;
+	}
+
+	kv_index[entry].seq = kv_seq;
+	kv_index[entry].key = key;
+	kv_index[entry].slot = kv_head;
+	kv_index[entry].tomb = (len == KV_TOMBSTONE);
+
+	kv_head = (kv_head + 1) % KV_SLOTS;
+	kv_seq++;
+#ifdef KV_STATS_MODE
+	kv_stats.appends++;
+#endif
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		One compaction step on the oldest live record: a value
+ *              is copied to the head, a tombstone is released. Either
+ *              way its slot and the dead ones after it become free.
+ * @param[in]	None
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status kv_step (void)
+{
+	uint8_t val[KV_VALUE_MAX];
+	int32_t tail = kv_tail();
+
+	if (tail < 0) return SUCCESS;
+
+	if (kv_index[tail].tomb)
+	{
+		kv_index[tail].key = KV_KEY_NONE;
+#ifdef KV_STATS_MODE
+		kv_stats.dropped++;
+#endif
+		return SUCCESS;
+	}
+
+	if (kv_read(kv_index[tail].slot) == ERROR)
+	{
+		return ERROR;
+	}
+	memcpy(val, kv_rec + KV_OFS_VALUE, kv_rec[KV_OFS_LEN]);
+	if (kv_append(tail, kv_index[tail].key, val, kv_rec[KV_OFS_LEN]) == ERROR)
+	{
+		return ERROR;
+	}
+#ifdef KV_STATS_MODE
+	kv_stats.moved++;
+#endif
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Compact until a record can be appended and one slot is
+ *              still free for the next compaction move
+ * @param[in]	None
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status kv_reserve (void)
+{
+	uint32_t n;
+
+	for (n = 0; kv_free() < 2; n++)
+	{
+		if ((n == KV_SLOTS) || (kv_step() == ERROR)) return ERROR;
+#ifdef KV_STATS_MODE
+		kv_stats.forced++;
+#endif
+	}
+	return SUCCESS;
+}
+
+/* End of Private Functions --------------------------------------------------- */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup NVM_KV_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Rebuild the RAM index with one sequential scan of the
+ *              log, the head follows the newest valid record. A record
+ *              torn by a power cut fails its CRC and is ignored.
+ * @param[in]	None
+ * @return 		SUCCESS, ERROR if the device cannot be read
+ **********************************************************************/
+Status KV_Init (void)
+{
+	uint32_t slot, i, seq;
+	uint32_t newest = KV_SEQ_NONE, newest_slot = 0, oldest = 0;
+	uint8_t *rec;
+	int32_t e;
+	uint16_t key;
+#ifdef KV_STATS_MODE
+	uint32_t start;
+
+	DWT_CycleInit();
+	memset(&kv_stats, 0, sizeof(kv_stats));
+	start = DWT_CYCCNT;
+#endif
+
+	kv_ready = 0;
+	for (i = 0; i < KV_KEYS_MAX; i++)
+	{
+		kv_index[i].key = KV_KEY_NONE;
+	}
+
+	for (slot = 0; slot < KV_SLOTS; slot++)
+	{
+		if ((slot % (KV_SCAN_CHUNK / KV_REC_SIZE)) == 0)
+		{
+			i = MIN(KV_SCAN_CHUNK, KV_SIZE - slot * KV_REC_SIZE);
+			if (NVM_Read(KV_DEV, KV_BASE + slot * KV_REC_SIZE, kv_buf, i) == ERROR)
+			{
+				return ERROR;
+			}
+		}
+		rec = kv_buf + (slot % (KV_SCAN_CHUNK / KV_REC_SIZE)) * KV_REC_SIZE;
+		if (kv_valid(rec) == ERROR) continue;
+
+		seq = kv_get32(rec + KV_OFS_SEQ);
+		key = rec[KV_OFS_KEY] | (rec[KV_OFS_KEY + 1] << 8);
+
+		if ((newest == KV_SEQ_NONE) || (seq > newest))
+		{
+			newest = seq;
+			newest_slot = slot;
+			oldest = kv_get32(rec + KV_OFS_OLDEST);
+		}
+
+		e = kv_find(key);
+		if (e < 0)
+		{
+			e = kv_find(KV_KEY_NONE);
+		}
+		if (e < 0)
+		{
+			/* Index full of other keys: keep the newest ones, the live
+			 * keys always fit and sort above the dead ones */
+			e = kv_tail();
+			if (seq < kv_index[e].seq) continue;
+		}
+		else if ((kv_index[e].key == key) && (seq < kv_index[e].seq))
+		{
+			continue;
+		}
+
+		kv_index[e].seq = seq;
+		kv_index[e].key = key;
+		kv_index[e].slot = slot;
+		kv_index[e].tomb = (rec[KV_OFS_LEN] == KV_TOMBSTONE);
+	}
+
+	if (newest == KV_SEQ_NONE)
+	{
+		kv_head = 0;
+		kv_seq = 0;
+	}
+	else
+	{
+		kv_head = (newest_slot + 1) % KV_SLOTS;
+		kv_seq = newest + 1;
+
+		for (i = 0; i < KV_KEYS_MAX; i++)
+		{
+			if (kv_index[i].seq < oldest) kv_index[i].key = KV_KEY_NONE;
+		}
+	}
+
+	kv_ready = 1;
+#ifdef KV_STATS_MODE
+	kv_stats.scan_cycles = DWT_CYCCNT - start;
+#endif
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Read the value of a key
+ * @param[in]	- key: key
+ * @param[out]	- buf: value, KV_VALUE_MAX bytes
+ * @param[out]	- len: value length
+ * @return 		SUCCESS, ERROR if the key is not set or its record fails
+ **********************************************************************/
+Status KV_Get (uint16_t key, uint8_t *buf, uint8_t *len)
+{
+	int32_t e = kv_find(key);
+
+	if (!kv_ready || (key == KV_KEY_NONE) || (e < 0) || kv_index[e].tomb) return ERROR;
+	if (kv_read(kv_index[e].slot) == ERROR) return ERROR;
+
+	*len = kv_rec[KV_OFS_LEN];
+	memcpy(buf, kv_rec + KV_OFS_VALUE, *len);
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief		Set the value of a key by appending a record, nothing is
+ *              written if the key already holds the same value
+ * @param[in]	- key: key, 0x0000 to 0xFFFE
+ * @param[in]	- val: value
+ * @param[in]	- len: value length, up to KV_VALUE_MAX
+ * @return 		SUCCESS, ERROR on a write error or a full index
+ **********************************************************************/
+Status KV_Set (uint16_t key, uint8_t *val, uint8_t len)
+{
+	int32_t e;
+	Status ret;
+#ifdef KV_STATS_MODE
+	uint32_t start = DWT_CYCCNT;
+#endif
+
+	if (!kv_ready || (key == KV_KEY_NONE) || (len > KV_VALUE_MAX)) return ERROR;
+
+	e = kv_find(key);
+	if ((e >= 0) && !kv_index[e].tomb && (kv_read(kv_index[e].slot) == SUCCESS) &&
+		(kv_rec[KV_OFS_LEN] == len) && (memcmp(kv_rec + KV_OFS_VALUE, val, len) == 0))
+	{
+#ifdef KV_STATS_MODE
+		kv_stats.unchanged++;
+#endif
+		return SUCCESS;
+	}
+
+	ret = kv_reserve();
+	if (ret == SUCCESS)
+	{
+		/* Compaction may have released the key's tombstone */
+		e = kv_find(key);
+		if (e < 0) e = kv_find(KV_KEY_NONE);
+		ret = (e < 0) ? ERROR : kv_append(e, key, val, len);
+	}
+
+#ifdef KV_STATS_MODE
+	kv_stats.set_cycles = DWT_CYCCNT - start;
+	kv_stats.set_max = MAX(kv_stats.set_max, kv_stats.set_cycles);
+#endif
+	return ret;
+}
+
+
+/*********************************************************************//**
+ * @brief		Delete a key, a tombstone record hides its older records
+ *              until compaction releases it
+ * @param[in]	- key: key
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status KV_Delete (uint16_t key)
+{
+	int32_t e;
+
+	if (!kv_ready || (key == KV_KEY_NONE)) return ERROR;
+
+	e = kv_find(key);
+	if ((e < 0) || kv_index[e].tomb) return SUCCESS;
+
+	if (kv_reserve() == ERROR) return ERROR;
+
+	e = kv_find(key);
+	return kv_append(e, key, NULL, KV_TOMBSTONE);
+}
+
+
+/*********************************************************************//**
+ * @brief		Background compaction: one step, at most one record
+ *              write, while fewer than KV_FREE_MIN slots are free.
+ *              Call from the main loop so KV_Set() rarely compacts.
+ * @param[in]	None
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status KV_Compact (void)
+{
+	if (!kv_ready) return ERROR;
+	if (kv_free() >= KV_FREE_MIN) return SUCCESS;
+
+	return kv_step();
+}
+
+
+#ifdef KV_STATS_MODE
+/*********************************************************************//**
+ * @brief		Read the store counters
+ * @param[out]	- stats: filled with a copy of the counters
+ * @return 		None
+ **********************************************************************/
+void KV_GetStats (KV_STATS_Type *stats)
+{
+	*stats = kv_stats;
+}
+#endif
+
+/**
+ * @}
+ */
+
+/* End of Public Functions ---------------------------------------------------- */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
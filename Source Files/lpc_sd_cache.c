@@ -0,0 +1,442 @@
+/******************************************************************//**
+* @file		lpc_sd_cache.c
+* @brief	Contains all functions support for the SD sector cache
+*           on LPC17xx
+* @version	1.0
+* @date		10. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup SD_CACHE
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc_sd_cache.h"
+#include "string.h"
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+
+
+/* Private Types -------------------------------------------------------------- */
+/** @defgroup SD_CACHE_Private_Types SD_CACHE Private Types
+ * @{
+ */
+
+/** @brief Tag of one cache line, the data is in AHB SRAM */
+typedef struct
+{
+	uint32_t sector;			/**< Card sector held by the line */
+	uint32_t stamp;				/**< LRU clock at last use, 0 if the line is free */
+	uint8_t dirty;				/**< Line is newer than the card */
+}SD_CACHE_LINE_Type;
+
+/**
+ * @}
+ */
+
+
+/* Private Variables ---------------------------------------------------------- */
+/** @defgroup SD_CACHE_Private_Variables SD_CACHE Private Variables
+ * @{
+ */
+
+static SD_CACHE_LINE_Type sdc_line[SD_CACHE_SECTORS];
+static uint8_t (* const sdc_data)[SD_BLOCK_SIZE] = (uint8_t (*)[SD_BLOCK_SIZE])SD_CACHE_BASE;
+
+static uint32_t sdc_clock;			// LRU clock, bumped on every line use
+static uint32_t sdc_next;			// Sector after the last access, for read-ahead
+static SD_CACHE_STATS_Type sdc_stats;
+
+/**
+ * @}
+ */
+
+
+/* Private Functions ---------------------------------------------------------- */
+static int32_t sdc_find (uint32_t sector);
+static void sdc_touch (uint32_t line);
+static sd_error sdc_flush (uint32_t line);
+static sd_error sdc_alloc (uint32_t sector, uint32_t *line);
+static sd_error sdc_fill (uint32_t sector, uint32_t want, uint32_t *line);
+
+
+/*********************************************************************//**
+ * @brief		Look up the line holding a sector
+ * @param[in]	- sector: card sector
+ * @return 		line index, or -1 if the sector is not cached
+ **********************************************************************/
+static int32_t sdc_find (uint32_t sector)
+{
+	uint32_t i;
+
+	for (i = 0; i < SD_CACHE_SECTORS; i++)
+	{
+		if ((sdc_line[i].stamp != 0) && (sdc_line[i].sector == sector))
+		{
+			return i;
+		}
+	}
+	return (-1);
+}
+
+
+/*********************************************************************//**
+ * @brief		Mark a line as most recently used
+ * @param[in]	- line: line index
+ * @return 		None
+ **********************************************************************/
+static void sdc_touch (uint32_t line)
+{
+	sdc_line[line].stamp = ++sdc_clock;
+}
+
+
+/*********************************************************************//**
+ * @brief		Write back a dirty line together with the dirty lines of
+ * 				the sectors following it, in one CMD25 stream
+ * @param[in]	- line: index of a dirty line
+ * @return 		SD_OK or error code of SD_WriteBlocksV()
+ **********************************************************************/
+static sd_error sdc_flush (uint32_t line)
+{
+	uint8_t *bufs[SD_CACHE_SECTORS];
+	uint32_t run[SD_CACHE_SECTORS];
+	uint32_t sector, n, i;
+	int32_t k;
+	sd_error ret;
+
+	sector = sdc_line[line].sector;
+	n = 0;
+	k = line;
+	do
+	{
+		bufs[n] = sdc_data[k];
+		run[n++] = k;
+		k = sdc_find(sector + n);
+	} while ((k >= 0) && (sdc_line[k].dirty) && (n < SD_CACHE_SECTORS));
+
+	ret = SD_WriteBlocksV(sector, bufs, n);
+	if (ret == SD_OK)
+	{
+		for (i = 0; i < n; i++)
+		{
+			sdc_line[run[i]].dirty = 0;
+		}
+		sdc_stats.writebacks += n;
+	}
+	return ret;
+}
+
+
+/*********************************************************************//**
+ * @brief		Take a line for a sector: a free one, or else the least
+ * 				recently used, written back first if dirty. The line is
+ * 				tagged and touched but holds no data yet.
+ * @param[in]	- sector: card sector the line will hold
+ * @param[out]	- line: index of the line
+ * @return 		SD_OK or write back error
+ **********************************************************************/
+static sd_error sdc_alloc (uint32_t sector, uint32_t *line)
+{
+	uint32_t i, victim;
+	sd_error ret;
+
+	victim = 0;
+	for (i = 0; i < SD_CACHE_SECTORS; i++)
+	{
+		if (sdc_line[i].stamp < sdc_line[victim].stamp)
+		{
+			victim = i;
+		}
+	}
+
+	if (sdc_line[victim].stamp != 0)
+	{
+		if (sdc_line[victim].dirty)
+		{
+			ret = sdc_flush(victim);
+			if (ret != SD_OK) return ret;
+		}
+		sdc_stats.evictions++;
+	}
+
+	sdc_line[victim].sector = sector;
+	sdc_line[victim].dirty = 0;
+	sdc_touch(victim);
+	*line = victim;
+	return SD_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Bring a missing sector in. A miss right after the last
+ * 				access is taken as a sequential run and reads
+ * 				SD_CACHE_READAHEAD sectors, otherwise only the sectors
+ * 				still wanted by the request are read. The run stops at
+ * 				the first sector that is already cached.
+ * @param[in]	- sector: missing sector
+ * 				- want: sectors left in the request, sector included
+ * @param[out]	- line: line now holding sector
+ * @return 		SD_OK or error code
+ **********************************************************************/
+static sd_error sdc_fill (uint32_t sector, uint32_t want, uint32_t *line)
+{
+	uint8_t *bufs[SD_CACHE_READAHEAD];
+	uint32_t run[SD_CACHE_READAHEAD];
+	uint32_t n, i;
+	sd_error ret = SD_OK;
+
+	n = (sector == sdc_next) ? SD_CACHE_READAHEAD : MIN(want, SD_CACHE_READAHEAD);
+	for (i = 1; i < n; i++)
+	{
+		if (sdc_find(sector + i) >= 0) break;
+	}
+	n = i;
+
+	for (i = 0; i < n; i++)
+	{
+		ret = sdc_alloc(sector + i, &run[i]);
+		if (ret != SD_OK) break;
+		bufs[i] = sdc_data[run[i]];
+	}
+	if (ret == SD_OK)
+	{
+		ret = SD_ReadBlocksV(sector, bufs, n);
+	}
+	if (ret != SD_OK)
+	{
+		// Lines taken so far hold nothing valid
+		while (i--)
+		{
+			sdc_line[run[i]].stamp = 0;
+		}
+		return ret;
+	}
+
+	if (n > want)
+	{
+		sdc_stats.prefetched += n - want;
+	}
+	*line = run[0];
+	return SD_OK;
+}
+
+/* End of Private Functions --------------------------------------------------- */
+
+
+/** @addtogroup SD_CACHE_Public_Functions
+ * @{
+ */
+
+/* Public Functions ----------------------------------------------------------- */
+/*********************************************************************//**
+ * @brief		Empty the cache, lines not synced are dropped. Call it
+ * 				after SD_Init() and whenever the card is changed.
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void SD_CacheInit (void)
+{
+	uint32_t i;
+
+	for (i = 0; i < SD_CACHE_SECTORS; i++)
+	{
+		sdc_line[i].stamp = 0;
+		sdc_line[i].dirty = 0;
+	}
+	sdc_clock = 0;
+	sdc_next = 0xFFFFFFFF;
+	SD_CacheResetStats();
+}
+
+
+/*********************************************************************//**
+ * @brief		Read sectors through the cache. Transfers of
+ * 				SD_CACHE_BYPASS sectors or more are read straight from
+ * 				the card, with newer cached lines copied over them.
+ * @param[in]	- sector: first sector
+ * 				- buf: destination of count * SD_BLOCK_SIZE bytes
+ * 				- count: number of sectors
+ * @return 		SD_OK or error code
+ **********************************************************************/
+sd_error SD_CacheRead (uint32_t sector, uint8_t *buf, uint32_t count)
+{
+	uint32_t line, i;
+	int32_t k;
+	sd_error ret;
+
+	if ((buf == NULL) || (count == 0)) return SD_CMD_BAD_PARAMETER;
+
+	if (count >= SD_CACHE_BYPASS)
+	{
+		ret = SD_ReadBlocks(sector, buf, count);
+		if (ret != SD_OK) return ret;
+		for (i = 0; i < SD_CACHE_SECTORS; i++)
+		{
+			if ((sdc_line[i].stamp != 0) && (sdc_line[i].dirty) && \
+				((sdc_line[i].sector - sector) < count))
+			{
+				memcpy(buf + ((sdc_line[i].sector - sector) * SD_BLOCK_SIZE), sdc_data[i], SD_BLOCK_SIZE);
+			}
+		}
+		sdc_stats.bypassed += count;
+		sdc_next = sector + count;
+		return SD_OK;
+	}
+
+	while (count)
+	{
+		k = sdc_find(sector);
+		if (k >= 0)
+		{
+			line = k;
+			sdc_stats.hits++;
+		}
+		else
+		{
+			sdc_stats.misses++;
+			ret = sdc_fill(sector, count, &line);
+			if (ret != SD_OK) return ret;
+		}
+		memcpy(buf, sdc_data[line], SD_BLOCK_SIZE);
+		sdc_touch(line);
+
+		buf += SD_BLOCK_SIZE;
+		sector++;
+		count--;
+		sdc_next = sector;
+	}
+	return SD_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Write sectors into the cache, the card is updated when a
+ * 				line is evicted or on SD_CacheSync(). Transfers of
+ * 				SD_CACHE_BYPASS sectors or more are written straight to
+ * 				the card and refresh the lines that hold them.
+ * @param[in]	- sector: first sector
+ * 				- buf: source of count * SD_BLOCK_SIZE bytes
+ * 				- count: number of sectors
+ * @return 		SD_OK or error code
+ **********************************************************************/
+sd_error SD_CacheWrite (uint32_t sector, uint8_t *buf, uint32_t count)
+{
+	uint32_t line, i;
+	int32_t k;
+	sd_error ret;
+
+	if ((buf == NULL) || (count == 0)) return SD_CMD_BAD_PARAMETER;
+
+	if (count >= SD_CACHE_BYPASS)
+	{
+		ret = SD_WriteBlocks(sector, buf, count);
+		if (ret != SD_OK) return ret;
+		for (i = 0; i < SD_CACHE_SECTORS; i++)
+		{
+			if ((sdc_line[i].stamp != 0) && ((sdc_line[i].sector - sector) < count))
+			{
+				memcpy(sdc_data[i], buf + ((sdc_line[i].sector - sector) * SD_BLOCK_SIZE), SD_BLOCK_SIZE);
+				sdc_line[i].dirty = 0;
+			}
+		}
+		sdc_stats.bypassed += count;
+		return SD_OK;
+	}
+
+	while (count)
+	{
+		k = sdc_find(sector);
+		if (k >= 0)
+		{
+			line = k;
+			sdc_stats.hits++;
+		}
+		else
+		{
+			// Whole sector is overwritten, no need to read it first
+			sdc_stats.misses++;
+			ret = sdc_alloc(sector, &line);
+			if (ret != SD_OK) return ret;
+		}
+		memcpy(sdc_data[line], buf, SD_BLOCK_SIZE);
+		sdc_line[line].dirty = 1;
+		sdc_touch(line);
+
+		buf += SD_BLOCK_SIZE;
+		sector++;
+		count--;
+	}
+	return SD_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Write all dirty lines back to the card, lowest sector
+ * 				first so that consecutive sectors share a CMD25 stream
+ * @param[in]	None
+ * @return 		SD_OK or the first write error, the failed lines stay
+ * 				dirty
+ **********************************************************************/
+sd_error SD_CacheSync (void)
+{
+	uint32_t i;
+	int32_t first;
+	sd_error ret;
+
+	while (1)
+	{
+		first = -1;
+		for (i = 0; i < SD_CACHE_SECTORS; i++)
+		{
+			if ((sdc_line[i].stamp != 0) && (sdc_line[i].dirty) && \
+				((first < 0) || (sdc_line[i].sector < sdc_line[first].sector)))
+			{
+				first = i;
+			}
+		}
+		if (first < 0) return SD_OK;
+
+		ret = sdc_flush(first);
+		if (ret != SD_OK) return ret;
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief		Read the cache counters
+ * @param[out]	- stats: filled with a copy of the counters
+ * @return 		None
+ **********************************************************************/
+void SD_CacheGetStats (SD_CACHE_STATS_Type *stats)
+{
+	*stats = sdc_stats;
+}
+
+
+/*********************************************************************//**
+ * @brief		Clear the cache counters
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void SD_CacheResetStats (void)
+{
+	memset(&sdc_stats, 0, sizeof(sdc_stats));
+}
+
+/**
+ * @}
+ */
+
+/* End of Public Functions ---------------------------------------------------- */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -0,0 +1,1008 @@
+/******************************************************************//**
+* @file		lpc_sd_fat.c
+* @brief	Contains all functions support for the FAT16/FAT32 file
+*           system on the SD card
+* @version	1.0
+* @date		10. Dec. 2013
+* @author	Dwijay.Edutech Learning Solutions
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup FAT
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc_sd_fat.h"
+#include "string.h"
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+
+
+/* Private Macros ------------------------------------------------------------- */
+/** @defgroup FAT_Private_Macros FAT Private Macros
+ * @{
+ */
+
+#define FAT_NO_SECTOR		0xFFFFFFFF
+#define FAT_EOC				0x0FFFFFFF	/* End of chain, FAT16 keeps the low half */
+#define FAT_ENTRY_SIZE		32
+
+/* Directory entry attributes */
+#define FAT_ATTR_VOLUME		0x08		/* Also set on long name entries */
+#define FAT_ATTR_DIR		0x10
+#define FAT_ATTR_ARCHIVE	0x20
+
+/* Unaligned little endian fields of the on-disk structures */
+#define FAT_LD16(p)			((uint16_t)((p)[0] | ((p)[1] << 8)))
+#define FAT_LD32(p)			((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | \
+							((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24))
+
+#define FAT_VALID(c)		(((c) >= 2) && ((c) < (fat_vol.clusters + 2)))
+#define FAT_CLUSTER_MASK	((SD_BLOCK_SIZE << fat_vol.shift) - 1)
+
+/**
+ * @}
+ */
+
+
+/* Private Types -------------------------------------------------------------- */
+/** @defgroup FAT_Private_Types FAT Private Types
+ * @{
+ */
+
+/** @brief Geometry of the mounted volume */
+typedef struct
+{
+	uint32_t fat_lba;			/**< First sector of the first FAT */
+	uint32_t fat_size;			/**< Sectors per FAT */
+	uint32_t root_lba;			/**< FAT16 root directory sector */
+	uint32_t root_sectors;		/**< FAT16 root directory sectors */
+	uint32_t root_cluster;		/**< FAT32 root directory cluster */
+	uint32_t data_lba;			/**< Sector of cluster 2 */
+	uint32_t clusters;			/**< Data clusters, numbered from 2 */
+	uint32_t free_hint;			/**< Where the next free cluster search starts */
+	uint32_t fsinfo_lba;		/**< FAT32 FSInfo sector, 0 if none */
+	uint8_t type;				/**< 16 or 32, 0 if not mounted */
+	uint8_t nfats;				/**< FAT copies, all of them are updated */
+	uint8_t shift;				/**< log2 of the sectors per cluster */
+	uint8_t fsinfo_stale;		/**< FSInfo free count marked unknown */
+}FAT_VOLUME_Type;
+
+/**
+ * @}
+ */
+
+
+/* Private Variables ---------------------------------------------------------- */
+/** @defgroup FAT_Private_Variables FAT Private Variables
+ * @{
+ */
+
+static FAT_VOLUME_Type fat_vol;
+
+/* Sector window for directory entries and partial data sectors */
+static uint8_t fat_buf[SD_BLOCK_SIZE];
+static uint32_t fat_buf_lba = FAT_NO_SECTOR;
+
+/* Sector window on the FAT, written to every copy when it moves */
+static uint8_t fat_tab[SD_BLOCK_SIZE];
+static uint32_t fat_tab_lba = FAT_NO_SECTOR;
+static uint8_t fat_tab_dirty;
+
+/**
+ * @}
+ */
+
+
+/* Private Functions ---------------------------------------------------------- */
+static void fat_st16 (uint8_t *p, uint16_t val);
+static void fat_st32 (uint8_t *p, uint32_t val);
+static fat_error fat_load (uint32_t lba);
+static fat_error fat_store (void);
+static fat_error fat_tab_flush (void);
+static fat_error fat_get (uint32_t cluster, uint32_t *next);
+static fat_error fat_set (uint32_t cluster, uint32_t val);
+static fat_error fat_run (uint32_t cluster, uint32_t *end);
+static fat_error fat_alloc (uint32_t prev, uint32_t *first, uint32_t *count);
+static fat_error fat_step (FAT_FILE_Type *file);
+static fat_error fat_seek (FAT_FILE_Type *file, uint32_t offset);
+static fat_error fat_trim (FAT_FILE_Type *file);
+static fat_error fat_name (const char **path, uint8_t *name);
+static fat_error fat_dir_find (uint32_t dir, const uint8_t *name, uint32_t *sector, uint16_t *offset);
+
+
+/*********************************************************************//**
+ * @brief		Store little endian 16/32 bit fields
+ * @param[in]	- p: destination, any alignment
+ * 				- val: value to store
+ * @return 		None
+ **********************************************************************/
+static void fat_st16 (uint8_t *p, uint16_t val)
+{
+	p[0] = (uint8_t)val;
+	p[1] = (uint8_t)(val >> 8);
+}
+
+static void fat_st32 (uint8_t *p, uint32_t val)
+{
+	fat_st16(p, (uint16_t)val);
+	fat_st16(p + 2, (uint16_t)(val >> 16));
+}
+
+
+/*********************************************************************//**
+ * @brief		Bring a sector into fat_buf through the sector cache
+ * @param[in]	- lba: card sector
+ * @return 		FAT_OK or FAT_ERR_DISK
+ **********************************************************************/
+static fat_error fat_load (uint32_t lba)
+{
+	if (lba == fat_buf_lba) return FAT_OK;
+
+	if (SD_CacheRead(lba, fat_buf, 1) != SD_OK)
+	{
+		fat_buf_lba = FAT_NO_SECTOR;
+		return FAT_ERR_DISK;
+	}
+	fat_buf_lba = lba;
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Write fat_buf back to its sector in the cache
+ * @param[in]	None
+ * @return 		FAT_OK or FAT_ERR_DISK
+ **********************************************************************/
+static fat_error fat_store (void)
+{
+	if (SD_CacheWrite(fat_buf_lba, fat_buf, 1) != SD_OK) return FAT_ERR_DISK;
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Write a modified FAT window to all FAT copies
+ * @param[in]	None
+ * @return 		FAT_OK or FAT_ERR_DISK
+ **********************************************************************/
+static fat_error fat_tab_flush (void)
+{
+	uint32_t i;
+
+	if (fat_tab_dirty)
+	{
+		for (i = 0; i < fat_vol.nfats; i++)
+		{
+			if (SD_CacheWrite(fat_tab_lba + (i * fat_vol.fat_size), fat_tab, 1) != SD_OK)
+			{
+				return FAT_ERR_DISK;
+			}
+		}
+		fat_tab_dirty = 0;
+	}
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Read the FAT entry of a cluster
+ * @param[in]	- cluster: valid cluster number
+ * @param[out]	- next: next cluster, 0 if free, FAT_EOC at the end of
+ * 				  the chain (FAT16 end marks are widened to it)
+ * @return 		FAT_OK or FAT_ERR_DISK
+ **********************************************************************/
+static fat_error fat_get (uint32_t cluster, uint32_t *next)
+{
+	uint32_t offset, lba;
+	fat_error ret;
+
+	offset = cluster << ((fat_vol.type == 32) ? 2 : 1);
+	lba = fat_vol.fat_lba + (offset / SD_BLOCK_SIZE);
+	offset %= SD_BLOCK_SIZE;
+
+	if (lba != fat_tab_lba)
+	{
+		ret = fat_tab_flush();
+		if (ret != FAT_OK) return ret;
+		if (SD_CacheRead(lba, fat_tab, 1) != SD_OK)
+		{
+			fat_tab_lba = FAT_NO_SECTOR;
+			return FAT_ERR_DISK;
+		}
+		fat_tab_lba = lba;
+	}
+
+	if (fat_vol.type == 32)
+	{
+		*next = FAT_LD32(fat_tab + offset) & 0x0FFFFFFF;
+	}
+	else
+	{
+		*next = FAT_LD16(fat_tab + offset);
+		if (*next >= 0xFFF8) *next = FAT_EOC;
+	}
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Write the FAT entry of a cluster
+ * @param[in]	- cluster: valid cluster number
+ * 				- val: next cluster, 0 to free, FAT_EOC to end the chain
+ * @return 		FAT_OK or FAT_ERR_DISK
+ **********************************************************************/
+static fat_error fat_set (uint32_t cluster, uint32_t val)
+{
+	uint32_t old, offset;
+	fat_error ret;
+
+	// Loads the window holding the entry
+	ret = fat_get(cluster, &old);
+	if (ret != FAT_OK) return ret;
+
+	offset = (cluster << ((fat_vol.type == 32) ? 2 : 1)) % SD_BLOCK_SIZE;
+	if (fat_vol.type == 32)
+	{
+		// Upper 4 bits are reserved and kept
+		val = (FAT_LD32(fat_tab + offset) & 0xF0000000) | (val & 0x0FFFFFFF);
+		fat_st32(fat_tab + offset, val);
+	}
+	else
+	{
+		fat_st16(fat_tab + offset, (uint16_t)val);
+	}
+	fat_tab_dirty = 1;
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Follow the chain from a cluster while it stays contiguous,
+ * 				so that a run of clusters is read with one CMD18
+ * @param[in]	- cluster: first cluster of the run
+ * @param[out]	- end: first cluster after the run
+ * @return 		FAT_OK or FAT_ERR_DISK
+ **********************************************************************/
+static fat_error fat_run (uint32_t cluster, uint32_t *end)
+{
+	uint32_t next, c;
+	fat_error ret;
+
+	for (c = cluster; (c - cluster) < (FAT_RUN_MAX - 1); c++)
+	{
+		ret = fat_get(c, &next);
+		if (ret != FAT_OK) return ret;
+		if (next != (c + 1)) break;
+	}
+	*end = c + 1;
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Allocate up to FAT_PREALLOC contiguous clusters as one
+ * 				chain, right after prev when that cluster is free
+ * @param[in]	- prev: last cluster of the file, 0 for an empty file
+ * @param[out]	- first: first allocated cluster
+ * 				- count: number of clusters in the new run
+ * @return 		FAT_OK, FAT_ERR_FULL or FAT_ERR_DISK
+ **********************************************************************/
+static fat_error fat_alloc (uint32_t prev, uint32_t *first, uint32_t *count)
+{
+	uint32_t start, c, n, i, val;
+	fat_error ret;
+
+	start = FAT_VALID(prev + 1) ? (prev + 1) : fat_vol.free_hint;
+
+	// First free cluster from start on, wrapping around
+	for (i = 0; i < fat_vol.clusters; i++)
+	{
+		c = 2 + ((start - 2 + i) % fat_vol.clusters);
+		ret = fat_get(c, &val);
+		if (ret != FAT_OK) return ret;
+		if (val == 0) break;
+	}
+	if (i == fat_vol.clusters) return FAT_ERR_FULL;
+
+	for (n = 1; (n < FAT_PREALLOC) && FAT_VALID(c + n); n++)
+	{
+		ret = fat_get(c + n, &val);
+		if (ret != FAT_OK) return ret;
+		if (val != 0) break;
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		ret = fat_set(c + i, (i < (n - 1)) ? (c + i + 1) : FAT_EOC);
+		if (ret != FAT_OK) return ret;
+	}
+	if (FAT_VALID(prev))
+	{
+		ret = fat_set(prev, c);
+		if (ret != FAT_OK) return ret;
+	}
+	fat_vol.free_hint = FAT_VALID(c + n) ? (c + n) : 2;
+
+	// The free count is not tracked, mark it unknown once
+	if ((fat_vol.fsinfo_lba != 0) && (fat_vol.fsinfo_stale == 0))
+	{
+		ret = fat_load(fat_vol.fsinfo_lba);
+		if (ret != FAT_OK) return ret;
+		if ((FAT_LD32(fat_buf) == 0x41615252) && (FAT_LD32(fat_buf + 484) == 0x61417272))
+		{
+			fat_st32(fat_buf + 488, 0xFFFFFFFF);
+			ret = fat_store();
+			if (ret != FAT_OK) return ret;
+		}
+		fat_vol.fsinfo_stale = 1;
+	}
+
+	*first = c;
+	*count = n;
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Move to the cluster holding byte pos, pos being at a
+ * 				cluster boundary. Inside a known run no FAT lookup is
+ * 				needed; appended files get a new run at the chain end.
+ * @param[in]	- file: open file
+ * @return 		FAT_OK or error code
+ **********************************************************************/
+static fat_error fat_step (FAT_FILE_Type *file)
+{
+	uint32_t next, count;
+	fat_error ret;
+
+	if ((file->pos != 0) && ((file->cluster + 1) < file->run_end))
+	{
+		file->cluster++;
+		return FAT_OK;
+	}
+
+	if (file->pos == 0)
+	{
+		next = file->first;
+	}
+	else
+	{
+		ret = fat_get(file->cluster, &next);
+		if (ret != FAT_OK) return ret;
+	}
+
+	if (FAT_VALID(next))
+	{
+		file->cluster = next;
+		return fat_run(next, &file->run_end);
+	}
+
+	if (file->mode != FAT_MODE_APPEND) return FAT_ERR_CHAIN;
+
+	ret = fat_alloc((file->pos == 0) ? 0 : file->cluster, &next, &count);
+	if (ret != FAT_OK) return ret;
+	if (file->pos == 0)
+	{
+		file->first = next;
+		file->dirty = 1;
+	}
+	file->cluster = next;
+	file->run_end = next + count;
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Advance the position, walking the chain cluster by cluster
+ * @param[in]	- file: open file
+ * 				- offset: new position, not below the current one
+ * @return 		FAT_OK or error code
+ **********************************************************************/
+static fat_error fat_seek (FAT_FILE_Type *file, uint32_t offset)
+{
+	uint32_t n;
+	fat_error ret;
+
+	while (file->pos < offset)
+	{
+		if ((file->pos & FAT_CLUSTER_MASK) == 0)
+		{
+			ret = fat_step(file);
+			if (ret != FAT_OK) return ret;
+		}
+		n = (FAT_CLUSTER_MASK + 1) - (file->pos & FAT_CLUSTER_MASK);
+		file->pos += MIN(n, offset - file->pos);
+	}
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Free the clusters preallocated past the end of an
+ * 				appended file
+ * @param[in]	- file: file open for append, pos at its end
+ * @return 		FAT_OK or FAT_ERR_DISK
+ **********************************************************************/
+static fat_error fat_trim (FAT_FILE_Type *file)
+{
+	uint32_t c, next;
+	fat_error ret;
+
+	if (file->size == 0)
+	{
+		c = file->first;
+		if (c != 0)
+		{
+			file->first = 0;
+			file->dirty = 1;
+		}
+	}
+	else
+	{
+		ret = fat_get(file->cluster, &c);
+		if (ret != FAT_OK) return ret;
+		if (FAT_VALID(c))
+		{
+			ret = fat_set(file->cluster, FAT_EOC);
+			if (ret != FAT_OK) return ret;
+		}
+	}
+
+	while (FAT_VALID(c))
+	{
+		ret = fat_get(c, &next);
+		if (ret != FAT_OK) return ret;
+		ret = fat_set(c, 0);
+		if (ret != FAT_OK) return ret;
+		c = next;
+	}
+	file->run_end = file->cluster + 1;
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Convert the next path component to a padded 8.3 name
+ * @param[in]	- path: component start, moved past it and its '/'
+ * @param[out]	- name: 11 byte directory entry name
+ * @return 		FAT_OK or FAT_ERR_NAME
+ **********************************************************************/
+static fat_error fat_name (const char **path, uint8_t *name)
+{
+	const char *p = *path;
+	uint32_t i = 0, limit = 8;
+	char ch;
+
+	memset(name, ' ', 11);
+	while ((*p != '\0') && (*p != '/'))
+	{
+		ch = *p++;
+		if ((ch == '.') && (limit == 8) && (i != 0))
+		{
+			i = 8;
+			limit = 11;
+			continue;
+		}
+		if ((ch <= ' ') || (i >= limit) || (strchr("\"*+,./:;<=>?[\\]|", ch) != NULL))
+		{
+			return FAT_ERR_NAME;
+		}
+		if ((ch >= 'a') && (ch <= 'z'))
+		{
+			ch -= 'a' - 'A';
+		}
+		name[i++] = (uint8_t)ch;
+	}
+	if (i == 0) return FAT_ERR_NAME;
+
+	while (*p == '/') p++;
+	*path = p;
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Search a directory for a name, or for a free entry. The
+ * 				sector of the entry is left in fat_buf.
+ * @param[in]	- dir: first cluster, 0 for the FAT16 root directory
+ * 				- name: 11 byte 8.3 name, NULL to find a free entry
+ * @param[out]	- sector: sector of the entry
+ * 				- offset: entry offset in the sector
+ * @return 		FAT_OK, FAT_ERR_NOT_FOUND, FAT_ERR_DIR_FULL or FAT_ERR_DISK
+ **********************************************************************/
+static fat_error fat_dir_find (uint32_t dir, const uint8_t *name, uint32_t *sector, uint16_t *offset)
+{
+	uint32_t c = dir, lba, n, i, off;
+	uint8_t *e;
+	fat_error ret;
+
+	while (1)
+	{
+		if (dir == 0)
+		{
+			lba = fat_vol.root_lba;
+			n = fat_vol.root_sectors;
+		}
+		else
+		{
+			lba = fat_vol.data_lba + ((c - 2) << fat_vol.shift);
+			n = 1 << fat_vol.shift;
+		}
+
+		for (i = 0; i < n; i++)
+		{
+			ret = fat_load(lba + i);
+			if (ret != FAT_OK) return ret;
+
+			for (off = 0; off < SD_BLOCK_SIZE; off += FAT_ENTRY_SIZE)
+			{
+				e = fat_buf + off;
+				if (name == NULL)
+				{
+					if ((e[0] != 0x00) && (e[0] != 0xE5)) continue;
+				}
+				else
+				{
+					// 0x00 ends the directory, 0xE5 is a deleted entry
+					if (e[0] == 0x00) return FAT_ERR_NOT_FOUND;
+					if ((e[0] == 0xE5) || (e[11] & FAT_ATTR_VOLUME)) continue;
+					if (memcmp(e, name, 11) != 0) continue;
+				}
+				*sector = lba + i;
+				*offset = off;
+				return FAT_OK;
+			}
+		}
+
+		if (dir == 0) break;
+		ret = fat_get(c, &c);
+		if (ret != FAT_OK) return ret;
+		if (!FAT_VALID(c)) break;
+	}
+	return (name == NULL) ? FAT_ERR_DIR_FULL : FAT_ERR_NOT_FOUND;
+}
+
+/* End of Private Functions --------------------------------------------------- */
+
+
+/** @addtogroup FAT_Public_Functions
+ * @{
+ */
+
+/* Public Functions ----------------------------------------------------------- */
+/*********************************************************************//**
+ * @brief		Mount the FAT volume of the card: the first partition of
+ * 				an MBR, or a volume starting at sector 0. SD_Init() and
+ * 				SD_CacheInit() must have been called.
+ * @param[in]	None
+ * @return 		FAT_OK, FAT_ERR_NO_FS or FAT_ERR_DISK
+ **********************************************************************/
+fat_error FAT_Mount (void)
+{
+	uint32_t part, total, fat_size, spc, hint;
+	fat_error ret;
+
+	fat_vol.type = 0;
+	fat_buf_lba = FAT_NO_SECTOR;
+	fat_tab_lba = FAT_NO_SECTOR;
+	fat_tab_dirty = 0;
+
+	ret = fat_load(0);
+	if (ret != FAT_OK) return ret;
+	if (FAT_LD16(fat_buf + 510) != 0xAA55) return FAT_ERR_NO_FS;
+
+	// A boot sector has a jump and a BPB, otherwise take the MBR partition 1
+	part = 0;
+	if (!(((fat_buf[0] == 0xEB) || (fat_buf[0] == 0xE9)) && (FAT_LD16(fat_buf + 11) == SD_BLOCK_SIZE)))
+	{
+		part = FAT_LD32(fat_buf + 446 + 8);
+		if ((fat_buf[446 + 4] == 0) || (part == 0)) return FAT_ERR_NO_FS;
+		ret = fat_load(part);
+		if (ret != FAT_OK) return ret;
+		if (FAT_LD16(fat_buf + 510) != 0xAA55) return FAT_ERR_NO_FS;
+	}
+
+	spc = fat_buf[13];
+	fat_vol.nfats = fat_buf[16];
+	total = FAT_LD16(fat_buf + 19);
+	if (total == 0) total = FAT_LD32(fat_buf + 32);
+	fat_size = FAT_LD16(fat_buf + 22);
+	if (fat_size == 0) fat_size = FAT_LD32(fat_buf + 36);
+
+	if ((FAT_LD16(fat_buf + 11) != SD_BLOCK_SIZE) || (spc == 0) || (spc & (spc - 1)) || \
+		(fat_vol.nfats == 0) || (fat_size == 0))
+	{
+		return FAT_ERR_NO_FS;
+	}
+
+	for (fat_vol.shift = 0; (1UL << fat_vol.shift) < spc; fat_vol.shift++);
+	fat_vol.fat_size = fat_size;
+	fat_vol.fat_lba = part + FAT_LD16(fat_buf + 14);
+	fat_vol.root_lba = fat_vol.fat_lba + (fat_vol.nfats * fat_size);
+	fat_vol.root_sectors = ((FAT_LD16(fat_buf + 17) * FAT_ENTRY_SIZE) + SD_BLOCK_SIZE - 1) / SD_BLOCK_SIZE;
+	fat_vol.data_lba = fat_vol.root_lba + fat_vol.root_sectors;
+	if (total <= (fat_vol.data_lba - part)) return FAT_ERR_NO_FS;
+	fat_vol.clusters = (total - (fat_vol.data_lba - part)) >> fat_vol.shift;
+
+	// The cluster count alone decides the FAT type, FAT12 is not supported
+	if (fat_vol.clusters < 4085) return FAT_ERR_NO_FS;
+
+	fat_vol.free_hint = 2;
+	fat_vol.fsinfo_stale = 0;
+	fat_vol.fsinfo_lba = 0;
+	fat_vol.root_cluster = 0;
+	if (fat_vol.clusters < 65525)
+	{
+		if (fat_vol.root_sectors == 0) return FAT_ERR_NO_FS;
+		fat_vol.type = 16;
+		return FAT_OK;
+	}
+
+	fat_vol.root_cluster = FAT_LD32(fat_buf + 44);
+	if (FAT_LD16(fat_buf + 48) != 0)
+	{
+		fat_vol.fsinfo_lba = part + FAT_LD16(fat_buf + 48);
+	}
+	fat_vol.type = 32;
+
+	// Start cluster searches at the FSInfo hint when it is usable
+	if (fat_vol.fsinfo_lba != 0)
+	{
+		ret = fat_load(fat_vol.fsinfo_lba);
+		if (ret != FAT_OK) return ret;
+		hint = FAT_LD32(fat_buf + 492);
+		if ((FAT_LD32(fat_buf) == 0x41615252) && FAT_VALID(hint))
+		{
+			fat_vol.free_hint = hint;
+		}
+	}
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Open a file by path, e.g. "LOGS/TEMP.CSV". In append
+ * 				mode a missing file is created in its directory and the
+ * 				position is set to the end of the file.
+ * @param[out]	- file: file object, filled on success
+ * @param[in]	- path: '/' separated 8.3 names from the root directory
+ * 				- mode: FAT_MODE_READ or FAT_MODE_APPEND
+ * @return 		FAT_OK or error code
+ **********************************************************************/
+fat_error FAT_Open (FAT_FILE_Type *file, const char *path, uint8_t mode)
+{
+	uint8_t name[11], *e;
+	uint32_t dir, sector;
+	uint16_t offset;
+	fat_error ret;
+
+	file->mode = 0;
+	if (fat_vol.type == 0) return FAT_ERR_NOT_MOUNTED;
+	if ((mode != FAT_MODE_READ) && (mode != FAT_MODE_APPEND)) return FAT_ERR_MODE;
+
+	dir = fat_vol.root_cluster;
+	while (*path == '/') path++;
+	while (1)
+	{
+		ret = fat_name(&path, name);
+		if (ret != FAT_OK) return ret;
+		ret = fat_dir_find(dir, name, &sector, &offset);
+		if (*path == '\0') break;
+
+		// Intermediate components must be directories
+		if (ret != FAT_OK) return ret;
+		e = fat_buf + offset;
+		if ((e[11] & FAT_ATTR_DIR) == 0) return FAT_ERR_NOT_FOUND;
+		dir = FAT_LD16(e + 26);
+		if (fat_vol.type == 32)
+		{
+			dir |= (uint32_t)FAT_LD16(e + 20) << 16;
+		}
+		if (dir == 0) dir = fat_vol.root_cluster;
+	}
+
+	if ((ret == FAT_ERR_NOT_FOUND) && (mode == FAT_MODE_APPEND))
+	{
+		ret = fat_dir_find(dir, NULL, &sector, &offset);
+		if (ret != FAT_OK) return ret;
+		e = fat_buf + offset;
+		memset(e, 0, FAT_ENTRY_SIZE);
+		memcpy(e, name, 11);
+		e[11] = FAT_ATTR_ARCHIVE;
+		ret = fat_store();
+	}
+	if (ret != FAT_OK) return ret;
+
+	e = fat_buf + offset;
+	if (e[11] & FAT_ATTR_DIR) return FAT_ERR_NOT_FILE;
+
+	file->first = FAT_LD16(e + 26);
+	if (fat_vol.type == 32)
+	{
+		file->first |= (uint32_t)FAT_LD16(e + 20) << 16;
+	}
+	file->size = FAT_LD32(e + 28);
+	file->pos = 0;
+	file->cluster = 0;
+	file->run_end = 0;
+	file->dir_sector = sector;
+	file->dir_offset = offset;
+	file->mode = mode;
+	file->dirty = 0;
+
+	if (mode == FAT_MODE_APPEND)
+	{
+		ret = fat_seek(file, file->size);
+		if (ret != FAT_OK) file->mode = 0;
+	}
+	return ret;
+}
+
+
+/*********************************************************************//**
+ * @brief		Read from the current position. Whole sectors go to buf
+ * 				directly, a contiguous cluster run with a single CMD18;
+ * 				partial sectors are copied from the sector window.
+ * @param[in]	- file: file open for reading
+ * 				- buf: destination
+ * 				- len: bytes wanted
+ * @param[out]	- done: bytes read, less than len at the end of the file
+ * @return 		FAT_OK or error code
+ **********************************************************************/
+fat_error FAT_Read (FAT_FILE_Type *file, void *buf, uint32_t len, uint32_t *done)
+{
+	uint8_t *dst = buf;
+	uint32_t sector, sec, off, n;
+	fat_error ret = FAT_OK;
+
+	*done = 0;
+	if (file->mode != FAT_MODE_READ) return FAT_ERR_MODE;
+	len = MIN(len, file->size - file->pos);
+
+	while (len)
+	{
+		if ((file->pos & FAT_CLUSTER_MASK) == 0)
+		{
+			ret = fat_step(file);
+			if (ret != FAT_OK) break;
+		}
+		sec = (file->pos & FAT_CLUSTER_MASK) / SD_BLOCK_SIZE;
+		off = file->pos % SD_BLOCK_SIZE;
+		sector = fat_vol.data_lba + ((file->cluster - 2) << fat_vol.shift) + sec;
+
+		if ((off == 0) && (len >= SD_BLOCK_SIZE))
+		{
+			n = ((file->run_end - file->cluster) << fat_vol.shift) - sec;
+			n = MIN(n, len / SD_BLOCK_SIZE);
+			if (SD_CacheRead(sector, dst, n) != SD_OK)
+			{
+				ret = FAT_ERR_DISK;
+				break;
+			}
+			file->cluster += (sec + n - 1) >> fat_vol.shift;
+			n *= SD_BLOCK_SIZE;
+		}
+		else
+		{
+			ret = fat_load(sector);
+			if (ret != FAT_OK) break;
+			n = MIN(len, SD_BLOCK_SIZE - off);
+			memcpy(dst, fat_buf + off, n);
+		}
+
+		dst += n;
+		file->pos += n;
+		*done += n;
+		len -= n;
+	}
+	return ret;
+}
+
+
+/*********************************************************************//**
+ * @brief		Set the read position, going back restarts from the
+ * 				first cluster
+ * @param[in]	- file: file open for reading
+ * 				- offset: new position, clipped to the file size
+ * @return 		FAT_OK or error code
+ **********************************************************************/
+fat_error FAT_Seek (FAT_FILE_Type *file, uint32_t offset)
+{
+	if (file->mode != FAT_MODE_READ) return FAT_ERR_MODE;
+
+	offset = MIN(offset, file->size);
+	if (offset < file->pos)
+	{
+		file->pos = 0;
+		file->cluster = 0;
+		file->run_end = 0;
+	}
+	return fat_seek(file, offset);
+}
+
+
+/*********************************************************************//**
+ * @brief		Append data at the end of the file. Clusters are taken
+ * 				FAT_PREALLOC at a time as one contiguous run, so a
+ * 				sustained log neither scans the FAT nor looks up the
+ * 				chain until the run is used up.
+ * @param[in]	- file: file open for append
+ * 				- buf: data
+ * 				- len: number of bytes
+ * @return 		FAT_OK or error code, the size covers what was written
+ **********************************************************************/
+fat_error FAT_Append (FAT_FILE_Type *file, const void *buf, uint32_t len)
+{
+	const uint8_t *src = buf;
+	uint32_t sector, sec, off, n;
+	fat_error ret = FAT_OK;
+
+	if (file->mode != FAT_MODE_APPEND) return FAT_ERR_MODE;
+	if (len > (0xFFFFFFFF - file->size)) return FAT_ERR_FULL;
+
+	while (len)
+	{
+		if ((file->pos & FAT_CLUSTER_MASK) == 0)
+		{
+			ret = fat_step(file);
+			if (ret != FAT_OK) break;
+		}
+		sec = (file->pos & FAT_CLUSTER_MASK) / SD_BLOCK_SIZE;
+		off = file->pos % SD_BLOCK_SIZE;
+		sector = fat_vol.data_lba + ((file->cluster - 2) << fat_vol.shift) + sec;
+
+		if ((off == 0) && (len >= SD_BLOCK_SIZE))
+		{
+			n = ((file->run_end - file->cluster) << fat_vol.shift) - sec;
+			n = MIN(n, len / SD_BLOCK_SIZE);
+			if (SD_CacheWrite(sector, (uint8_t *)src, n) != SD_OK)
+			{
+				ret = FAT_ERR_DISK;
+				break;
+			}
+			if ((fat_buf_lba - sector) < n) fat_buf_lba = FAT_NO_SECTOR;
+			file->cluster += (sec + n - 1) >> fat_vol.shift;
+			n *= SD_BLOCK_SIZE;
+		}
+		else
+		{
+			// A sector started at the end of the file has nothing to keep
+			if (off == 0)
+			{
+				memset(fat_buf, 0, SD_BLOCK_SIZE);
+				fat_buf_lba = sector;
+			}
+			else
+			{
+				ret = fat_load(sector);
+				if (ret != FAT_OK) break;
+			}
+			n = MIN(len, SD_BLOCK_SIZE - off);
+			memcpy(fat_buf + off, src, n);
+			ret = fat_store();
+			if (ret != FAT_OK) break;
+		}
+
+		src += n;
+		file->pos += n;
+		file->size = file->pos;
+		file->dirty = 1;
+		len -= n;
+	}
+	return ret;
+}
+
+
+/*********************************************************************//**
+ * @brief		Update the directory entry and write everything cached
+ * 				to the card. Preallocated clusters stay in the chain
+ * 				until FAT_Close().
+ * @param[in]	- file: open file
+ * @return 		FAT_OK or FAT_ERR_DISK
+ **********************************************************************/
+fat_error FAT_Sync (FAT_FILE_Type *file)
+{
+	uint8_t *e;
+	fat_error ret;
+
+	if ((file->mode == FAT_MODE_APPEND) && file->dirty)
+	{
+		ret = fat_load(file->dir_sector);
+		if (ret != FAT_OK) return ret;
+		e = fat_buf + file->dir_offset;
+		fat_st16(e + 20, (fat_vol.type == 32) ? (uint16_t)(file->first >> 16) : 0);
+		fat_st16(e + 26, (uint16_t)file->first);
+		fat_st32(e + 28, file->size);
+		e[11] |= FAT_ATTR_ARCHIVE;
+		ret = fat_store();
+		if (ret != FAT_OK) return ret;
+		file->dirty = 0;
+	}
+
+	ret = fat_tab_flush();
+	if (ret != FAT_OK) return ret;
+	if (SD_CacheSync() != SD_OK) return FAT_ERR_DISK;
+	return FAT_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Close a file, an appended file gives back its unused
+ * 				preallocated clusters and is synced
+ * @param[in]	- file: open file
+ * @return 		FAT_OK or error code
+ **********************************************************************/
+fat_error FAT_Close (FAT_FILE_Type *file)
+{
+	fat_error ret = FAT_OK;
+
+	if (file->mode == FAT_MODE_APPEND)
+	{
+		ret = fat_trim(file);
+		if (ret == FAT_OK)
+		{
+			ret = FAT_Sync(file);
+		}
+	}
+	file->mode = 0;
+	return ret;
+}
+
+
+/*********************************************************************//**
+ * @brief		Draw a bitmap file, stored like the GLCD_Bitmap() arrays:
+ * 				16 header words, then w*h RGB565 pixels row by row
+ * @param[in]	- x, y: top left corner
+ * 				- w, h: size of the bitmap
+ * 				- path: file path, see FAT_Open()
+ * @return 		FAT_OK or error code
+ **********************************************************************/
+fat_error FAT_Bitmap (uint16_t x, uint16_t y, uint16_t w, uint16_t h, const char *path)
+{
+	FAT_FILE_Type file;
+	uint16_t pixels[FAT_BMP_CHUNK];
+	uint32_t left, n, done;
+	fat_error ret;
+
+	ret = FAT_Open(&file, path, FAT_MODE_READ);
+	if (ret != FAT_OK) return ret;
+
+	left = (uint32_t)w * h;
+	if (file.size < (32 + (left * 2)))
+	{
+		FAT_Close(&file);
+		return FAT_ERR_FORMAT;
+	}
+	ret = FAT_Seek(&file, 32);
+
+	GLCD_Set_Loc(x, y, w, h);
+	GLCD_Stream_Start();
+	while ((left > 0) && (ret == FAT_OK))
+	{
+		n = MIN(left, FAT_BMP_CHUNK);
+		ret = FAT_Read(&file, pixels, n * 2, &done);
+		GLCD_Stream_Pixels(pixels, done / 2);
+		left -= n;
+	}
+	GLCD_Stream_Stop();
+
+	FAT_Close(&file);
+	return ret;
+}
+
+/**
+ * @}
+ */
+
+/* End of Public Functions ---------------------------------------------------- */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -14,6 +14,7 @@
 
 /* Includes ------------------------------------------------------------------- */
 #include "lpc_spi_sd.h"
+#include "lpc_crc16.h"
 
 /* If this source file built with example, the LPC17xx FW library configuration
  * file in each example directory ("lpc17xx_libcfg.h") must be included,
@@ -21,6 +22,542 @@
  */
 
 
+/* Private Variables ---------------------------------------------------------- */
+/** @defgroup SD_Private_Variables SD Private Variables
+ * @{
+ */
+
+/* Chip select of the selected bus, ENABLE drives it high */
+#ifdef SD_SSP_MODE
+#define SD_CS(state)          CS_Force1(SD_SSP, state)
+#define SD_SSP_FIFO           8
+#else
+#define SD_CS(state)          CS_Force(state)
+#endif
+
+/* Card type detected by SD_Init(), selects byte or block addressing */
+static sd_card_type sd_type = SD_CARD_UNKNOWN;
+
+/* Session statistics */
+static SD_STATS_Type sd_stats;
+
+/* CSD TRAN_SPEED decoding: rate unit and time value x10 */
+static const uint32_t sd_tran_unit[4] = { 100000, 1000000, 10000000, 100000000 };
+static const uint8_t sd_tran_value[16] = { 0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80 };
+
+/* CRC-7 (x^7 + x^3 + 1) byte table, CRC kept in bits 7..1 */
+static const uint8_t crc7_table[256] =
+{
+	0x00, 0x12, 0x24, 0x36, 0x48, 0x5A, 0x6C, 0x7E, 0x90, 0x82, 0xB4, 0xA6, 0xD8, 0xCA, 0xFC, 0xEE,
+	0x32, 0x20, 0x16, 0x04, 0x7A, 0x68, 0x5E, 0x4C, 0xA2, 0xB0, 0x86, 0x94, 0xEA, 0xF8, 0xCE, 0xDC,
+	0x64, 0x76, 0x40, 0x52, 0x2C, 0x3E, 0x08, 0x1A, 0xF4, 0xE6, 0xD0, 0xC2, 0xBC, 0xAE, 0x98, 0x8A,
+	0x56, 0x44, 0x72, 0x60, 0x1E, 0x0C, 0x3A, 0x28, 0xC6, 0xD4, 0xE2, 0xF0, 0x8E, 0x9C, 0xAA, 0xB8,
+	0xC8, 0xDA, 0xEC, 0xFE, 0x80, 0x92, 0xA4, 0xB6, 0x58, 0x4A, 0x7C, 0x6E, 0x10, 0x02, 0x34, 0x26,
+	0xFA, 0xE8, 0xDE, 0xCC, 0xB2, 0xA0, 0x96, 0x84, 0x6A, 0x78, 0x4E, 0x5C, 0x22, 0x30, 0x06, 0x14,
+	0xAC, 0xBE, 0x88, 0x9A, 0xE4, 0xF6, 0xC0, 0xD2, 0x3C, 0x2E, 0x18, 0x0A, 0x74, 0x66, 0x50, 0x42,
+	0x9E, 0x8C, 0xBA, 0xA8, 0xD6, 0xC4, 0xF2, 0xE0, 0x0E, 0x1C, 0x2A, 0x38, 0x46, 0x54, 0x62, 0x70,
+	0x82, 0x90, 0xA6, 0xB4, 0xCA, 0xD8, 0xEE, 0xFC, 0x12, 0x00, 0x36, 0x24, 0x5A, 0x48, 0x7E, 0x6C,
+	0xB0, 0xA2, 0x94, 0x86, 0xF8, 0xEA, 0xDC, 0xCE, 0x20, 0x32, 0x04, 0x16, 0x68, 0x7A, 0x4C, 0x5E,
+	0xE6, 0xF4, 0xC2, 0xD0, 0xAE, 0xBC, 0x8A, 0x98, 0x76, 0x64, 0x52, 0x40, 0x3E, 0x2C, 0x1A, 0x08,
+	0xD4, 0xC6, 0xF0, 0xE2, 0x9C, 0x8E, 0xB8, 0xAA, 0x44, 0x56, 0x60, 0x72, 0x0C, 0x1E, 0x28, 0x3A,
+	0x4A, 0x58, 0x6E, 0x7C, 0x02, 0x10, 0x26, 0x34, 0xDA, 0xC8, 0xFE, 0xEC, 0x92, 0x80, 0xB6, 0xA4,
+	0x78, 0x6A, 0x5C, 0x4E, 0x30, 0x22, 0x14, 0x06, 0xE8, 0xFA, 0xCC, 0xDE, 0xA0, 0xB2, 0x84, 0x96,
+	0x2E, 0x3C, 0x0A, 0x18, 0x66, 0x74, 0x42, 0x50, 0xBE, 0xAC, 0x9A, 0x88, 0xF6, 0xE4, 0xD2, 0xC0,
+	0x1C, 0x0E, 0x38, 0x2A, 0x54, 0x46, 0x70, 0x62, 0x8C, 0x9E, 0xA8, 0xBA, 0xC4, 0xD6, 0xE0, 0xF2
+};
+
+/**
+ * @}
+ */
+
+
+/* Private Functions ---------------------------------------------------------- */
+static uint32_t sd_xfer (void* tx_buf, void* rx_buf, uint32_t length);
+static void sd_select (void);
+static void sd_deselect (void);
+static void sd_frame (uint8_t cmd, uint8_t *arg);
+static uint8_t sd_command (uint8_t cmd, uint32_t arg);
+static sd_error sd_cmd_resp (uint8_t cmd, uint32_t arg, uint8_t *resp, uint32_t length);
+static sd_error sd_wait_ready (void);
+static uint16_t sd_stream (uint8_t *tx_buf, uint8_t *rx_buf, uint32_t length);
+static sd_error sd_read_data (uint8_t *buf, uint32_t length);
+static void sd_set_clock (uint32_t target_clock);
+static sd_error sd_read_blocks (uint32_t sector, uint8_t *buf, uint8_t * const *bufs, uint32_t count);
+static sd_error sd_write_blocks (uint32_t sector, uint8_t *buf, uint8_t * const *bufs, uint32_t count);
+static sd_error sd_write_data (uint8_t token, uint8_t *buf);
+
+
+/*********************************************************************//**
+ * @brief		Send/receive data over SPI bus, CS is left untouched
+ * @param[in]	- tx_buf: pointer to transmit buffer, NULL if send 0xFF.
+ * 				- rx_buf: pointer to receive buffer, NULL if nothing to receive.
+ * 			    - length: number of data to send or receive
+ * @return 		the actual data sent or received.
+ **********************************************************************/
+static uint32_t sd_xfer (void* tx_buf, void* rx_buf, uint32_t length)
+{
+#ifdef SD_SSP_MODE
+	SSP_DATA_SETUP_Type xferConfig;
+
+	xferConfig.tx_data = tx_buf;
+	xferConfig.rx_data = rx_buf;
+	xferConfig.length = length;
+	SSP_ReadWrite(SD_SSP, &xferConfig, SSP_TRANSFER_POLLING);
+
+	return xferConfig.rx_cnt;
+#else
+	SPI_DATA_SETUP_Type xferConfig;
+
+	xferConfig.tx_data = tx_buf;
+	xferConfig.rx_data = rx_buf;
+	xferConfig.length = length;
+	SPI_ReadWrite(LPC_SPI, &xferConfig, SPI_TRANSFER_POLLING);
+
+	return xferConfig.counter;
+#endif
+}
+
+
+/*********************************************************************//**
+ * @brief		Assert CS for a command/response/data transaction
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sd_select (void)
+{
+	SD_CS(DISABLE);
+}
+
+
+/*********************************************************************//**
+ * @brief		Release CS and give the card 8 clocks to release DO
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sd_deselect (void)
+{
+	SD_CS(ENABLE);
+	sd_xfer(NULL, NULL, 1);
+}
+
+
+/*********************************************************************//**
+ * @brief		Build a command frame with CRC-7 in sd_cmd_buf
+ * @param[in]	- cmd: SD command code
+ * 			    - arg: pointer to array of 4x8 bytes, argument of command
+ * @return 		None
+ **********************************************************************/
+static void sd_frame (uint8_t cmd, uint8_t *arg)
+{
+	uint8_t crc = 0x00;
+
+	/* First byte has framing bits and command */
+	sd_cmd_buf[0] = 0x40 | (cmd & 0x3f);
+	sd_cmd_buf[1] = arg[0];
+	sd_cmd_buf[2] = arg[1];
+	sd_cmd_buf[3] = arg[2];
+	sd_cmd_buf[4] = arg[3];
+	//calculate CRC
+	crc = CRC_7(crc, sd_cmd_buf[0]);//start new crc-7
+	crc = CRC_7(crc, sd_cmd_buf[1]);
+	crc = CRC_7(crc, sd_cmd_buf[2]);
+	crc = CRC_7(crc, sd_cmd_buf[3]);
+	crc = CRC_7(crc, sd_cmd_buf[4]);
+	crc = CRC_7Final(crc);
+	sd_cmd_buf[5] = (crc << 1) | 0x01;//stop bit
+}
+
+
+/*********************************************************************//**
+ * @brief		Send a command with CS already asserted and get R1
+ * @param[in]	- cmd: SD command code
+ * 			    - arg: 32 bit argument of command
+ * @return 		R1 response, bit 7 set if the card did not answer
+ **********************************************************************/
+static uint8_t sd_command (uint8_t cmd, uint32_t arg)
+{
+	uint8_t SD_arg[4], r1;
+	uint8_t j;
+
+	SD_arg[0] = (uint8_t)(arg >> 24);
+	SD_arg[1] = (uint8_t)(arg >> 16);
+	SD_arg[2] = (uint8_t)(arg >> 8);
+	SD_arg[3] = (uint8_t)arg;
+	sd_frame(cmd, SD_arg);
+	sd_xfer(sd_cmd_buf, NULL, SD_CMD_BLOCK_LENGTH);
+
+	/* CMD12 is followed by a stuff byte */
+	if (cmd == CMD12_STOP_TRANSMISSION)
+	{
+		sd_xfer(NULL, NULL, 1);
+	}
+
+	/* R1 arrives within 8 bytes (NCR) */
+	r1 = 0xFF;
+	for (j = 0; j < 10; j++)
+	{
+		sd_xfer(NULL, &r1, 1);
+		if (GETBIT(r1,7) == 0) break;
+	}
+	return r1;
+}
+
+
+/*********************************************************************//**
+ * @brief		Send a command and read R1 plus trailing response bytes
+ * 				(R3/R7) in one CS cycle
+ * @param[in]	- cmd: SD command code
+ * 			    - arg: 32 bit argument of command
+ * 			    - resp: receives R1 followed by length bytes
+ * 			    - length: number of bytes following R1
+ * @return 		SD_OK or SD_ERROR_TIMEOUT
+ **********************************************************************/
+static sd_error sd_cmd_resp (uint8_t cmd, uint32_t arg, uint8_t *resp, uint32_t length)
+{
+	sd_select();
+	resp[0] = sd_command(cmd, arg);
+	if (GETBIT(resp[0],7) == 1)
+	{
+		sd_deselect();
+		return SD_ERROR_TIMEOUT;
+	}
+	if (length > 0)
+	{
+		sd_xfer(NULL, (resp + 1), length);
+	}
+	sd_deselect();
+	return SD_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Wait while the card holds DO low (busy)
+ * @param[in]	None
+ * @return 		SD_OK or SD_ERROR_TIMEOUT
+ **********************************************************************/
+static sd_error sd_wait_ready (void)
+{
+	uint8_t dummy;
+	uint32_t j;
+
+	for (j = 0; j < SD_WAIT_BUSY_TIMEOUT; j++)
+	{
+		sd_xfer(NULL, &dummy, 1);
+		if (dummy == 0xFF) return SD_OK;
+	}
+	return SD_ERROR_TIMEOUT;
+}
+
+
+/*********************************************************************//**
+ * @brief		Stream a data block over SPI and compute its CRC-16 on
+ * 				the fly: each byte is folded in while the next one is
+ * 				being shifted, so CRC mode adds no time per block.
+ * 				On SSP0 long blocks go through GPDMA, a sent block is
+ * 				folded while the DMA clocks it out, a received one once
+ * 				the DMA is done. Short blocks, or no free DMA channel,
+ * 				keep the FIFO filled up to SD_SSP_FIFO frames.
+ * @param[in]	- tx_buf: data to send, NULL when receiving (0xFF is sent)
+ * 				- rx_buf: receive buffer, NULL when sending
+ * 				- length: number of bytes
+ * @return 		CRC-16 of the sent or received data
+ **********************************************************************/
+static uint16_t sd_stream (uint8_t *tx_buf, uint8_t *rx_buf, uint32_t length)
+{
+	uint16_t crc = 0;
+	uint32_t i;
+	uint8_t data;
+#ifdef SD_SSP_MODE
+	SSP_DATA_SETUP_Type xferConfig;
+	uint32_t j;
+
+	// Let frames queued by the CPU finish so RX DMA only counts its own
+	while (SD_SSP->SR & SSP_SR_BSY);
+	while (SD_SSP->SR & SSP_SR_RNE)
+	{
+		data = (uint8_t)SD_SSP->DR;
+	}
+
+	xferConfig.tx_data = tx_buf;
+	xferConfig.rx_data = rx_buf;
+	xferConfig.length = length;
+	if ((length >= SD_DMA_MIN) && \
+		(SSP_ReadWrite(SD_SSP, &xferConfig, SSP_TRANSFER_DMA) == 0))
+	{
+		if (tx_buf != NULL)
+		{
+			for (i = 0; i < length; i++)
+			{
+				crc = CRC16_BYTE(crc, tx_buf[i]);
+			}
+		}
+		while (SSP_DMABusy(SD_SSP) == SET);
+		if (tx_buf == NULL)
+		{
+			for (i = 0; i < length; i++)
+			{
+				crc = CRC16_BYTE(crc, rx_buf[i]);
+			}
+		}
+		return crc;
+	}
+
+	// i counts frames written to the FIFO, j frames read back
+	for (i = 0, j = 0; j < length; )
+	{
+		if ((i < length) && ((i - j) < SD_SSP_FIFO) && (SD_SSP->SR & SSP_SR_TNF))
+		{
+			data = (tx_buf != NULL) ? tx_buf[i] : 0xFF;
+			SD_SSP->DR = data;
+			if (tx_buf != NULL)
+			{
+				crc = CRC16_BYTE(crc, data);
+			}
+			i++;
+		}
+		if (SD_SSP->SR & SSP_SR_RNE)
+		{
+			data = (uint8_t)SD_SSP->DR;
+			if (rx_buf != NULL)
+			{
+				rx_buf[j] = data;
+				if (tx_buf == NULL)
+				{
+					crc = CRC16_BYTE(crc, data);
+				}
+			}
+			j++;
+		}
+	}
+	return crc;
+#else
+
+	for (i = 0; i < length; i++)
+	{
+		if (tx_buf != NULL)
+		{
+			data = tx_buf[i];
+			LPC_SPI->SPDR = data;
+			crc = CRC16_BYTE(crc, data);
+		}
+		else
+		{
+			LPC_SPI->SPDR = 0xFF;
+			if (i > 0)
+			{
+				crc = CRC16_BYTE(crc, rx_buf[i - 1]);
+			}
+		}
+
+		while (!(LPC_SPI->SPSR & SPI_SPSR_SPIF));
+		data = (uint8_t)LPC_SPI->SPDR;
+		if (rx_buf != NULL)
+		{
+			rx_buf[i] = data;
+		}
+	}
+
+	/* Last received byte */
+	if ((tx_buf == NULL) && (length > 0))
+	{
+		crc = CRC16_BYTE(crc, rx_buf[length - 1]);
+	}
+	return crc;
+#endif
+}
+
+
+/*********************************************************************//**
+ * @brief		Receive one data block: start token, data, CRC-16
+ * @param[in]	- buf: destination of length bytes
+ * 				- length: SD_BLOCK_SIZE, or 16 for CSD/CID
+ * @return 		SD_OK, SD_ERROR_TIMEOUT, SD_ERROR_TOKEN or SD_ERROR_CRC
+ **********************************************************************/
+static sd_error sd_read_data (uint8_t *buf, uint32_t length)
+{
+	uint8_t token, crc[2];
+	uint16_t crc16;
+	uint32_t j;
+
+	/* Wait for start token, anything else is an error token */
+	token = 0xFF;
+	for (j = 0; (j < SD_WAIT_TOKEN_TIMEOUT) && (token == 0xFF); j++)
+	{
+		sd_xfer(NULL, &token, 1);
+	}
+	if (token == 0xFF) return SD_ERROR_TIMEOUT;
+	if (token != SD_TOKEN_START_BLOCK) return SD_ERROR_TOKEN;
+
+	crc16 = sd_stream(NULL, buf, length);
+	sd_xfer(NULL, crc, 2);
+	if (crc16 != ((crc[0] << 8) | crc[1])) return SD_ERROR_CRC;
+
+	return SD_OK;
+}
+
+
+/*********************************************************************//**
+ * @brief		Send one data block and wait for the card to program it
+ * @param[in]	- token: SD_TOKEN_START_BLOCK or SD_TOKEN_START_MULTI
+ * 				- buf: source of SD_BLOCK_SIZE bytes
+ * @return 		SD_OK, SD_ERROR_CRC, SD_ERROR_WRITE or SD_ERROR_TIMEOUT
+ **********************************************************************/
+static sd_error sd_write_data (uint8_t token, uint8_t *buf)
+{
+	uint8_t crc[2], resp;
+	uint16_t crc16;
+
+	/* One byte gap (NWR), then token, data and CRC */
+	sd_xfer(NULL, NULL, 1);
+	sd_xfer(&token, NULL, 1);
+	crc16 = sd_stream(buf, NULL, SD_BLOCK_SIZE);
+	crc[0] = (uint8_t)(crc16 >> 8);
+	crc[1] = (uint8_t)crc16;
+	sd_xfer(crc, NULL, 2);
+
+	/* Data response token: xxx0sss1, 010 accepted, 101 CRC error */
+	sd_xfer(NULL, &resp, 1);
+	if ((resp & SD_DATA_RESP_MASK) != SD_DATA_RESP_ACCEPTED)
+	{
+		sd_wait_ready();
+		return ((resp & SD_DATA_RESP_MASK) == 0x0B) ? SD_ERROR_CRC : SD_ERROR_WRITE;
+	}
+
+	return sd_wait_ready();
+}
+
+
+/*********************************************************************//**
+ * @brief		Program the SPI (or SSP0) clock and record the achieved rate
+ * @param[in]	- target_clock: requested SPI clock in Hz
+ * @return 		None
+ **********************************************************************/
+static void sd_set_clock (uint32_t target_clock)
+{
+#ifdef SD_SSP_MODE
+	SSP_SetClock(SD_SSP, target_clock);
+	sd_stats.spi_clock = CLKPWR_GetPCLK(CLKPWR_PCLKSEL_SSP0) / \
+			((((SD_SSP->CR0 >> 8) & 0xFF) + 1) * SD_SSP->CPSR);
+#else
+	SPI_SetClock(LPC_SPI, target_clock);
+	sd_stats.spi_clock = CLKPWR_GetPCLK(CLKPWR_PCLKSEL_SPI) / LPC_SPI->SPCCR;
+#endif
+}
+
+/*********************************************************************//**
+ * @brief		Read blocks from SD card, CMD17 for a single block,
+ * 				CMD18 streaming plus CMD12 for more
+ * @param[in]	- sector: first block number
+ * 				- buf: destination of count * SD_BLOCK_SIZE bytes, or NULL
+ * 				- bufs: count block destinations, used when buf is NULL
+ * 				- count: number of blocks
+ * @return 		SD_OK or error code, data CRC-16 is verified
+ **********************************************************************/
+static sd_error sd_read_blocks (uint32_t sector, uint8_t *buf, uint8_t * const *bufs, uint32_t count)
+{
+	sd_error ret = SD_OK;
+	uint8_t r1, multi;
+	uint32_t start, blocks, i;
+
+	if (((buf == NULL) && (bufs == NULL)) || (count == 0)) return SD_CMD_BAD_PARAMETER;
+	start = DWT_CYCCNT;
+	blocks = count;
+
+	/* Standard capacity cards are byte addressed */
+	if (sd_type != SD_CARD_HC) sector *= SD_BLOCK_SIZE;
+	multi = (count > 1);
+
+	sd_select();
+	r1 = sd_command(multi ? CMD18_READ_MULTIPLE_BLOCK : CMD17_READ_SINGLE_BLOCK, sector);
+	if (r1 != R1_NOERROR)
+	{
+		sd_deselect();
+		return (GETBIT(r1,7) == 1) ? SD_ERROR_TIMEOUT : SD_NG;
+	}
+
+	for (i = 0; i < blocks; i++)
+	{
+		ret = sd_read_data((bufs != NULL) ? bufs[i] : (buf + (i * SD_BLOCK_SIZE)), SD_BLOCK_SIZE);
+		if (ret != SD_OK) break;
+	}
+
+	if (multi)
+	{
+		sd_command(CMD12_STOP_TRANSMISSION, 0);
+		if ((sd_wait_ready() != SD_OK) && (ret == SD_OK)) ret = SD_ERROR_TIMEOUT;
+	}
+	sd_deselect();
+
+	if (ret == SD_OK)
+	{
+		sd_stats.blocks_read += blocks;
+		sd_stats.read_cycles = (DWT_CYCCNT - start) / blocks;
+		sd_stats.read_max = MAX(sd_stats.read_max, sd_stats.read_cycles);
+	}
+	return ret;
+}
+
+
+/*********************************************************************//**
+ * @brief		Write blocks to SD card, CMD24 for a single block,
+ * 				CMD25 streaming plus stop token for more
+ * @param[in]	- sector: first block number
+ * 				- buf: source of count * SD_BLOCK_SIZE bytes, or NULL
+ * 				- bufs: count block sources, used when buf is NULL
+ * 				- count: number of blocks
+ * @return 		SD_OK or error code
+ **********************************************************************/
+static sd_error sd_write_blocks (uint32_t sector, uint8_t *buf, uint8_t * const *bufs, uint32_t count)
+{
+	sd_error ret = SD_OK;
+	uint8_t r1, multi, token;
+	uint32_t start, blocks, i;
+
+	if (((buf == NULL) && (bufs == NULL)) || (count == 0)) return SD_CMD_BAD_PARAMETER;
+	start = DWT_CYCCNT;
+	blocks = count;
+
+	/* Standard capacity cards are byte addressed */
+	if (sd_type != SD_CARD_HC) sector *= SD_BLOCK_SIZE;
+	multi = (count > 1);
+
+	sd_select();
+	r1 = sd_command(multi ? CMD25_WRITE_MULTIPLE_BLOCK : CMD24_WRITE_BLOCK, sector);
+	if (r1 != R1_NOERROR)
+	{
+		sd_deselect();
+		return (GETBIT(r1,7) == 1) ? SD_ERROR_TIMEOUT : SD_NG;
+	}
+
+	for (i = 0; i < blocks; i++)
+	{
+		ret = sd_write_data(multi ? SD_TOKEN_START_MULTI : SD_TOKEN_START_BLOCK, \
+				(bufs != NULL) ? bufs[i] : (buf + (i * SD_BLOCK_SIZE)));
+		if (ret != SD_OK) break;
+	}
+
+	if (multi)
+	{
+		/* Stop token also ends the stream after a rejected block */
+		token = SD_TOKEN_STOP_TRAN;
+		sd_xfer(&token, NULL, 1);
+		sd_xfer(NULL, NULL, 1);
+		if ((sd_wait_ready() != SD_OK) && (ret == SD_OK)) ret = SD_ERROR_TIMEOUT;
+	}
+	sd_deselect();
+
+	if (ret == SD_OK)
+	{
+		sd_stats.blocks_written += blocks;
+		sd_stats.write_cycles = (DWT_CYCCNT - start) / blocks;
+		sd_stats.write_max = MAX(sd_stats.write_max, sd_stats.write_cycles);
+	}
+	return ret;
+}
+
+/* End of Private Functions --------------------------------------------------- */
+
+
 /** @addtogroup SD_Public_Functions
  * @{
  */
@@ -47,46 +584,23 @@ sd_connect_status SD_GetCardConnectStatus (void)
  * @param[in]	- old_crc: 0x00 to start new CRC
  * 			    or value from previous call to continue.
  * 				- data: data byte to add to CRC computation
- * @return 		CRC-7 checksum which MUST be augmented by crc_7augment() before used
+ * @return 		CRC-7 checksum (table driven, one lookup per byte)
  **********************************************************************/
 uint8_t CRC_7 (uint8_t old_crc, uint8_t data)
 {
-	uint8_t new_crc,x;
-
-	new_crc = old_crc;
-	for (x = 7; x >= 0; x--)
-	{
-		new_crc <<= 1;
-		new_crc |= GETBIT(data,x);
-		if (GETBIT(new_crc, 7) == 1)
-		{
-			new_crc ^= 0x89; /*CRC-7's polynomial is x^7 + x^3 + 1*/
-		}
-		if(x==0) break;
-	}
-	return new_crc;
+	return (crc7_table[(uint8_t)(old_crc << 1) ^ data] >> 1);
 }
 
 
 /*********************************************************************//**
- * @brief		Provides the zero-padding final step to CRC-7
+ * @brief		Final step to CRC-7, kept for compatibility: the table
+ * 				driven CRC_7() needs no zero-padding any more
  * @param[in]	- old_crc: value from last crc_7()call
  * @return 		Finalized CRC-7 checksum
  **********************************************************************/
 uint8_t CRC_7Final (uint8_t old_crc)
 {
-	uint8_t new_crc,x;
-
-	new_crc = old_crc;
-	for (x = 0; x < 7; x++)
-	{
-		new_crc <<= 1;
-		if (GETBIT(new_crc, 7) == 1)
-		{
-			new_crc ^= 0x89; /*CRC-7's polynomial is x^7 + x^3 + 1*/
-		}
-	}
-	return new_crc;
+	return old_crc;
 }
 
 
@@ -101,54 +615,35 @@ uint8_t CRC_7Final (uint8_t old_crc)
  **********************************************************************/
 uint32_t SD_SendReceiveData_Polling (void* tx_buf, void* rx_buf, uint32_t length)
 {
-	// SPI Data Setup structure variable
-	SPI_DATA_SETUP_Type xferConfig;
-
-	CS_Force(DISABLE);
-	// delay_ms(1);
+	uint32_t counter;
 
-	xferConfig.tx_data = tx_buf;
-	xferConfig.rx_data = rx_buf;
-	xferConfig.length = length;
-	SPI_ReadWrite(LPC_SPI, &xferConfig, SPI_TRANSFER_POLLING);
+	SD_CS(DISABLE);
+	counter = sd_xfer(tx_buf, rx_buf, length);
+	SD_CS(ENABLE);
 
-	// delay_ms(1);
-	CS_Force(ENABLE);
-	return xferConfig.counter;
+	return counter;
 }
 
 
 /*********************************************************************//**
- * @brief		Send command to SD card
+ * @brief		Send command to SD card, CS is asserted and stays so
+ * 				until SD_WaitR1() has read the response
  * @param[in]	- cmd: SD command code
  * 			    - arg: pointer to array of 4x8 bytes, argument of command
  * @return 		n/a
  **********************************************************************/
 void SD_SendCommand(uint8_t cmd, uint8_t *arg)
 {
-	uint8_t crc = 0x00;
-
-	/* First byte has framing bits and command */
-	sd_cmd_buf[0] = 0x40 | (cmd & 0x3f);
-	sd_cmd_buf[1] = arg[0];
-	sd_cmd_buf[2] = arg[1];
-	sd_cmd_buf[3] = arg[2];
-	sd_cmd_buf[4] = arg[3];
-	//calculate CRC
-	crc = CRC_7(crc, sd_cmd_buf[0]);//start new crc-7
-	crc = CRC_7(crc, sd_cmd_buf[1]);
-	crc = CRC_7(crc, sd_cmd_buf[2]);
-	crc = CRC_7(crc, sd_cmd_buf[3]);
-	crc = CRC_7(crc, sd_cmd_buf[4]);
-	crc = CRC_7Final(crc);
-	sd_cmd_buf[5] = (crc << 1) | 0x01;//stop bit
+	sd_frame(cmd, arg);
 
-	SD_SendReceiveData_Polling(sd_cmd_buf,NULL,SD_CMD_BLOCK_LENGTH);
+	sd_select();
+	sd_xfer(sd_cmd_buf,NULL,SD_CMD_BLOCK_LENGTH);
 }
 
 
 /*********************************************************************//**
- * @brief		Wait for SD card R1 response
+ * @brief		Wait for SD card R1 response and end the transaction
+ * 				started by SD_SendCommand()
  * @param[in]	- buffer: pointer to receive buffer
  * 			    - length: length of receive data, must equal 1+actual length of data
  * 					      length = 0 if receive R1 only
@@ -158,53 +653,55 @@ void SD_SendCommand(uint8_t cmd, uint8_t *arg)
 sd_error SD_WaitR1 (uint8_t *buffer, uint32_t length, uint32_t timeout)
 {
     uint32_t j;
-	uint8_t dummy[2];
-	uint8_t wait_idle;
+	uint8_t dummy;
+	sd_error ret = SD_OK;
 
 	/* No null pointers allowed */
-	if (buffer == NULL)	return SD_CMD_BAD_PARAMETER;
+	if (buffer == NULL)
+	{
+		sd_deselect();
+		return SD_CMD_BAD_PARAMETER;
+	}
 
 	/* Wait for start bit on R1 */
-	j=0;dummy[0]=0xFF;
-	while (GETBIT(dummy[0],7) == 1)
+	dummy = 0xFF;
+	for (j = 0; GETBIT(dummy,7) == 1; j++)
 	{
-		if (j>timeout)return SD_ERROR_TIMEOUT;
-		dummy[0]=0x00;
-		SD_SendReceiveData_Polling(NULL,dummy,1);
-		j++;
+		if (j > timeout)
+		{
+			sd_deselect();
+			return SD_ERROR_TIMEOUT;
+		}
+		sd_xfer(NULL,&dummy,1);
 	}
-	*buffer=dummy[0];//store R1
+	*buffer=dummy;//store R1
+
 	if (length > 0)//read followed data
 	{
 		/* Wait for start token on data portion, if any */
-		dummy[0] = 0xff;
-		j = 0;
-		while (dummy[0] != 0xfe)
+		dummy = 0xFF;
+		for (j = 0; dummy == 0xFF; j++)
 		{
-			if (j > timeout)return SD_ERROR_TIMEOUT;
-			dummy[0]=0x00;
-			SD_SendReceiveData_Polling(NULL,dummy,1);
-			if ((dummy[0] != 0xff) && (dummy[0] != 0xfe)) // not idle or start token?
+			if (j > timeout)
 			{
-				return SD_ERROR_TOKEN;
+				sd_deselect();
+				return SD_ERROR_TIMEOUT;
 			}
-			j++;
+			sd_xfer(NULL,&dummy,1);
+		}
+		if (dummy != SD_TOKEN_START_BLOCK) // not a start token?
+		{
+			sd_deselect();
+			return SD_ERROR_TOKEN;
 		}
 		/* Read all bytes */
-		SD_SendReceiveData_Polling(NULL,(buffer+1),(length - 1));
+		sd_xfer(NULL,(buffer+1),(length - 1));
 	}
-	/* Some more bit clocks to finish internal SD operations */
-	dummy[0]=0x00;
-	wait_idle=0;
-	while((dummy[0]!=0xff)&&(wait_idle<20))
-	{
-		dummy[0]=0x00;
-		SD_SendReceiveData_Polling(NULL,dummy,1);
-		for(j=0;j<1000;j++);
-		wait_idle++;
-	}
-	if(wait_idle>=20) return SD_ERROR_BUS_NOT_IDLE;
-	return SD_OK;
+
+	/* Card holds DO low while it finishes internal operations */
+	if (sd_wait_ready() != SD_OK) ret = SD_ERROR_BUS_NOT_IDLE;
+	sd_deselect();
+	return ret;
 }
 
 
@@ -215,26 +712,17 @@ sd_error SD_WaitR1 (uint8_t *buffer, uint32_t length, uint32_t timeout)
  **********************************************************************/
 sd_error SD_WaitDeviceIdle (uint32_t num_char)
 {
-	uint8_t dummy[2]={0,0};
-	uint32_t i=0;
+	uint8_t dummy = 0x00;
+	uint32_t i;
 
-	while ((i < num_char) && (dummy[0] != 0xff))
+	sd_select();
+	for (i = 0; (i < num_char) && (dummy != 0xff); i++)
 	{
-		dummy[0]=0x00;
-		SD_SendReceiveData_Polling(NULL,dummy,1);
-		if (dummy[0] == 0xff)
-		{
-			dummy[0]= 0x00;
-			SD_SendReceiveData_Polling(NULL,dummy,1);
-			if (dummy[0] == 0xff)
-			{
-				dummy[0]= 0x00;
-				SD_SendReceiveData_Polling(NULL,dummy,1);
-			}
-		}
-		i++;
+		sd_xfer(NULL,&dummy,1);
 	}
-	if (dummy[0] != 0xff)return SD_ERROR_TIMEOUT;
+	sd_deselect();
+
+	if (dummy != 0xff)return SD_ERROR_TIMEOUT;
 
 	return SD_OK;
 }
@@ -249,12 +737,30 @@ sd_error SD_Init (uint8_t retries)
 {
 	uint8_t rxdata,errors;
 	uint8_t SD_arg[4]={0,0,0,0};
+	uint8_t resp[5];
 	uint16_t i;
 
+	sd_type = SD_CARD_UNKNOWN;
+	SD_ResetStats();
+	sd_stats.card_clock = 0;
+
+	// Start the DWT cycle counter used for the block latencies
+	DWT_CycleInit();
+
+#ifdef SD_SSP_MODE
+	GPDMA_Init();                // Data phases use GPDMA
+#endif
+
+	// Identification mode runs at 400kHz
+	sd_set_clock(SD_INIT_CLOCK);
+
 	// check for SD card insertion
 	printf(LPC_UART0,"\n\rPlease plug-in SD card!");
 	while(SD_GetCardConnectStatus()==SD_DISCONNECTED);
 	printf(LPC_UART0,"...Connected!\n\r");
+	// At least 74 clocks with CS high before the first command
+	SD_CS(ENABLE);
+	sd_xfer(NULL,NULL,10);
 	// Wait for bus idle
 	if(SD_WaitDeviceIdle(160) != SD_OK) return SD_ERROR_BUS_NOT_IDLE;
 	printf(LPC_UART0,"Initialize SD card in SPI mode...");
@@ -279,6 +785,20 @@ sd_error SD_Init (uint8_t retries)
 	}
 	if(errors >= retries)return SD_ERROR_CMD0;
     printf(LPC_UART0,"I have cleared errors");
+
+	/* SD v2 cards echo the CMD8 check pattern, v1 cards reject it */
+	if(sd_cmd_resp(CMD8_SEND_IF_COND, 0x000001AA, resp, 4) != SD_OK) return SD_ERROR_CMD8;
+	if(resp[0] & R1_ILLEGAL)
+	{
+		sd_type = SD_CARD_V1;
+	}
+	else if(((resp[3] & 0x0F) == 0x01) && (resp[4] == 0xAA))
+	{
+		sd_type = SD_CARD_V2;
+		SD_arg[0] = 0x40;			/* ACMD41 HCS: host supports SDHC */
+	}
+	else return SD_ERROR_CMD8;
+
 	/* Check if the card is not MMC */
 	/* Start its internal initialization process */
 	while(1)
@@ -294,12 +814,42 @@ sd_error SD_Init (uint8_t retries)
 			break; //in_idle_state=0 --> ready
 	}
 	printf(LPC_UART0,"I have cleared waiting");
+	SD_arg[0] = 0x00;
+
+	/* OCR CCS bit tells SDHC/SDXC (block addressing) apart */
+	if(sd_type == SD_CARD_V2)
+	{
+		if(sd_cmd_resp(CMD58_READ_OCR, 0, resp, 4) != SD_OK) return SD_ERROR_CMD58;
+		if(resp[0] != R1_NOERROR) return SD_ERROR_CMD58;
+		if(resp[1] & 0x40) sd_type = SD_CARD_HC;
+	}
+
 	/* Enable CRC */
 	SD_arg[3] = 0x01;
 	SD_SendCommand(CMD59_CRC_ON_OFF, SD_arg);
 	if(SD_WaitR1(&rxdata,0,1000)!= SD_OK) return SD_ERROR_CMD59;
 	if(rxdata != R1_NOERROR) return SD_ERROR_CMD59;
 
+	/* Byte addressed cards: fix the block length to 512 */
+	if(sd_type != SD_CARD_HC)
+	{
+		if(sd_cmd_resp(CMD16_SET_BLOCKLEN, SD_BLOCK_SIZE, resp, 0) != SD_OK) return SD_ERROR_CMD16;
+		if(resp[0] != R1_NOERROR) return SD_ERROR_CMD16;
+	}
+
+	/* Data transfer mode: as fast as the card's TRAN_SPEED allows */
+	if(SD_GetCSD(sd_data_buf) == SD_OK)
+	{
+		sd_stats.card_clock = sd_tran_unit[sd_data_buf[3] & 0x03] / 10
+							* sd_tran_value[(sd_data_buf[3] >> 3) & 0x0F];
+		sd_set_clock(MIN(sd_stats.card_clock, SD_MAX_CLOCK));
+	}
+	else
+	{
+		/* Every SD card supports 25MHz default speed */
+		sd_set_clock(SD_MAX_CLOCK);
+	}
+
 	return SD_OK;
 }
 
@@ -321,6 +871,124 @@ sd_error SD_GetCID (void)
 }
 
 
+/*********************************************************************//**
+ * @brief		Get SD card's CSD register
+ * @param[in]	- csd: receives the 16 byte CSD, MSB first
+ * @return 		SD_OK or error code
+ **********************************************************************/
+sd_error SD_GetCSD (uint8_t *csd)
+{
+	sd_error ret;
+
+	sd_select();
+	if (sd_command(CMD9_SEND_CSD, 0) != R1_NOERROR)
+	{
+		sd_deselect();
+		return SD_NG;
+	}
+	ret = sd_read_data(csd, 16);
+	sd_deselect();
+	return ret;
+}
+
+
+/*********************************************************************//**
+ * @brief		Get card type detected by SD_Init()
+ * @param[in]	none
+ * @return 		SD_CARD_UNKNOWN, SD_CARD_V1, SD_CARD_V2 or SD_CARD_HC
+ **********************************************************************/
+sd_card_type SD_GetCardType (void)
+{
+	return sd_type;
+}
+
+
+/*********************************************************************//**
+ * @brief		Read blocks from SD card, CMD17 for a single block,
+ * 				CMD18 streaming plus CMD12 for more
+ * @param[in]	- sector: first block number
+ * 				- buf: destination of count * SD_BLOCK_SIZE bytes
+ * 				- count: number of blocks
+ * @return 		SD_OK or error code, data CRC-16 is verified
+ **********************************************************************/
+sd_error SD_ReadBlocks (uint32_t sector, uint8_t *buf, uint32_t count)
+{
+	return sd_read_blocks(sector, buf, NULL, count);
+}
+
+
+/*********************************************************************//**
+ * @brief		Read consecutive blocks into separate buffers with one
+ * 				CMD18 stream, e.g. cache lines that are not adjacent
+ * @param[in]	- sector: first block number
+ * 				- bufs: count destinations of SD_BLOCK_SIZE bytes each
+ * 				- count: number of blocks
+ * @return 		SD_OK or error code, data CRC-16 is verified
+ **********************************************************************/
+sd_error SD_ReadBlocksV (uint32_t sector, uint8_t * const *bufs, uint32_t count)
+{
+	if (bufs == NULL) return SD_CMD_BAD_PARAMETER;
+	return sd_read_blocks(sector, NULL, bufs, count);
+}
+
+
+/*********************************************************************//**
+ * @brief		Write blocks to SD card, CMD24 for a single block,
+ * 				CMD25 streaming plus stop token for more
+ * @param[in]	- sector: first block number
+ * 				- buf: source of count * SD_BLOCK_SIZE bytes
+ * 				- count: number of blocks
+ * @return 		SD_OK or error code
+ **********************************************************************/
+sd_error SD_WriteBlocks (uint32_t sector, uint8_t *buf, uint32_t count)
+{
+	return sd_write_blocks(sector, buf, NULL, count);
+}
+
+
+/*********************************************************************//**
+ * @brief		Write consecutive blocks from separate buffers with one
+ * 				CMD25 stream
+ * @param[in]	- sector: first block number
+ * 				- bufs: count sources of SD_BLOCK_SIZE bytes each
+ * 				- count: number of blocks
+ * @return 		SD_OK or error code
+ **********************************************************************/
+sd_error SD_WriteBlocksV (uint32_t sector, uint8_t * const *bufs, uint32_t count)
+{
+	if (bufs == NULL) return SD_CMD_BAD_PARAMETER;
+	return sd_write_blocks(sector, NULL, bufs, count);
+}
+
+
+/*********************************************************************//**
+ * @brief		Read the session statistics
+ * @param[out]	- stats: filled with a copy of the counters
+ * @return 		None
+ **********************************************************************/
+void SD_GetStats (SD_STATS_Type *stats)
+{
+	*stats = sd_stats;
+}
+
+
+/*********************************************************************//**
+ * @brief		Clear the block counters and latencies, the clock
+ * 				values are kept
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void SD_ResetStats (void)
+{
+	sd_stats.blocks_read = 0;
+	sd_stats.blocks_written = 0;
+	sd_stats.read_cycles = 0;
+	sd_stats.read_max = 0;
+	sd_stats.write_cycles = 0;
+	sd_stats.write_max = 0;
+}
+
+
 /*********************************************************************//**
  * @brief		Print Error Message
  * @param[in]	Print Message according to sd_status
@@ -346,6 +1014,22 @@ void SD_ErrorMsg (sd_error sd_status)
 		printf(LPC_UART0,"Fail CMD59\n\r");
 		break;
 
+	case SD_ERROR_CMD8:
+		printf(LPC_UART0,"Fail CMD8\n\r");
+		break;
+
+	case SD_ERROR_CMD16:
+		printf(LPC_UART0,"Fail CMD16\n\r");
+		break;
+
+	case SD_ERROR_CMD58:
+		printf(LPC_UART0,"Fail CMD58\n\r");
+		break;
+
+	case SD_ERROR_CRC:
+		printf(LPC_UART0,"Fail...Data CRC error.\n\r");
+		break;
+
 	case SD_ERROR_BUS_NOT_IDLE:
 		printf(LPC_UART0,"Fail...Device is not in idle state.\n\r");
 		break;
@@ -20,14 +20,14 @@
  * otherwise the default FW library configuration file must be included instead
  */
 
-const char *status_reg[4]={"   STATUS REGISTER:\r\n\n",
-                           "W/R                    W/R  W/R  R    R\r\n",
-                           "D7   D6   D5   D4      D3   D2   D1   D0\r\n",
-                           "WPEN X    X    X   --  BP1  BP0  WEL  WIP",
+static const char *status_reg[4]={"   STATUS REGISTER:\r\n\n",
+                                  "W/R                    W/R  W/R  R    R\r\n",
+                                  "D7   D6   D5   D4      D3   D2   D1   D0\r\n",
+                                  "WPEN X    X    X   --  BP1  BP0  WEL  WIP",
 };
 
 
-void print_status_reg(void)
+void Ssp_Print_Status_Reg(void)
 {
 	uint8_t count;
 
@@ -40,6 +40,88 @@ void print_status_reg(void)
 }
 
 
+/** @addtogroup EEPROM_Private_Functions
+ * @{
+ */
+
+/* Private Functions ---------------------------------------------------------- */
+/*********************************************************************//**
+ * @brief	    Set the Write Enable Latch, needed before every write
+ * @param[in] 	SSPx	SSP peripheral definition, should be:
+ * 						- LPC_SSP0: SSP0 peripheral
+ * 						- LPC_SSP1: SSP1 peripheral
+ * @return 		None
+ **********************************************************************/
+static void ssp_eep_write_enable (LPC_SSP_TypeDef *SSPx)
+{
+	SSP_DATA_SETUP_Type xferConfig;
+	uint8_t WriteData[1];
+
+	WriteData[0] = EEP_WREN;
+
+	CS_Force1 (SSPx, DISABLE);                 /* CS low active           */
+	xferConfig.tx_data = WriteData;            /* Send Instruction Byte    */
+	xferConfig.rx_data = NULL;
+	xferConfig.length = 1;
+	SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);  /* Write Enable Latch      */
+	CS_Force1 (SSPx, ENABLE);                  /* CS high inactive        */
+}
+
+
+/*********************************************************************//**
+ * @brief	    Wait for the internal write cycle by polling the WIP bit,
+ *              the device is ready as soon as it finishes instead of
+ *              after a fixed worst case delay
+ * @param[in] 	SSPx	SSP peripheral definition, should be:
+ * 						- LPC_SSP0: SSP0 peripheral
+ * 						- LPC_SSP1: SSP1 peripheral
+ * @return 		1 when ready, 0 on timeout
+ **********************************************************************/
+static uchar ssp_eep_wait_ready (LPC_SSP_TypeDef *SSPx)
+{
+	uint32_t poll;
+
+	for(poll = 0; poll < EEP_WIP_POLL; poll++)
+	{
+		if(!(Ssp_Eeprom_Read_Status_Reg(SSPx) & EEP_SR_WIP))
+			return(1);
+	}
+	return(0);
+}
+
+
+/*********************************************************************//**
+ * @brief	    Send a READ or WRITE instruction with its 16bit address,
+ *              CS is left low for the data phase
+ * @param[in] 	SSPx	SSP peripheral definition, should be:
+ * 						- LPC_SSP0: SSP0 peripheral
+ * 						- LPC_SSP1: SSP1 peripheral
+ * @param[in]	instr          EEP_READ or EEP_WRITE
+ * @param[in]	eep_address    EEPROM 16bit address
+ * @return 		None
+ **********************************************************************/
+static void ssp_eep_command (LPC_SSP_TypeDef *SSPx, uint8_t instr, uint16_t eep_address)
+{
+	SSP_DATA_SETUP_Type xferConfig;
+
+	Tx_Buf1[0] = instr;                      /* IR 8bit msb             */
+	Tx_Buf1[1] = (uchar)(eep_address>>8);    // 1st byte extract
+	Tx_Buf1[2] = (uchar)eep_address;         // 2nd byte extract
+
+	CS_Force1 (SSPx, DISABLE);               /* CS low active           */
+	xferConfig.tx_data = Tx_Buf1;            /* Send Instruction Byte    */
+	xferConfig.rx_data = NULL;
+	xferConfig.length = 3;
+	SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
+}
+
+/**
+ * @}
+ */
+
+/* End of Private Functions --------------------------------------------------- */
+
+
 /** @addtogroup EEPROM_Public_Functions
  * @{
  */
@@ -66,13 +148,8 @@ uint8_t Ssp_Eeprom_Read_Status_Reg (LPC_SSP_TypeDef *SSPx)
 	xferConfig.tx_data = NULL;               /* Send Instruction Byte    */
 	SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
 
-	if(Rx_Buf1[0])
-	{
-		CS_Force1 (SSPx, ENABLE);                     /* Select device           */
-		return(Rx_Buf1[0]);                    /* Return value            */
-	}
-	else
-		return(0);
+	CS_Force1 (SSPx, ENABLE);                     /* Deselect device         */
+	return(Rx_Buf1[0]);                    /* Return value            */
 }
 
 
@@ -83,7 +160,7 @@ uint8_t Ssp_Eeprom_Read_Status_Reg (LPC_SSP_TypeDef *SSPx)
  * 						- LPC_SSP1: SSP1 peripheral
  * @return 		None
  **********************************************************************/
-void Read_Eeprom_Status (LPC_SSP_TypeDef *SSPx)
+void Ssp_Read_Eeprom_Status (LPC_SSP_TypeDef *SSPx)
 {
 	uint8_t wpen=0, bp1=0, bp0=0, wel=0, wip=0;
 	uint8_t dat;
@@ -95,7 +172,7 @@ void Read_Eeprom_Status (LPC_SSP_TypeDef *SSPx)
 	if(dat&0x04){bp0 =1;}else{bp0 =0;}
 	if(dat&0x02){wel =1;}else{wel =0;}
 	if(dat&0x01){wip =1;}else{wip =0;}
-	print_status_reg();
+	Ssp_Print_Status_Reg();
 	printf(LPC_UART0,"\n\r%d01    X    X    X       %d01    %d01    %d01    %d01\n\r",wpen,bp1,bp0,wel,wip);
 
 	getche(LPC_UART0);
@@ -114,8 +191,7 @@ void Read_Eeprom_Status (LPC_SSP_TypeDef *SSPx)
 uchar Ssp_Eeprom_Write_Status_Reg (LPC_SSP_TypeDef *SSPx, uint8_t status_reg)
 {
 	SSP_DATA_SETUP_Type xferConfig;
-
-	uint8_t WriteData[1],WriteStatus =0;
+	int32_t WriteStatus;
 
 	Tx_Buf1[0] = EEP_WRSR;                 /* Write Status 8bit msb                     */
 	Tx_Buf1[1] = status_reg;               /* STATUS REGISTER                           */
@@ -123,29 +199,18 @@ uchar Ssp_Eeprom_Write_Status_Reg (LPC_SSP_TypeDef *SSPx, uint8_t status_reg)
                                            /* D7   D6   D5   D4      D3   D2   D1   D0  */
                                            /* WPEN X    X    X   --  BP1  BP0  WEL  WIP */
 
-	WriteData[0] = EEP_WREN;
-
-	CS_Force1 (SSPx, DISABLE);                            /* Select device           */
-
-	xferConfig.tx_data = WriteData;            /* Send Instruction Byte    */
-	xferConfig.rx_data = Rx_Buf1;               /* Store byte in Rx_Buf[0]  */
-	xferConfig.length = 1;
-	SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);  /* Write Enable Latch      */
-	CS_Force1 (SSPx, ENABLE);                          /* CS high inactive        */
+	ssp_eep_write_enable(SSPx);                /* Write Enable Latch      */
 
 	CS_Force1 (SSPx, DISABLE);                            /* Select device           */
 	xferConfig.tx_data = Tx_Buf1;               /* Send Instruction Byte    */
+	xferConfig.rx_data = NULL;
 	xferConfig.length = 2;
 	WriteStatus = SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
+	CS_Force1 (SSPx, ENABLE);                          /* CS high starts the write */
 
-	if(WriteStatus)
-	{
-		CS_Force1 (SSPx, ENABLE);                          /* CS high inactive        */
-		delay_ms(4);
-		return(1);
-	}
-	else
+	if(WriteStatus < 0)
 		return(0);
+	return(ssp_eep_wait_ready(SSPx));
 }
 
 
@@ -160,41 +225,15 @@ uchar Ssp_Eeprom_Write_Status_Reg (LPC_SSP_TypeDef *SSPx, uint8_t status_reg)
  **********************************************************************/
 uchar Ssp_Eeprom_Write_Byte (LPC_SSP_TypeDef *SSPx, uint16 eep_address, uint8_t byte_data)
 {
-	SSP_DATA_SETUP_Type xferConfig;
-	uint8_t WriteData[1],WriteStatus =0;
-
-	Tx_Buf1[0] = EEP_WRITE;                  /* WRITE IR 8bit msb       */
-	Tx_Buf1[1] = (uchar)(eep_address>>8);    // 1st byte extract
-	Tx_Buf1[2] = (uchar) eep_address;        // 2nd byte extract
-	Tx_Buf1[3] = byte_data;                  /* byte data lsb           */
-
-	WriteData[0] = EEP_WREN;
-
-	CS_Force1 (SSPx, DISABLE);
-	xferConfig.tx_data = WriteData;            /* Send Instruction Byte    */
-	xferConfig.rx_data = Rx_Buf1;               /* Store byte in Rx_Buf[0]  */
-	xferConfig.length = 1;
-	SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);  /* Write Enable Latch      */
-	CS_Force1 (SSPx, ENABLE);
-
-	CS_Force1 (SSPx, DISABLE);                              /* CS low active           */
-	xferConfig.tx_data = Tx_Buf1;               /* Send Instruction Byte    */
-	xferConfig.length = 4;
-	WriteStatus = SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
-
-	if(WriteStatus)
-	{
-		CS_Force1 (SSPx, ENABLE);                            /* CS high inactive        */
-		delay_ms(4);
-		return(1);
-	}
-	else
-		return(0);
+	return(Ssp_Eeprom_Write(SSPx, eep_address, &byte_data, 1));
 }
 
 
 /*********************************************************************//**
  * @brief	    Write value array at desired address(0x000 to 0x7FF)
+ *              The array is split on the 16 byte write pages, each page
+ *              is sent with one WRITE instruction and the WIP bit is
+ *              polled until its write cycle is over
  * @param[in] 	SSPx	SSP peripheral definition, should be:
  * 						- LPC_SSP0: SSP0 peripheral
  * 						- LPC_SSP1: SSP1 peripheral
@@ -203,76 +242,36 @@ uchar Ssp_Eeprom_Write_Byte (LPC_SSP_TypeDef *SSPx, uint16 eep_address, uint8_t
  * @param[in]   length         size of buffer
  * @return 		write status
  **********************************************************************/
-uchar Ssp_Eeprom_Write (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *data_start, uint8_t length)
+uchar Ssp_Eeprom_Write (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *data_start, uint16_t length)
 {
 	SSP_DATA_SETUP_Type xferConfig;
-	uint8_t WriteData[1],WriteStatus =0,ip_len,new_length;
-	uint16 new_address;
-
-	WriteData[0] = EEP_WREN;
+	int32_t WriteStatus;
+	uint16_t ip_len;
 
-	Tx_Buf1[0] = EEP_WRITE;                  // WRITE IR 8bit msb
-	Tx_Buf1[1] = (uchar)(eep_address>>8);    // 1st byte extract
-	Tx_Buf1[2] = (uchar)eep_address;         // 2nd byte extract
-
-	/* Intern page length(ip_len) gives length from address that can be occupied in page */
-	ip_len = 0x10 - (eep_address % 0x10);
-	new_address = eep_address + ip_len;
+	if((length > EEP_SIZE) || (eep_address > (EEP_SIZE - length)))
+		return(0);
 
-	if(length > ip_len)
+	while(length)
 	{
-		new_length = length - ip_len;
-
-		CS_Force1 (SSPx, DISABLE);
-		xferConfig.tx_data = WriteData;            /* Send Instruction Byte    */
-		xferConfig.rx_data = Rx_Buf1;               /* Store byte in Rx_Buf[0]  */
-		xferConfig.length = 1;
-		SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);  /* Write Enable Latch      */
-		CS_Force1 (SSPx, ENABLE);
+		/* Intern page length(ip_len) gives length from address that can be occupied in page */
+		ip_len = EEP_PAGE_SIZE - (eep_address % EEP_PAGE_SIZE);
+		if(ip_len > length) ip_len = length;
 
-		CS_Force1 (SSPx, DISABLE);                            // CS low active
-		xferConfig.tx_data = Tx_Buf1;                   /* Send Instruction Byte    */
-		xferConfig.length = 3;
-		SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
+		ssp_eep_write_enable(SSPx);                /* Write Enable Latch      */
+		ssp_eep_command(SSPx, EEP_WRITE, eep_address);
 
 		xferConfig.tx_data = data_start;               // Pass value
+		xferConfig.rx_data = NULL;
 		xferConfig.length = ip_len;
 		WriteStatus = SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
+		CS_Force1 (SSPx, ENABLE);                  /* CS high starts the write */
 
-		if(WriteStatus)
-		{
-			CS_Force1 (SSPx, ENABLE);                            /* CS high inactive        */
-		}
-		else
+		if(WriteStatus < 0 || !ssp_eep_wait_ready(SSPx))
 			return(0);
-		// Recursive function
-		delay_ms(4);
-		Ssp_Eeprom_Write(SSPx, new_address,(data_start + ip_len),new_length);
-	}
-
-	if(length <= ip_len+1)
-	{
-		CS_Force1 (SSPx, DISABLE);
-		xferConfig.tx_data = WriteData;            /* Send Instruction Byte    */
-		xferConfig.rx_data = Rx_Buf1;               /* Store byte in Rx_Buf[0]  */
-		xferConfig.length = 1;
-		SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);  /* Write Enable Latch      */
-		CS_Force1 (SSPx, ENABLE);
-
-		CS_Force1 (SSPx, DISABLE);                            // CS low
-		xferConfig.tx_data = Tx_Buf1;                   /* Send Instruction Byte    */
-		xferConfig.length = 3;
-		SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
 
-		xferConfig.tx_data = data_start;               // Pass value
-		xferConfig.length = length;
-		WriteStatus = SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
-		if(WriteStatus)
-		{
-			CS_Force1 (SSPx, ENABLE);                            /* CS high inactive        */
-		}
-		else
-			return(0);
+		eep_address += ip_len;
+		data_start += ip_len;
+		length -= ip_len;
 	}
 	return(1);
 }
@@ -288,34 +287,18 @@ uchar Ssp_Eeprom_Write (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *da
  **********************************************************************/
 uint8_t Ssp_Eeprom_Read_Byte (LPC_SSP_TypeDef *SSPx, uint16 eep_address)
 {
-	SSP_DATA_SETUP_Type xferConfig;
+	uint8_t dat = 0;
 
-	Tx_Buf1[0] = EEP_READ;                 /* READ IR 8bit msb        */
-	Tx_Buf1[1] = (uchar)(eep_address>>8);  // 1st byte extract
-	Tx_Buf1[2] = (uchar)eep_address;       // 2nd byte extract
-
-	CS_Force1 (SSPx, DISABLE);
-	xferConfig.tx_data = Tx_Buf1;               /* Send Instruction Byte    */
-	xferConfig.rx_data = Rx_Buf1;               /* Store byte in Rx_Buf[0]  */
-	xferConfig.length = 3;
-	SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
-	xferConfig.tx_data = NULL;
-	xferConfig.rx_data = Rx_Buf1;               /* Store byte in Rx_Buf[0]  */
-	xferConfig.length = 1;
-	SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
-
-	if(Rx_Buf1[0])
-	{
-		CS_Force1 (SSPx, ENABLE);
-		return(Rx_Buf1[0]);                    /* Return value            */
-	}
-	else
-		return(0);
+	Ssp_Eeprom_Read(SSPx, eep_address, &dat, 1);
+	return(dat);                    /* Return value            */
 }
 
 
 /*********************************************************************//**
  * @brief	    Read Page value at desired address(0x000 to 0x7FF)
+ *              One READ instruction is sent and the data is clocked out
+ *              sequentially, up to the whole device, in FIFO sized
+ *              bursts with CS held low
  * @param[in] 	SSPx	SSP peripheral definition, should be:
  * 						- LPC_SSP0: SSP0 peripheral
  * 						- LPC_SSP1: SSP1 peripheral
@@ -324,33 +307,33 @@ uint8_t Ssp_Eeprom_Read_Byte (LPC_SSP_TypeDef *SSPx, uint16 eep_address)
  * @param[in]   length         size of buffer
  * @return 		read status
  **********************************************************************/
-uchar Ssp_Eeprom_Read (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *dest_addr, uint8_t length)
+uchar Ssp_Eeprom_Read (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *dest_addr, uint16_t length)
 {
 	SSP_DATA_SETUP_Type xferConfig;
-	uchar ReadStatus =0;
+	uint16_t burst;
+
+	if((length > EEP_SIZE) || (eep_address > (EEP_SIZE - length)))
+		return(0);
 
-	Tx_Buf1[0] = EEP_READ;                      // READ IR 8bit msb
-	Tx_Buf1[1] = (uchar)(eep_address>>8);       // 1st byte extract
-	Tx_Buf1[2] = (uchar)eep_address;            // 2nd byte extract
+	ssp_eep_command(SSPx, EEP_READ, eep_address);
 
-	CS_Force1 (SSPx, DISABLE);
-	xferConfig.tx_data = Tx_Buf1;               /* Send Instruction Byte    */
-	xferConfig.rx_data = Rx_Buf1;               /* Store byte in Rx_Buf[0]  */
-	xferConfig.length = 3;
-	SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
 	xferConfig.tx_data = NULL;
-	xferConfig.rx_data = dest_addr;               /* Store byte  */
-	xferConfig.length = length;
-	ReadStatus = SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING);
-
-	if(ReadStatus)
+	while(length)
 	{
-		CS_Force1 (SSPx, ENABLE);
-		delay_ms(4);
-		return(1);                                // Return value
+		burst = MIN(length, EEP_SSP_BURST);
+		xferConfig.rx_data = dest_addr;               /* Store bytes */
+		xferConfig.length = burst;
+		if(SSP_ReadWrite(SSPx, &xferConfig, SSP_TRANSFER_POLLING) < 0)
+		{
+			CS_Force1 (SSPx, ENABLE);
+			return(0);
+		}
+		dest_addr += burst;
+		length -= burst;
 	}
-	else
-		return(0);
+
+	CS_Force1 (SSPx, ENABLE);
+	return(1);                                // Return value
 }
 
 
@@ -360,7 +343,7 @@ uchar Ssp_Eeprom_Read (LPC_SSP_TypeDef *SSPx, uint16_t eep_address, uint8_t *des
  * @param[in]   length      size of buffer
  * @return 		None
  **********************************************************************/
-void Display_Eeprom_Array (uint8_t *string, uint8_t length)
+void Ssp_Display_Eeprom_Array (uint8_t *string, uint8_t length)
 {
 	while(length)
 	{
@@ -379,34 +362,38 @@ void Display_Eeprom_Array (uint8_t *string, uint8_t length)
  * @param[in]   mem_end_address       End Memory Location
  * @return 		None
  **********************************************************************/
-void Display_Eeprom_Loc (LPC_SSP_TypeDef *SSPx, uint16 mem_start_address, uint16 mem_end_address)
+void Ssp_Display_Eeprom_Loc (LPC_SSP_TypeDef *SSPx, uint16 mem_start_address, uint16 mem_end_address)
 {
 	uint8_t line=0,count=0;
-	uint16_t dat;
-	uint16_t addr;
+	uint8_t row[EEP_PAGE_SIZE];
+	uint16_t addr,len;
 
 	printf(LPC_UART0,"EEPROM Range = 0x000 - 0x7FF \r\n");
 
+	if(mem_end_address >= EEP_SIZE) mem_end_address = EEP_SIZE - 1;
+
 	clr_scr_rst_cur(LPC_UART0);
 	printf(LPC_UART0,"Start: %x03   End: %x03 \r\n",mem_start_address,mem_end_address);
 
-	for(addr=mem_start_address; addr<mem_end_address+1; addr++)
+	for(addr=mem_start_address; addr<mem_end_address+1; addr+=len)
 	{
-		if(count == 0) printf(LPC_UART0,"%x03   ",addr);
-
-		dat = Ssp_Eeprom_Read_Byte(SSPx, addr);   /* read byte from address                  */
+		/* one sequential read per displayed line */
+		len = MIN(EEP_PAGE_SIZE, mem_end_address + 1 - addr);
+		Ssp_Eeprom_Read(SSPx, addr, row, len);
 
-		printf(LPC_UART0,"%x02  ",dat);
-		count++;
+		printf(LPC_UART0,"%x03   ",addr);
+		for(count = 0; count < len; count++)
+		{
+			printf(LPC_UART0,"%x02  ",row[count]);
+		}
 
-		if(count == 16)                    /* check for last digit entered            */
+		if(len == EEP_PAGE_SIZE)             /* check for last digit entered            */
 		{
 			line++;
-			count = 0;
 			printf(LPC_UART0,"\r\n");
 		}
 
-		if(line == 20 || addr == mem_end_address)
+		if(line == 20 || addr + len > mem_end_address)
 		{
 			printf(LPC_UART0,"\x1b[24;01HPress any key to continue.");
 			line = 0;
@@ -29,6 +29,63 @@
 /******************************************************************************/
 static volatile uint16_t TextColor = Black, BackColor = White;
 
+#ifdef GLCD_FB_MODE
+/* Inclusive screen rectangle */
+typedef struct
+{
+	int16_t x0;
+	int16_t y0;
+	int16_t x1;
+	int16_t y1;
+}GLCD_RECT_Type;
+
+static uint16_t *glcd_fb = (uint16_t *)GLCD_FB_BASE;   // Viewport pixels, row major
+static GLCD_RECT_Type glcd_fb_view;                    // Viewport on screen
+static Bool glcd_fb_on = FALSE;
+static GLCD_RECT_Type glcd_dirty[GLCD_FB_DIRTY_MAX];   // Regions changed since flush
+static uint8_t glcd_dirty_num = 0;
+
+static void glcd_fb_mark (int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+static Bool glcd_fb_draw (int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, const uint16_t *pixels);
+
+/* Bank 1 holds the EMAC rings (EMAC_RAM_SIZE) and the SD cache lines */
+#if (GLCD_FB_BASE < LPC_AHBRAM0_BASE) || ((GLCD_FB_BASE + GLCD_FB_SIZE) > LPC_AHBRAM1_BASE)
+	#error GLCD framebuffer must stay within AHB SRAM bank 0
+#endif
+#endif
+
+#ifdef GLCD_COST_MODE
+static GLCD_COST_Type glcd_cost;
+#define GLCD_COST(c,b,w)  do { glcd_cost.commands += (c); glcd_cost.bytes += (b); glcd_cost.windows += (w); } while(0)
+#else
+#define GLCD_COST(c,b,w)
+#endif
+
+#ifdef GLCD_TEXT_OPAQUE
+/* Pixels of one character cell for one size and color pair */
+typedef struct
+{
+	const void *font;
+	uint8_t  c;
+	int8_t   size;
+	uint16_t fg;
+	uint16_t bg;
+	uint32_t used;              // LRU stamp, 0 = empty
+	uint16_t pixels[GLCD_GLYPH_CACHE_PIXELS];
+}GLCD_GLYPH_Type;
+
+static GLCD_GLYPH_Type glcd_glyph[GLCD_GLYPH_CACHE_NUM];
+static uint32_t glcd_glyph_clock = 0;
+static uint16_t glcd_text_line[WIDTH];
+
+static void glcd_text_cell (int16_t x, int16_t y, const void *font, uint8_t c, const uint8_t *data,
+		uint8_t row, uint8_t col, int8_t size, uint16_t color);
+#endif
+
+static void glcd_window_pixels (uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels);
+static void glcd_hspan (int16_t x0, int16_t x1, int16_t y, uint16_t color);
+static void glcd_vspan (int16_t x, int16_t y0, int16_t y1, uint16_t color);
+
 // Swap two bytes
 #define SWAP(x,y) do { (x)=(x)^(y); (y)=(x)^(y); (x)=(x)^(y); } while(0)
 #define bit_test(D,i) (D & (0x01 << i))
@@ -120,6 +177,8 @@ void GLCD_Driver_OutCtrl (DRIVER_OUT_Type drv)
  **********************************************************************/
 void GLCD_Window (uint16_t x, uint16_t y, uint16_t w, uint16_t h)
 {
+	GLCD_COST(0, 0, 1);
+
 	Write_Command_Glcd(0x45);      /* Horizontal GRAM Start Address      */
 	Write_Data_Glcd(x);
 
@@ -180,6 +239,10 @@ void GLCD_Init (void)
 
 	GLCD_Reset();                // Reset GLCD
 
+#ifdef GLCD_DMA_MODE
+	GPDMA_Init();                // Pixel streams use GPDMA
+#endif
+
 	Write_Command_Glcd(0x28);    // VCOM OTP
 	Write_Data_Glcd(0x0006);     // Page 55-56 of SSD2119 datasheet
 
@@ -281,6 +344,16 @@ void GLCD_Init (void)
  **********************************************************************/
 void GLCD_PutPixel (uint16_t x, uint16_t y, uint16_t color)
 {
+#ifdef GLCD_FB_MODE
+	if (glcd_fb_on && (x >= glcd_fb_view.x0) && (x <= glcd_fb_view.x1) \
+		&& (y >= glcd_fb_view.y0) && (y <= glcd_fb_view.y1))
+	{
+		glcd_fb[(y - glcd_fb_view.y0) * (glcd_fb_view.x1 - glcd_fb_view.x0 + 1) \
+				+ (x - glcd_fb_view.x0)] = color;
+		glcd_fb_mark(x, y, x, y);
+		return;
+	}
+#endif
 	Write_Command_Glcd(0x4E);     /* GDDRAM Horizontal */
 	Write_Data_Glcd(x);
 
@@ -315,69 +388,323 @@ void GLCD_SetBackColor (uint16_t color)
 
 
 /*********************************************************************//**
- * @brief	    Start of data writing to LCD controller
+ * @brief	    Write one pixel to the SSP1 TX FIFO, waits only while the
+ *              FIFO is full (stream must be started)
+ * @param[in]	c     pixel color
+ * @return 		None
+ **********************************************************************/
+static __INLINE void glcd_stream_put (uint16_t c)
+{
+	while (!(LPC_SSP1->SR & SSP_SR_TNF));
+	LPC_SSP1->DR = c;
+	GLCD_COST(0, 2, 0);
+}
+
+
+/*********************************************************************//**
+ * @brief	    Start a pixel stream to GRAM: select data mode, keep CS
+ *              asserted and switch SSP1 to 16-bit frames so that one FIFO
+ *              entry carries one pixel. GRAM write (0x22) must already
+ *              be selected, e.g. by GLCD_Set_Loc()
  * @param[in]	None
  * @return 		None
  **********************************************************************/
-static __INLINE void wr_dat_start (void)
+void GLCD_Stream_Start (void)
 {
-	CS_Force1 (LPC_SSP1, DISABLE);
 	GPIO_SetValue(2, LCD_RS);  // select data mode
+	CS_Force1 (LPC_SSP1, DISABLE);
+
+	SSP_Cmd(LPC_SSP1, DISABLE);
+	LPC_SSP1->CR0 = (LPC_SSP1->CR0 & (~SSP_CR0_DSS(16)) & SSP_CR0_BITMASK) | SSP_DATABIT_16;
+	SSP_Cmd(LPC_SSP1, ENABLE);
+}
+
+
+/*********************************************************************//**
+ * @brief	    Stream a run of pixels, the TX FIFO is kept full and the
+ *              receive side is ignored until GLCD_Stream_Stop()
+ * @param[in]	pixels   pointer to pixel data
+ *              count    number of pixels
+ * @return 		None
+ **********************************************************************/
+void GLCD_Stream_Pixels (const uint16_t *pixels, uint32_t count)
+{
+#ifdef GLCD_DMA_MODE
+	SSP_DATA_SETUP_Type xferConfig;
+
+	// Let frames queued by the CPU finish so RX DMA only counts its own
+	while (LPC_SSP1->SR & SSP_SR_BSY);
+
+	xferConfig.tx_data = (void *)pixels;
+	xferConfig.rx_data = NULL;
+	xferConfig.length = count * 2;
+	if (SSP_ReadWrite(LPC_SSP1, &xferConfig, SSP_TRANSFER_DMA) == 0)
+	{
+		GLCD_COST(0, count * 2, 0);
+		while (SSP_DMABusy(LPC_SSP1) == SET);
+		return;
+	}
+	// No DMA channel free, fall back to the FIFO loop
+#endif
+	while (count--)
+	{
+		glcd_stream_put(*pixels++);
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief	    Stream a run of pixels of the same color
+ * @param[in]	color    pixel color
+ *              count    number of pixels
+ * @return 		None
+ **********************************************************************/
+void GLCD_Stream_Fill (uint16_t color, uint32_t count)
+{
+#ifdef GLCD_DMA_MODE
+	static uint16_t fill_buf[GLCD_FILL_BUF];
+	uint32_t i, n;
+
+	n = MIN(count, GLCD_FILL_BUF);
+	for (i = 0; i < n; i++)
+	{
+		fill_buf[i] = color;
+	}
+	while (count)
+	{
+		n = MIN(count, GLCD_FILL_BUF);
+		GLCD_Stream_Pixels(fill_buf, n);
+		count -= n;
+	}
+#else
+	while (count--)
+	{
+		glcd_stream_put(color);
+	}
+#endif
 }
 
 
 /*********************************************************************//**
- * @brief	    Stop of data writing to LCD controller
+ * @brief	    End a pixel stream: wait for the last frame, discard the
+ *              receive FIFO, restore 8-bit frames and release CS
  * @param[in]	None
  * @return 		None
  **********************************************************************/
-static __INLINE void wr_dat_stop (void)
+void GLCD_Stream_Stop (void)
 {
+	while (LPC_SSP1->SR & SSP_SR_BSY);
+	while (LPC_SSP1->SR & SSP_SR_RNE)
+	{
+		(void)LPC_SSP1->DR;
+	}
+	LPC_SSP1->ICR = SSP_ICR_BITMASK;    // Clear overrun of ignored RX data
+
+	SSP_Cmd(LPC_SSP1, DISABLE);
+	LPC_SSP1->CR0 = (LPC_SSP1->CR0 & (~SSP_CR0_DSS(16)) & SSP_CR0_BITMASK) | SSP_DATABIT_8;
+	SSP_Cmd(LPC_SSP1, ENABLE);
+
 	CS_Force1 (LPC_SSP1, ENABLE);
 }
 
 
+#ifdef GLCD_FB_MODE
 /*********************************************************************//**
- * @brief	    Data writing to LCD controller
- * @param[in]	c     data to be written
+ * @brief	    Add a region to the dirty list, merged into the entry that
+ *              grows least when that costs no more than GLCD_FB_MERGE_SLACK
+ *              clean pixels or when the list is full
+ * @param[in]	(x0,y0)  top left corner (inclusive)
+ *              (x1,y1)  bottom right corner (inclusive)
  * @return 		None
  **********************************************************************/
-static __INLINE void wr_dat_only (uint16_t c)
+static void glcd_fb_mark (int16_t x0, int16_t y0, int16_t x1, int16_t y1)
 {
-	SSP_DATA_SETUP_Type xferConfig;
+	GLCD_RECT_Type *r;
+	int32_t cost, best_cost = 0x7FFFFFFF;
+	uint8_t i, best = 0;
 
-	Tx_Buf1[0] = (uchar)(c>>8);    // 1st byte extract
-	Tx_Buf1[1] = (uchar) c;        // 2nd byte extract
+	for (i = 0; i < glcd_dirty_num; i++)
+	{
+		r = &glcd_dirty[i];
+		cost = (int32_t)(MAX(r->x1, x1) - MIN(r->x0, x0) + 1) * (MAX(r->y1, y1) - MIN(r->y0, y0) + 1) \
+				- (int32_t)(r->x1 - r->x0 + 1) * (r->y1 - r->y0 + 1) \
+				- (int32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+		if (cost < best_cost)
+		{
+			best_cost = cost;
+			best = i;
+		}
+	}
 
-	xferConfig.tx_data = Tx_Buf1;               /* Send Instruction Byte    */
-	xferConfig.rx_data = NULL;
-	xferConfig.length = 2;
-	SSP_ReadWrite(LPC_SSP1, &xferConfig, SSP_TRANSFER_POLLING);
+	if ((glcd_dirty_num == 0) || \
+		((best_cost > GLCD_FB_MERGE_SLACK) && (glcd_dirty_num < GLCD_FB_DIRTY_MAX)))
+	{
+		r = &glcd_dirty[glcd_dirty_num++];
+		r->x0 = x0;
+		r->y0 = y0;
+		r->x1 = x1;
+		r->y1 = y1;
+		return;
+	}
+
+	r = &glcd_dirty[best];
+	r->x0 = MIN(r->x0, x0);
+	r->y0 = MIN(r->y0, y0);
+	r->x1 = MAX(r->x1, x1);
+	r->y1 = MAX(r->y1, y1);
 }
 
 
 /*********************************************************************//**
- * @brief	    Clear display
- * @param[in]	color    display clearing color
+ * @brief	    Draw a filled or bitmap window into the framebuffer. The
+ *              part inside the viewport is always written so RAM stays
+ *              coherent with the panel
+ * @param[in]	x,y,w,h  window on screen
+ *              color    fill color, used when pixels is NULL
+ *              pixels   row major window pixels or NULL
+ * @return 		TRUE if the window lies inside the viewport and was only
+ *              buffered (marked dirty), FALSE if the caller must also
+ *              draw it on the panel
+ **********************************************************************/
+static Bool glcd_fb_draw (int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, const uint16_t *pixels)
+{
+	int16_t x0, y0, x1, y1, i, j, stride;
+	uint16_t *dst;
+
+	x0 = MAX(x, glcd_fb_view.x0);
+	y0 = MAX(y, glcd_fb_view.y0);
+	x1 = MIN(x + w - 1, glcd_fb_view.x1);
+	y1 = MIN(y + h - 1, glcd_fb_view.y1);
+	if ((x0 > x1) || (y0 > y1))
+	{
+		return FALSE;
+	}
+
+	stride = glcd_fb_view.x1 - glcd_fb_view.x0 + 1;
+	for (j = y0; j <= y1; j++)
+	{
+		dst = &glcd_fb[(j - glcd_fb_view.y0) * stride + (x0 - glcd_fb_view.x0)];
+		for (i = x0; i <= x1; i++)
+		{
+			*dst++ = (pixels == NULL) ? color : pixels[(j - y) * w + (i - x)];
+		}
+	}
+
+	if ((x0 == x) && (y0 == y) && (x1 == x + w - 1) && (y1 == y + h - 1))
+	{
+		glcd_fb_mark(x0, y0, x1, y1);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+
+/*********************************************************************//**
+ * @brief	    Route drawing inside a viewport to the RAM framebuffer,
+ *              the panel is only updated by GLCD_Flush(). The viewport
+ *              starts as BackColor and fully dirty
+ * @param[in]	x        horizontal position
+ *              y        vertical position
+ *              w        viewport width
+ *              h        viewport height
+ * @return 		SUCCESS, or ERROR if w*h exceeds GLCD_FB_PIXELS or the
+ *              viewport leaves the screen
+ **********************************************************************/
+Status GLCD_FB_Enable (uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+	if ((w == 0) || (h == 0) || ((uint32_t)w*h > GLCD_FB_PIXELS) \
+		|| (x + w > WIDTH) || (y + h > HEIGHT))
+	{
+		return ERROR;
+	}
+
+	if (glcd_fb_on)
+	{
+		GLCD_Flush();
+	}
+
+	glcd_fb_view.x0 = x;
+	glcd_fb_view.y0 = y;
+	glcd_fb_view.x1 = x + w - 1;
+	glcd_fb_view.y1 = y + h - 1;
+	glcd_dirty_num = 0;
+	glcd_fb_on = TRUE;
+
+	glcd_fb_draw(x, y, w, h, BackColor, NULL);
+	return SUCCESS;
+}
+
+
+/*********************************************************************//**
+ * @brief	    Flush pending changes and return to direct drawing
+ * @param[in]	None
  * @return 		None
  **********************************************************************/
-void GLCD_Clear (uint16_t color)
+void GLCD_FB_Disable (void)
 {
-	unsigned int   i;
+	if (glcd_fb_on)
+	{
+		GLCD_Flush();
+		glcd_fb_on = FALSE;
+	}
+}
 
-	GLCD_Window (0,0,320,240);    // Window Max
 
-	Write_Command_Glcd(0x4E);     /* GDDRAM Horizontal */
-	Write_Data_Glcd(0);
+/*********************************************************************//**
+ * @brief	    Push every dirty region of the framebuffer to the panel,
+ *              one window and one pixel stream per region
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void GLCD_Flush (void)
+{
+	GLCD_RECT_Type *r;
+	int16_t j, stride;
+	uint8_t i;
 
-	Write_Command_Glcd(0x4F);     /* GDDRAM Vertical */
-	Write_Data_Glcd(0);
+	if (!glcd_fb_on)
+	{
+		return;
+	}
+
+	stride = glcd_fb_view.x1 - glcd_fb_view.x0 + 1;
+	for (i = 0; i < glcd_dirty_num; i++)
+	{
+		r = &glcd_dirty[i];
+		GLCD_Set_Loc(r->x0, r->y0, r->x1 - r->x0 + 1, r->y1 - r->y0 + 1);
+
+		GLCD_Stream_Start();
+		for (j = r->y0; j <= r->y1; j++)
+		{
+			GLCD_Stream_Pixels(&glcd_fb[(j - glcd_fb_view.y0) * stride + (r->x0 - glcd_fb_view.x0)], \
+					r->x1 - r->x0 + 1);
+		}
+		GLCD_Stream_Stop();
+	}
+	glcd_dirty_num = 0;
+}
+#endif
+
+
+/*********************************************************************//**
+ * @brief	    Clear display
+ * @param[in]	color    display clearing color
+ * @return 		None
+ **********************************************************************/
+void GLCD_Clear (uint16_t color)
+{
+#ifdef GLCD_FB_MODE
+	if (glcd_fb_on)
+	{
+		glcd_fb_draw(0, 0, WIDTH, HEIGHT, color, NULL);   // Keep viewport coherent
+		glcd_dirty_num = 0;                               // Panel is written below
+	}
+#endif
+	GLCD_Set_Loc (0,0,WIDTH,HEIGHT);    // Window Max, cursor home, GRAM write
 
-	Write_Command_Glcd(0x22);
-	wr_dat_start();
-	for(i = 0; i < (WIDTH*HEIGHT); i++)
-		wr_dat_only(color);
-	wr_dat_stop();
+	GLCD_Stream_Start();
+	GLCD_Stream_Fill(color, WIDTH*HEIGHT);
+	GLCD_Stream_Stop();
 }
 
 
@@ -390,47 +717,43 @@ void GLCD_Clear (uint16_t color)
  **********************************************************************/
 void GLCD_Draw_Char (uint16_t x, uint16_t y, uint16_t *c)
 {
-	int idx = 0, i, j;
+	int i, j;
 
 	x = x-CHAR_W;
 
-	Write_Command_Glcd(0x45);      /* Horizontal GRAM Start Address      */
-	Write_Data_Glcd(x);
-
-	Write_Command_Glcd(0x46);      /* Horizontal GRAM End   Address (-1) */
-	Write_Data_Glcd(x+CHAR_W-1);
-
-	Write_Command_Glcd(0x44);      /* Vertical   GRAM Start Address      */
-	Write_Data_Glcd(y);
-
-	Write_Command_Glcd(0x44);      /* Vertical   GRAM End   Address (-1) */
-	Write_Data_Glcd((y+CHAR_H-1)<<8);
-
-	Write_Command_Glcd(0x4E);     /* GDDRAM Horizontal */
-	Write_Data_Glcd(x);
+#ifdef GLCD_FB_MODE
+	if (glcd_fb_on)
+	{
+		uint16_t row[CHAR_W];
+		Bool inside = TRUE;
 
-	Write_Command_Glcd(0x4F);     /* GDDRAM Vertical */
-	Write_Data_Glcd(y);
+		for (j = 0; j < CHAR_H; j++)
+		{
+			for (i = 0; i<CHAR_W; i++)
+			{
+				row[i] = ((c[j] & (1 << i)) == 0x00) ? BackColor : TextColor;
+			}
+			inside &= glcd_fb_draw(x, y+j, CHAR_W, 1, 0, row);
+		}
+		if (inside)
+		{
+			return;
+		}
+	}
+#endif
 
-	Write_Command_Glcd(0x22);
+	GLCD_Set_Loc (x,y,CHAR_W,CHAR_H);
 
-	wr_dat_start();
+	GLCD_Stream_Start();
 	for (j = 0; j < CHAR_H; j++)
 	{
 		for (i = 0; i<CHAR_W; i++)
 		{
-			if((c[idx] & (1 << i)) == 0x00)
-			{
-				wr_dat_only(BackColor);
-			}
-			else
-			{
-				wr_dat_only(TextColor);
-			}
+			glcd_stream_put(((*c & (1 << i)) == 0x00) ? BackColor : TextColor);
 		}
 		c++;
 	}
-	wr_dat_stop();
+	GLCD_Stream_Stop();
 }
 
 
@@ -491,20 +814,7 @@ void GLCD_ClearLn (uint16_t ln)
  **********************************************************************/
 void GLCD_Bitmap (uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *bitmap)
 {
-	uint32_t i,j,k;
-
-	GLCD_Set_Loc (x,y,w,h);
-
-	wr_dat_start();
-	k = 16;
-	for (j = 0; j < h; j++)
-	{
-		for (i = 0; i < w; i++)
-		{
-			wr_dat_only(bitmap[k++]);
-		}
-	}
-	wr_dat_stop();
+	glcd_window_pixels(x, y, w, h, &bitmap[16]);
 }
 
 
@@ -522,19 +832,17 @@ void GLCD_Bitmap (uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *bitm
  **********************************************************************/
 void GLCD_Window_Fill (uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
 {
-	uint32_t i,j;
-
-	GLCD_Set_Loc (x,y,w,h);
-
-	wr_dat_start();
-	for (j = 0; j < h; j++)
+#ifdef GLCD_FB_MODE
+	if (glcd_fb_on && glcd_fb_draw(x, y, w, h, color, NULL))
 	{
-		for (i = 0; i < w; i++)
-		{
-			wr_dat_only(color);
-		}
+		return;
 	}
-	wr_dat_stop();
+#endif
+	GLCD_Set_Loc (x,y,w,h);
+
+	GLCD_Stream_Start();
+	GLCD_Stream_Fill(color, (uint32_t)w*h);
+	GLCD_Stream_Stop();
 }
 
 
@@ -548,9 +856,20 @@ void GLCD_Window_Fill (uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t
  **********************************************************************/
 void GLCD_Line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
 {
-	int16_t  x, y, addx, addy, dx, dy;
+	int16_t  x, y, addx, addy, dx, dy, start;
 	int32_t P,i;
 
+	if(y1 == y2)                   // Axis aligned, one span
+	{
+		glcd_hspan(x1, x2, y1, color);
+		return;
+	}
+	if(x1 == x2)
+	{
+		glcd_vspan(x1, y1, y2, color);
+		return;
+	}
+
 	dx = abs((int16_t)(x2 - x1));
 	dy = abs((int16_t)(y2 - y1));
 	x = x1;
@@ -569,10 +888,14 @@ void GLCD_Line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
 	if(dx >= dy)
 	{
 		P = 2*dy - dx;
+		start = x;
 
 		for(i=0; i<=dx; ++i)
 		{
-			GLCD_PutPixel(x, y, color);
+			if((P >= 0) || (i == dx))  // Row ends here, draw its run
+			{
+				glcd_hspan(start, x, y, color);
+			}
 
 			if(P < 0)
 			{
@@ -584,16 +907,21 @@ void GLCD_Line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
 				P += 2*dy - 2*dx;
 				x += addx;
 				y += addy;
+				start = x;
 			}
 		}
 	}
 	else
 	{
 		P = 2*dx - dy;
+		start = y;
 
 		for(i=0; i<=dy; ++i)
 		{
-			GLCD_PutPixel(x, y, color);
+			if((P >= 0) || (i == dy))  // Column ends here, draw its run
+			{
+				glcd_vspan(x, start, y, color);
+			}
 
 			if(P < 0)
 			{
@@ -605,6 +933,7 @@ void GLCD_Line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
 				P += 2*dx - 2*dy;
 				x += addx;
 				y += addy;
+				start = y;
 			}
 		}
 	}
@@ -893,19 +1222,28 @@ void GLCD_Triangle(COORDINATE_Type *p1, COORDINATE_Type *p2, COORDINATE_Type *p3
  **********************************************************************/
 void GLCD_Circle(int16_t x, int16_t y, int16_t radius,COLORCFG_Type *cfg)
 {
-	int16_t a, b, P;
+	int16_t a, b, P, start;
+	Bool last;
+
 	a = 0;
 	b = radius;
 	P = 1 - radius;
 
 	do
 	{
+		// b drops or the octant ends after this step
+		last = (P >= 0) || (a + 1 > b);
+
 		if(cfg->fill)
 		{
-			GLCD_Line(x-a, y+b, x+a, y+b, cfg->fill_color);
-			GLCD_Line(x-a, y-b, x+a, y-b, cfg->fill_color);
-			GLCD_Line(x-b, y+a, x+b, y+a, cfg->fill_color);
-			GLCD_Line(x-b, y-a, x+b, y-a, cfg->fill_color);
+			glcd_hspan(x-b, x+b, y+a, cfg->fill_color);
+			if(a)
+				glcd_hspan(x-b, x+b, y-a, cfg->fill_color);
+			if(last)               // Widest span of rows y+-b
+			{
+				glcd_hspan(x-a, x+a, y+b, cfg->fill_color);
+				glcd_hspan(x-a, x+a, y-b, cfg->fill_color);
+			}
 		}
 
 		if(P < 0)
@@ -918,24 +1256,32 @@ void GLCD_Circle(int16_t x, int16_t y, int16_t radius,COLORCFG_Type *cfg)
 	a = 0;
 	b = radius;
 	P = 1 - radius;
+	start = 0;
 	do
 	{
-		if(!cfg->fill && cfg->bndry)
+		last = (P >= 0) || (a + 1 > b);
+
+		// Points of one octant sharing b form a run, mirrored as
+		// horizontal spans on rows y+-b and vertical spans on columns x+-b
+		if(!cfg->fill && last && cfg->bndry)
 		{
-			GLCD_PutPixel(a+x, b+y, cfg->bcolor);
-			GLCD_PutPixel(b+x, a+y, cfg->bcolor);
-			GLCD_PutPixel(x-a, b+y, cfg->bcolor);
-			GLCD_PutPixel(x-b, a+y, cfg->bcolor);
-			GLCD_PutPixel(b+x, y-a, cfg->bcolor);
-			GLCD_PutPixel(a+x, y-b, cfg->bcolor);
-			GLCD_PutPixel(x-a, y-b, cfg->bcolor);
-			GLCD_PutPixel(x-b, y-a, cfg->bcolor);
+			glcd_hspan(x+start, x+a, y+b, cfg->bcolor);
+			glcd_hspan(x-a, x-start, y+b, cfg->bcolor);
+			glcd_hspan(x+start, x+a, y-b, cfg->bcolor);
+			glcd_hspan(x-a, x-start, y-b, cfg->bcolor);
+			glcd_vspan(x+b, y+start, y+a, cfg->bcolor);
+			glcd_vspan(x+b, y-a, y-start, cfg->bcolor);
+			glcd_vspan(x-b, y+start, y+a, cfg->bcolor);
+			glcd_vspan(x-b, y-a, y-start, cfg->bcolor);
 		}
 
 		if(P < 0)
 			P+= 3 + 2*a++;
 		else
 			P+= 5 + 2*(a++ - b--);
+
+		if(last)
+			start = a;
 	} while(a <= b);
 }
 
@@ -953,10 +1299,10 @@ void GLCD_Circle(int16_t x, int16_t y, int16_t radius,COLORCFG_Type *cfg)
  **********************************************************************/
 void GLCD_Text(int16_t x, int16_t y, uint8_t* textptr, uint16_t length, uint8_t row, uint8_t col, int8_t (*font)[row], int8_t size, uint16_t color)
 {
-   int16_t i, j, k, l, m;                     // Loop counters
+   int16_t i;                                 // Loop counter
    uint8_t pixelData[row];                     // Stores character data
 
-   for(i=0; i<length; ++i, ++x) // Loop through the passed string
+   for(i=0; i<length; ++i) // Loop through the passed string
    {
       memcpy(pixelData, font[textptr[i]-' '], row);
 
@@ -965,22 +1311,30 @@ void GLCD_Text(int16_t x, int16_t y, uint8_t* textptr, uint16_t length, uint8_t
          x = 0;                           // Set x at far left position
          y += row*size + 1;                 // Set y at next position down
       }
-      for(j=0; j<row; ++j, x+=size)         // Loop through character byte data
+#ifdef GLCD_TEXT_OPAQUE
+      glcd_text_cell(x, y, font, textptr[i], pixelData, row, col, size, color);
+#else
+      int16_t j, k, k0;
+
+      for(j=0; j<row; ++j)                  // Loop through character byte data
       {
-         for(k=0; k<col*size; ++k)          // Loop through the vertical pixels
+         for(k=0; k<col; )                  // Runs of set pixels in the column
          {
-            if(bit_test(pixelData[j], k)) // Check if the pixel should be set
+            if(!bit_test(pixelData[j], k))
             {
-               for(l=0; l<size; ++l)      // The next two loops change the
-               {                          // character's size
-                  for(m=0; m<size; ++m)
-                  {
-                     GLCD_PutPixel(x+m, y+k*size+l, color); // Draws the pixel
-                  }
-               }
+               k++;
+               continue;
             }
+            for(k0=k; (k<col) && bit_test(pixelData[j], k); k++);
+
+            if(size == 1)
+               glcd_vspan(x+j, y+k0, y+k-1, color);
+            else
+               GLCD_Window_Fill(x+j*size, y+k0*size, size, (k-k0)*size, color);
          }
       }
+#endif
+      x += row*size + 1;
    }
 }
 
@@ -2167,6 +2521,255 @@ void Show_BarGraph_VI(void)
 }
 
 
+/*********************************************************************//**
+ * @brief	    Draw a window of pixels, buffered when it lies inside the
+ *              framebuffer viewport
+ * @param[in]	x,y,w,h  window on screen
+ *              pixels   row major window pixels
+ * @return 		None
+ **********************************************************************/
+static void glcd_window_pixels (uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels)
+{
+#ifdef GLCD_FB_MODE
+	if (glcd_fb_on && glcd_fb_draw(x, y, w, h, 0, pixels))
+	{
+		return;
+	}
+#endif
+	GLCD_Set_Loc (x,y,w,h);
+
+	GLCD_Stream_Start();
+	GLCD_Stream_Pixels(pixels, (uint32_t)w*h);
+	GLCD_Stream_Stop();
+}
+
+
+#ifdef GLCD_TEXT_OPAQUE
+/*********************************************************************//**
+ * @brief	    Expand one font row into a cell row: each bit becomes size
+ *              pixels of color or BackColor, plus the spacing pixel
+ * @param[in]	data     font column bytes
+ *              row      number of font columns
+ *              k        font row (bit number)
+ *              size     scale factor
+ *              color    text color
+ *              line     output, row*size+1 pixels
+ * @return 		None
+ **********************************************************************/
+static void glcd_text_row (const uint8_t *data, uint8_t row, uint8_t k, int8_t size, uint16_t color, uint16_t *line)
+{
+	uint8_t j;
+	int8_t m;
+	uint16_t c;
+
+	for (j = 0; j < row; j++)
+	{
+		c = bit_test(data[j], k) ? color : BackColor;
+		for (m = 0; m < size; m++)
+		{
+			*line++ = c;
+		}
+	}
+	*line = BackColor;
+}
+
+
+/*********************************************************************//**
+ * @brief	    Draw one opaque character cell of (row*size+1) x (col*size)
+ *              pixels as a single window burst. Cells that fit an entry
+ *              come from the glyph cache, the least recently used entry
+ *              is refilled on a miss
+ * @param[in]	(x,y)    upper left corner of the cell
+ *              font     font table, part of the cache key
+ *              c        character, part of the cache key
+ *              data     font column bytes of c
+ *              row      number of font columns
+ *              col      number of font rows
+ *              size     scale factor
+ *              color    text color
+ * @return 		None
+ **********************************************************************/
+static void glcd_text_cell (int16_t x, int16_t y, const void *font, uint8_t c, const uint8_t *data,
+		uint8_t row, uint8_t col, int8_t size, uint16_t color)
+{
+	GLCD_GLYPH_Type *g, *lru;
+	uint16_t w, h, r;
+	uint8_t i, k;
+	int8_t l;
+
+	w = row*size + 1;
+	h = col*size;
+
+	if ((uint32_t)w*h > GLCD_GLYPH_CACHE_PIXELS)
+	{
+		if (w > WIDTH)
+		{
+			return;
+		}
+#ifdef GLCD_FB_MODE
+		if (glcd_fb_on)
+		{
+			Bool inside = TRUE;
+
+			for (r = 0; r < h; r++)
+			{
+				glcd_text_row(data, row, r/size, size, color, glcd_text_line);
+				inside &= glcd_fb_draw(x, y+r, w, 1, 0, glcd_text_line);
+			}
+			if (inside)
+			{
+				return;
+			}
+		}
+#endif
+		GLCD_Set_Loc (x,y,w,h);
+
+		GLCD_Stream_Start();
+		for (k = 0; k < col; k++)
+		{
+			glcd_text_row(data, row, k, size, color, glcd_text_line);
+			for (l = 0; l < size; l++)
+			{
+				GLCD_Stream_Pixels(glcd_text_line, w);
+			}
+		}
+		GLCD_Stream_Stop();
+		return;
+	}
+
+	lru = &glcd_glyph[0];
+	for (i = 0; i < GLCD_GLYPH_CACHE_NUM; i++)
+	{
+		g = &glcd_glyph[i];
+		if (g->used && (g->font == font) && (g->c == c) && (g->size == size) \
+			&& (g->fg == color) && (g->bg == BackColor))
+		{
+			break;
+		}
+		if (g->used < lru->used)
+		{
+			lru = g;
+		}
+	}
+
+	if (i == GLCD_GLYPH_CACHE_NUM)        // Miss, expand into the LRU entry
+	{
+		g = lru;
+		g->font = font;
+		g->c = c;
+		g->size = size;
+		g->fg = color;
+		g->bg = BackColor;
+		for (r = 0; r < h; r++)
+		{
+			if (r % size)
+			{
+				memcpy(&g->pixels[r*w], &g->pixels[(r-1)*w], w * BYPP);
+			}
+			else
+			{
+				glcd_text_row(data, row, r/size, size, color, &g->pixels[r*w]);
+			}
+		}
+	}
+	g->used = ++glcd_glyph_clock;
+
+	glcd_window_pixels(x, y, w, h, g->pixels);
+}
+#endif
+
+
+/*********************************************************************//**
+ * @brief	    Draw a horizontal span clipped to the screen, short spans
+ *              are drawn as pixels (see GLCD_SPAN_MIN)
+ * @param[in]	x0, x1   end columns, any order
+ *              y        row
+ *              color    span color
+ * @return 		None
+ **********************************************************************/
+static void glcd_hspan (int16_t x0, int16_t x1, int16_t y, uint16_t color)
+{
+	if(x0 > x1) SWAP(x0, x1);
+	x0 = MAX(x0, 0);
+	x1 = MIN(x1, WIDTH-1);
+	if((x0 > x1) || (y < 0) || (y >= HEIGHT))
+	{
+		return;
+	}
+
+	if(x1 - x0 + 1 < GLCD_SPAN_MIN)
+	{
+		for(; x0 <= x1; x0++)
+		{
+			GLCD_PutPixel(x0, y, color);
+		}
+	}
+	else
+	{
+		GLCD_Window_Fill(x0, y, x1 - x0 + 1, 1, color);
+	}
+}
+
+
+/*********************************************************************//**
+ * @brief	    Draw a vertical span clipped to the screen, short spans
+ *              are drawn as pixels (see GLCD_SPAN_MIN)
+ * @param[in]	x        column
+ *              y0, y1   end rows, any order
+ *              color    span color
+ * @return 		None
+ **********************************************************************/
+static void glcd_vspan (int16_t x, int16_t y0, int16_t y1, uint16_t color)
+{
+	if(y0 > y1) SWAP(y0, y1);
+	y0 = MAX(y0, 0);
+	y1 = MIN(y1, HEIGHT-1);
+	if((y0 > y1) || (x < 0) || (x >= WIDTH))
+	{
+		return;
+	}
+
+	if(y1 - y0 + 1 < GLCD_SPAN_MIN)
+	{
+		for(; y0 <= y1; y0++)
+		{
+			GLCD_PutPixel(x, y0, color);
+		}
+	}
+	else
+	{
+		GLCD_Window_Fill(x, y0, 1, y1 - y0 + 1, color);
+	}
+}
+
+
+#ifdef GLCD_COST_MODE
+/*********************************************************************//**
+ * @brief	    Clear the SSP traffic counters
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void GLCD_Cost_Reset (void)
+{
+	glcd_cost.commands = 0;
+	glcd_cost.bytes = 0;
+	glcd_cost.windows = 0;
+}
+
+
+/*********************************************************************//**
+ * @brief	    Read the SSP traffic spent since GLCD_Cost_Reset(), e.g.
+ *              around one primitive to compare rasterizer changes
+ * @param[in]	cost     pointer to counters to fill
+ * @return 		None
+ **********************************************************************/
+void GLCD_Cost_Get (GLCD_COST_Type *cost)
+{
+	*cost = glcd_cost;
+}
+#endif
+
+
 /*********************************************************************//**
  * @brief	    This function writes commands to the GLCD
  * @param[in]	Command		command to be written on GLCD
@@ -2178,6 +2781,7 @@ uchar Write_Command_Glcd (uint8_t Command)
 	uint8_t WriteStatus =0;
 	__IO uint32_t i;
 
+	GLCD_COST(1, 1, 0);
 	GPIO_ClearValue(2, LCD_RS);  //select command mode
 
 	CS_Force1 (LPC_SSP1, DISABLE);                        /* Select device           */
@@ -2208,6 +2812,7 @@ uchar Write_Data_Glcd (uint16_t data)
 	SSP_DATA_SETUP_Type xferConfig;
 	uint8_t WriteStatus =0;
 
+	GLCD_COST(0, 2, 0);
 	Tx_Buf1[0] = (uchar)(data>>8);    // 1st byte extract
 	Tx_Buf1[1] = (uchar) data;        // 2nd byte extract
 
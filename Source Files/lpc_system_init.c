@@ -14,6 +14,7 @@
 
 /* Includes ------------------------------------------------------------------- */
 #include "lpc_system_init.h"
+#include "lpc_config.h"
 
 /* If this source file built with example, the LPC17xx FW library configuration
  * file in each example directory ("lpc17xx_libcfg.h") must be included,
@@ -37,9 +38,10 @@ void System_Init(void)
 	SystemInit();						// Initialize system and update core clock
 	Port_Init();                        // Port Initialization
 	SYSTICK_Config();                   // Systick Initialization
-	UART_Config(LPC_UART0, 9600);      // Uart0 Initialization
-	UART_Config(LPC_UART2, 115200);     // Uart2 Initialization
-	led_delay = 1000;                   // Heart Beat rate of 1Sec toggle
+	CFG_Load();                         // Settings from RTC mirror or EEPROM
+	UART_Config(LPC_UART0, CFG_Get()->uart0_baud);   // Uart0 Initialization
+	UART_Config(LPC_UART2, CFG_Get()->uart2_baud);   // Uart2 Initialization
+	led_delay = CFG_Get()->led_delay;   // Heart Beat toggle, 1Sec by default
 }
 
 /*********************************************************************//**
@@ -54,6 +56,17 @@ void Port_Init(void)
 	GPIO_SetValue(1,_SBF(18,0xFF));   //Clear P1.18 to P1.25
 }
 
+/*********************************************************************//**
+ * @brief 		Start the DWT cycle counter, safe to call more than once
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void DWT_CycleInit(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;   // Enable trace blocks
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;                   // Run CYCCNT
+}
+
 /**
  * @}
  */